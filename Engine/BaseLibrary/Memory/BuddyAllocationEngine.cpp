@@ -0,0 +1,156 @@
+#include "BuddyAllocationEngine.hpp"
+#include "../Exception/Exception.hpp"
+
+#include <new>
+#include <algorithm>
+#include <cassert>
+
+
+namespace inl {
+
+
+BuddyAllocationEngine::BuddyAllocationEngine(size_t poolSize) :
+	m_poolSize(poolSize),
+	m_maxOrder(0),
+	m_allocatedSize(0)
+{
+	if (poolSize == 0 || (poolSize & (poolSize - 1)) != 0) {
+		throw InvalidArgumentException("Pool size must be a power of two.", "poolSize");
+	}
+
+	m_maxOrder = OrderOf(poolSize);
+	m_freeOrder.resize(poolSize);
+	m_usedOrder.resize(poolSize);
+	m_next.resize(poolSize);
+	m_prev.resize(poolSize);
+	m_freeHeads.resize(m_maxOrder + 1);
+
+	Reset();
+}
+
+
+size_t BuddyAllocationEngine::Allocate(size_t allocationSize) {
+	if (allocationSize == 0) {
+		throw InvalidArgumentException("Allocation size should be non-zero.");
+	}
+	if (allocationSize > m_poolSize) {
+		throw std::bad_alloc();
+	}
+
+	// Find the smallest free block that fits.
+	unsigned order = OrderOf(allocationSize);
+	unsigned blockOrder = order;
+	while (blockOrder <= m_maxOrder && m_freeHeads[blockOrder] == NO_INDEX) {
+		++blockOrder;
+	}
+	if (blockOrder > m_maxOrder) {
+		throw std::bad_alloc();
+	}
+
+	size_t index = m_freeHeads[blockOrder];
+	RemoveFree(index, blockOrder);
+
+	// Split it until it's just large enough, the upper halves become free blocks.
+	while (blockOrder > order) {
+		--blockOrder;
+		PushFree(index + (size_t(1) << blockOrder), blockOrder);
+	}
+
+	m_usedOrder[index] = (uint8_t)order;
+	m_allocatedSize += size_t(1) << order;
+	return index;
+}
+
+
+void BuddyAllocationEngine::Deallocate(size_t index) {
+	if (index >= m_poolSize || m_usedOrder[index] == NO_BLOCK) {
+		throw InvalidArgumentException("Index is not the start of an allocated range.", "index");
+	}
+
+	unsigned order = m_usedOrder[index];
+	m_usedOrder[index] = NO_BLOCK;
+	m_allocatedSize -= size_t(1) << order;
+
+	// Merge with the buddy as long as it's free as a whole.
+	while (order < m_maxOrder) {
+		size_t buddy = index ^ (size_t(1) << order);
+		if (m_freeOrder[buddy] != order) {
+			break;
+		}
+		RemoveFree(buddy, order);
+		index = index < buddy ? index : buddy;
+		++order;
+	}
+
+	PushFree(index, order);
+}
+
+
+void BuddyAllocationEngine::Reset() {
+	std::fill(m_freeOrder.begin(), m_freeOrder.end(), NO_BLOCK);
+	std::fill(m_usedOrder.begin(), m_usedOrder.end(), NO_BLOCK);
+	std::fill(m_freeHeads.begin(), m_freeHeads.end(), NO_INDEX);
+	m_allocatedSize = 0;
+
+	PushFree(0, m_maxOrder);
+}
+
+
+size_t BuddyAllocationEngine::GetLargestFreeSize() const {
+	for (unsigned order = m_maxOrder + 1; order > 0; --order) {
+		if (m_freeHeads[order - 1] != NO_INDEX) {
+			return size_t(1) << (order - 1);
+		}
+	}
+	return 0;
+}
+
+
+size_t BuddyAllocationEngine::GetAllocationSize(size_t index) const {
+	if (index >= m_poolSize || m_usedOrder[index] == NO_BLOCK) {
+		return 0;
+	}
+	return size_t(1) << m_usedOrder[index];
+}
+
+
+void BuddyAllocationEngine::PushFree(size_t index, unsigned order) {
+	size_t head = m_freeHeads[order];
+	m_next[index] = head;
+	m_prev[index] = NO_INDEX;
+	if (head != NO_INDEX) {
+		m_prev[head] = index;
+	}
+	m_freeHeads[order] = index;
+	m_freeOrder[index] = (uint8_t)order;
+}
+
+
+void BuddyAllocationEngine::RemoveFree(size_t index, unsigned order) {
+	assert(m_freeOrder[index] == order);
+
+	size_t next = m_next[index];
+	size_t prev = m_prev[index];
+	if (prev != NO_INDEX) {
+		m_next[prev] = next;
+	}
+	else {
+		m_freeHeads[order] = next;
+	}
+	if (next != NO_INDEX) {
+		m_prev[next] = prev;
+	}
+	m_freeOrder[index] = NO_BLOCK;
+}
+
+
+unsigned BuddyAllocationEngine::OrderOf(size_t size) {
+	unsigned order = 0;
+	while ((size_t(1) << order) < size) {
+		++order;
+	}
+	return order;
+}
+
+
+} // namespace inl
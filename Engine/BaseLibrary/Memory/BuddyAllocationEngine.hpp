@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary>
+/// Serves as a base for allocators that hand out variable sized ranges of a pool.
+/// Ranges are power of two sized and aligned to their size, which makes it a good
+/// fit for GPU heaps with alignment requirements.
+/// 
+/// This class will not allocate the actual objects, it only
+/// administrates the object positions and sizes.
+/// </summary>
+class BuddyAllocationEngine {
+	// How it works:
+	// The pool is recursively halved into blocks of order 0 (1 slot) to order N (the whole pool).
+	// Free blocks of each order are linked into a list, the links are stored at the index of the
+	// first slot of the block. Allocation splits the smallest fitting free block until it's just large
+	// enough, deallocation merges the block with its buddy (index ^ size) as long as the buddy is free.
+public:
+	/// <summary>
+	/// Initialize an allocator of specified size.
+	/// </summary>
+	/// <param name="poolSize"> The number of available slots in the pool. Must be a power of two. </param>
+	/// <exception cref="inl::InvalidArgumentException"> If poolSize is not a power of two. </exception>
+	BuddyAllocationEngine(size_t poolSize);
+
+	/// <summary> Allocates a range of slots. The range is rounded up to a power of two. </summary>
+	/// <param name="allocationSize"> The number of slots needed. </param>
+	/// <returns> The starting index of the allocated range, which is a multiple of the range's size. </returns>
+	/// <exception cref="std::bad_alloc"> Thrown if there is no free range large enough. </exception>
+	/// <exception cref="inl::InvalidArgumentException"> If allocation size is zero. </exception>
+	size_t Allocate(size_t allocationSize = 1);
+
+	/// <summary> Deallocates the range starting at index. </summary>
+	/// <exception cref="inl::InvalidArgumentException"> If index is not the start of an allocated range. </exception>
+	void Deallocate(size_t index);
+
+	/// <summary> Clears all allocations. </summary>
+	void Reset();
+
+	/// <summary> Get the total number of slots (free + taken). </summary>
+	size_t Size() const { return m_poolSize; }
+
+	/// <summary> Number of slots taken by allocations, including the rounding. </summary>
+	size_t GetAllocatedSize() const { return m_allocatedSize; }
+
+	/// <summary> Size of the largest range that can currently be allocated. </summary>
+	size_t GetLargestFreeSize() const;
+
+	/// <summary> Size of the allocated range starting at index, 0 if there is no such allocation. </summary>
+	size_t GetAllocationSize(size_t index) const;
+private:
+	void PushFree(size_t index, unsigned order);
+	void RemoveFree(size_t index, unsigned order);
+
+	static unsigned OrderOf(size_t size);
+private:
+	static constexpr uint8_t NO_BLOCK = 0xFF;
+	static constexpr size_t NO_INDEX = ~size_t(0);
+
+	size_t m_poolSize;
+	unsigned m_maxOrder;
+	size_t m_allocatedSize;
+
+	std::vector<uint8_t> m_freeOrder; // order of the free block starting at the slot, or NO_BLOCK
+	std::vector<uint8_t> m_usedOrder; // order of the allocated block starting at the slot, or NO_BLOCK
+	std::vector<size_t> m_next;
+	std::vector<size_t> m_prev;
+	std::vector<size_t> m_freeHeads; // first free block of each order
+};
+
+
+} // namespace inl
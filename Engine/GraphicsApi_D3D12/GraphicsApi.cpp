@@ -4,6 +4,7 @@
 #include "CommandAllocator.hpp"
 #include "CommandList.hpp"
 #include "DescriptorHeap.hpp"
+#include "Heap.hpp"
 #include "NativeCast.hpp"
 #include "ExceptionExpansions.hpp"
 
@@ -21,11 +22,29 @@ namespace inl {
 namespace gxapi_dx12 {
 
 
-GraphicsApi::GraphicsApi(Microsoft::WRL::ComPtr<ID3D12Device> device) : m_device(device) {
+GraphicsApi::GraphicsApi(Microsoft::WRL::ComPtr<ID3D12Device> device, Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter)
+	: m_device(device), m_adapter(adapter)
+{
 	m_device->QueryInterface(IID_PPV_ARGS(&m_debugDevice));
+
+	if (m_adapter) {
+		m_budgetChangeEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+		if (m_budgetChangeEvent == nullptr
+			|| FAILED(m_adapter->RegisterVideoMemoryBudgetChangeNotificationEvent(m_budgetChangeEvent, &m_budgetChangeCookie)))
+		{
+			if (m_budgetChangeEvent != nullptr) {
+				CloseHandle(m_budgetChangeEvent);
+				m_budgetChangeEvent = nullptr;
+			}
+		}
+	}
 }
 
 GraphicsApi::~GraphicsApi() {
+	if (m_budgetChangeEvent != nullptr) {
+		m_adapter->UnregisterVideoMemoryBudgetChangeNotification(m_budgetChangeCookie);
+		CloseHandle(m_budgetChangeEvent);
+	}
 	//if (m_debugDevice) {
 	//	m_debugDevice->ReportLiveDeviceObjects(D3D12_RLDO_DETAIL);
 	//}
@@ -130,6 +149,46 @@ gxapi::IResource* GraphicsApi::CreateCommittedResource(gxapi::HeapProperties hea
 }
 
 
+gxapi::IHeap* GraphicsApi::CreateHeap(gxapi::HeapDesc desc) {
+	ComPtr<ID3D12Heap> native;
+
+	D3D12_HEAP_DESC nativeDesc = native_cast(desc);
+	ThrowIfFailed(m_device->CreateHeap(&nativeDesc, IID_PPV_ARGS(&native)));
+
+	return new Heap{ native, desc };
+}
+
+
+gxapi::IResource* GraphicsApi::CreatePlacedResource(gxapi::IHeap* heap,
+													uint64_t heapOffset,
+													gxapi::ResourceDesc desc,
+													gxapi::eResourceState initialState,
+													gxapi::ClearValue* clearValue) {
+	ComPtr<ID3D12Resource> native;
+
+	D3D12_RESOURCE_DESC nativeResourceDesc = native_cast(desc);
+
+	D3D12_CLEAR_VALUE* pNativeClearValue = nullptr;
+	D3D12_CLEAR_VALUE nativeClearValue;
+	if (clearValue != nullptr) {
+		nativeClearValue = native_cast(*clearValue);
+		pNativeClearValue = &nativeClearValue;
+	}
+
+	ThrowIfFailed(m_device->CreatePlacedResource(native_cast(heap), heapOffset, &nativeResourceDesc, native_cast(initialState), pNativeClearValue, IID_PPV_ARGS(&native)));
+
+	return new Resource{ native, m_device, static_cast<Heap*>(heap)->GetNativeRef() };
+}
+
+
+gxapi::ResourceAllocationInfo GraphicsApi::GetResourceAllocationInfo(gxapi::ResourceDesc desc) const {
+	D3D12_RESOURCE_DESC nativeResourceDesc = native_cast(desc);
+	D3D12_RESOURCE_ALLOCATION_INFO info = m_device->GetResourceAllocationInfo(0, 1, &nativeResourceDesc);
+
+	return { info.SizeInBytes, info.Alignment };
+}
+
+
 gxapi::IRootSignature* GraphicsApi::CreateRootSignature(gxapi::RootSignatureDesc desc) {
 	ComPtr<ID3D12RootSignature> native;
 
@@ -512,12 +571,7 @@ void GraphicsApi::MakeResident(const std::vector<gxapi::IResource*>& objects) {
 		return;
 	}
 
-	std::vector<ID3D12Pageable*> nativeObjects;
-	nativeObjects.reserve(objects.size());
-
-	for (auto curr : objects) {
-		nativeObjects.push_back(native_cast(curr));
-	}
+	std::vector<ID3D12Pageable*> nativeObjects = GetPageables(objects);
 
 	ThrowIfFailed(m_device->MakeResident((unsigned)nativeObjects.size(), nativeObjects.data()));
 }
@@ -528,14 +582,40 @@ void GraphicsApi::Evict(const std::vector<gxapi::IResource*>& objects) {
 		return;
 	}
 
+	std::vector<ID3D12Pageable*> nativeObjects = GetPageables(objects);
+
+	ThrowIfFailed(m_device->Evict((unsigned)nativeObjects.size(), nativeObjects.data()));
+}
+
+
+gxapi::VideoMemoryInfo GraphicsApi::GetVideoMemoryInfo() const {
+	gxapi::VideoMemoryInfo info;
+	DXGI_QUERY_VIDEO_MEMORY_INFO nativeInfo;
+	if (m_adapter && SUCCEEDED(m_adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &nativeInfo))) {
+		info.budget = nativeInfo.Budget;
+		info.currentUsage = nativeInfo.CurrentUsage;
+	}
+	return info;
+}
+
+
+bool GraphicsApi::PollVideoMemoryBudgetChange() {
+	// The event is auto-reset, a successful wait consumes the notification.
+	return m_budgetChangeEvent != nullptr && WaitForSingleObject(m_budgetChangeEvent, 0) == WAIT_OBJECT_0;
+}
+
+
+std::vector<ID3D12Pageable*> GraphicsApi::GetPageables(const std::vector<gxapi::IResource*>& objects) {
+	// Placed resources are listed through their heap. Residency is reference counted, so the heap is
+	// listed once per resource to keep MakeResident and Evict calls of different resources balanced.
 	std::vector<ID3D12Pageable*> nativeObjects;
 	nativeObjects.reserve(objects.size());
 
 	for (auto curr : objects) {
-		nativeObjects.push_back(native_cast(curr));
+		nativeObjects.push_back(static_cast<Resource*>(curr)->GetPageable());
 	}
 
-	ThrowIfFailed(m_device->Evict((unsigned)nativeObjects.size(), nativeObjects.data()));
+	return nativeObjects;
 }
 
 
@@ -6,6 +6,7 @@
 #define NOMINMAX
 #include <wrl.h>
 #include <d3d12.h>
+#include <dxgi1_4.h>
 #include "../GraphicsApi_LL/DisableWin32Macros.h"
 
 namespace inl {
@@ -14,7 +15,8 @@ namespace gxapi_dx12 {
 
 class GraphicsApi : public gxapi::IGraphicsApi {
 public:
-	GraphicsApi(Microsoft::WRL::ComPtr<ID3D12Device> device);
+	/// <param name="adapter"> Queried for the video memory budget, may be null if the adapter does not support it. </param>
+	GraphicsApi(Microsoft::WRL::ComPtr<ID3D12Device> device, Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter = nullptr);
 	~GraphicsApi();
 
 	// Command submission
@@ -33,6 +35,13 @@ public:
 											  gxapi::ResourceDesc desc,
 											  gxapi::eResourceState initialState,
 											  gxapi::ClearValue* clearValue = nullptr) override;
+	gxapi::IHeap* CreateHeap(gxapi::HeapDesc desc) override;
+	gxapi::IResource* CreatePlacedResource(gxapi::IHeap* heap,
+										   uint64_t heapOffset,
+										   gxapi::ResourceDesc desc,
+										   gxapi::eResourceState initialState,
+										   gxapi::ClearValue* clearValue = nullptr) override;
+	gxapi::ResourceAllocationInfo GetResourceAllocationInfo(gxapi::ResourceDesc desc) const override;
 
 
 	// Pipeline and binding
@@ -103,12 +112,20 @@ public:
 	void MakeResident(const std::vector<gxapi::IResource*>& objects) override;
 	void Evict(const std::vector<gxapi::IResource*>& objects) override;
 
+	gxapi::VideoMemoryInfo GetVideoMemoryInfo() const override;
+	bool PollVideoMemoryBudgetChange() override;
+
 	// Debug
 	void ReportLiveObjects() const override;
 
 protected:
+	static std::vector<ID3D12Pageable*> GetPageables(const std::vector<gxapi::IResource*>& objects);
+
 	Microsoft::WRL::ComPtr<ID3D12Device> m_device;
 	Microsoft::WRL::ComPtr<ID3D12DebugDevice1> m_debugDevice;
+	Microsoft::WRL::ComPtr<IDXGIAdapter3> m_adapter;
+	HANDLE m_budgetChangeEvent = nullptr;
+	DWORD m_budgetChangeCookie = 0;
 };
 
 
@@ -191,7 +191,11 @@ IGraphicsApi* GxapiManager::CreateGraphicsApi(unsigned adapterId) {
 			throw RuntimeException("Failed to create D3D12 device.");
 	}
 
-	return new GraphicsApi(device);
+	// Budget queries need DXGI 1.4, older systems run without a budget.
+	ComPtr<IDXGIAdapter3> adapter3;
+	adapter.As(&adapter3);
+
+	return new GraphicsApi(device, adapter3);
 }
 
 
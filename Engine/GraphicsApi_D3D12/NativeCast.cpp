@@ -119,6 +119,14 @@ ID3D12Fence* native_cast(gxapi::IFence * source) {
 	return static_cast<Fence*>(source)->GetNative();
 }
 
+ID3D12Heap* native_cast(gxapi::IHeap* source) {
+	if (source == nullptr) {
+		return nullptr;
+	}
+
+	return static_cast<Heap*>(source)->GetNative();
+}
+
 ID3D12CommandQueue* native_cast(gxapi::ICommandQueue* source) {
 	if (source == nullptr) {
 		return nullptr;
@@ -1306,6 +1314,18 @@ D3D12_DESCRIPTOR_HEAP_DESC native_cast(gxapi::DescriptorHeapDesc source) {
 }
 
 
+D3D12_HEAP_DESC native_cast(gxapi::HeapDesc source) {
+	D3D12_HEAP_DESC result;
+
+	result.SizeInBytes = source.sizeInBytes;
+	result.Properties = native_cast(source.properties);
+	result.Alignment = source.alignment;
+	result.Flags = native_cast(source.flags);
+
+	return result;
+}
+
+
 D3D12_BLEND_DESC native_cast(gxapi::BlendState source) {
 	D3D12_BLEND_DESC result;
 
@@ -1981,6 +2001,8 @@ D3D12_RESOURCE_BARRIER native_cast(gxapi::ResourceBarrier source) {
 			native.Flags = native_cast(source.transition.splitMode);
 			break;
 		case gxapi::eResourceBarrierType::ALIASING:
+			native.Aliasing.pResourceBefore = native_cast(source.aliasing.before);
+			native.Aliasing.pResourceAfter = native_cast(source.aliasing.after);
 			break;
 		case gxapi::eResourceBarrierType::UAV:
 			native.UAV.pResource = native_cast(source.uav.resource);
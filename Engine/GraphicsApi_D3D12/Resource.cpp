@@ -56,6 +56,12 @@ Resource::Resource(ComPtr<ID3D12Resource>& native, ComPtr<ID3D12Device> device)
 	}
 }
 
+Resource::Resource(ComPtr<ID3D12Resource>& native, ComPtr<ID3D12Device> device, ComPtr<ID3D12Heap> heap)
+	: Resource(native, device)
+{
+	m_heap = heap;
+}
+
 ID3D12Resource* Resource::GetNative() {
 	return m_native.Get();
 }
@@ -64,6 +70,13 @@ const ID3D12Resource* Resource::GetNative() const {
 	return m_native.Get();
 }
 
+ID3D12Pageable* Resource::GetPageable() {
+	if (m_heap) {
+		return m_heap.Get();
+	}
+	return m_native.Get();
+}
+
 
 gxapi::ResourceDesc Resource::GetDesc() const {
 	return native_cast(m_native->GetDesc());
@@ -18,9 +18,13 @@ public:
 	Resource(ComPtr<ID3D12Resource>& native, std::nullptr_t);
 	// passing device only because renderdoc crashes... fuck that... use GetDevice instead
 	Resource(ComPtr<ID3D12Resource>& native, ComPtr<ID3D12Device> device);
+	// placed resources keep their heap alive, residency is managed through the heap
+	Resource(ComPtr<ID3D12Resource>& native, ComPtr<ID3D12Device> device, ComPtr<ID3D12Heap> heap);
 
 	ID3D12Resource* GetNative();
 	const ID3D12Resource* GetNative() const;
+	/// <summary> Returns the object that has to be made resident for this resource: the heap for placed resources, itself otherwise. </summary>
+	ID3D12Pageable* GetPageable();
 
 	gxapi::ResourceDesc GetDesc() const override;
 	void* Map(unsigned subresourceIndex, const gxapi::MemoryRange* readRange = nullptr) override;
@@ -37,6 +41,7 @@ public:
 	void SetName(const char* name) override;
 private:
 	ComPtr<ID3D12Resource> m_native;
+	ComPtr<ID3D12Heap> m_heap;
 	unsigned m_numMipLevels, m_numTexturePlanes, m_numArrayLevels;
 };
 
@@ -848,6 +848,29 @@ struct CommandListDesc {
 };
 
 
+struct HeapDesc {
+	HeapDesc() = default;
+	HeapDesc(uint64_t sizeInBytes, HeapProperties properties, eHeapFlags flags, uint64_t alignment = 0)
+		: sizeInBytes(sizeInBytes), properties(properties), alignment(alignment), flags(flags) {}
+	uint64_t sizeInBytes;
+	HeapProperties properties;
+	uint64_t alignment; // 0 means default, 64KiB
+	eHeapFlags flags;
+};
+
+
+struct ResourceAllocationInfo {
+	uint64_t sizeInBytes;
+	uint64_t alignment;
+};
+
+
+struct VideoMemoryInfo {
+	uint64_t budget = 0; // how much the OS lets the process use, 0 if unknown
+	uint64_t currentUsage = 0;
+};
+
+
 struct DescriptorHeapDesc {
 	DescriptorHeapDesc() = default;
 	DescriptorHeapDesc(eDescriptorHeapType type, size_t numDescriptors, bool isShaderVisible)
@@ -1609,11 +1632,19 @@ struct UavBarrier : public ResourceBarrierTag {
 	IResource* resource;
 };
 
+/// <summary> Switches the placed resource that owns a piece of heap memory. Null means any resource. </summary>
+struct AliasingBarrier : public ResourceBarrierTag {
+	AliasingBarrier(IResource* before = nullptr, IResource* after = nullptr) : before(before), after(after) {}
+	IResource* before;
+	IResource* after;
+};
+
 struct ResourceBarrier {
 	eResourceBarrierType type;
 	union {
 		TransitionBarrier transition;
 		UavBarrier uav;
+		AliasingBarrier aliasing;
 	};
 	ResourceBarrier() {}
 	ResourceBarrier(const ResourceBarrier& rhs) {
@@ -1627,6 +1658,10 @@ struct ResourceBarrier {
 		type = eResourceBarrierType::UAV;
 		uav = rhs;
 	}
+	ResourceBarrier(const AliasingBarrier& rhs) {
+		type = eResourceBarrierType::ALIASING;
+		aliasing = rhs;
+	}
 
 	ResourceBarrier& operator=(const ResourceBarrier& rhs) {
 		memcpy(this, &rhs, sizeof(*this));
@@ -1643,6 +1678,11 @@ struct ResourceBarrier {
 		uav = rhs;
 		return *this;
 	}
+	ResourceBarrier& operator=(const AliasingBarrier& rhs) {
+		type = eResourceBarrierType::ALIASING;
+		aliasing = rhs;
+		return *this;
+	}
 };
 
 
@@ -14,6 +14,7 @@ class ICommandAllocator;
 class IFence;
 
 class IResource;
+class IHeap;
 
 class IRootSignature;
 class IPipelineState;
@@ -39,6 +40,13 @@ public:
 											   ResourceDesc desc,
 											   eResourceState initialState,
 											   ClearValue* clearValue = nullptr) = 0;
+	virtual IHeap* CreateHeap(HeapDesc desc) = 0;
+	virtual IResource* CreatePlacedResource(IHeap* heap,
+											uint64_t heapOffset,
+											ResourceDesc desc,
+											eResourceState initialState,
+											ClearValue* clearValue = nullptr) = 0;
+	virtual ResourceAllocationInfo GetResourceAllocationInfo(ResourceDesc desc) const = 0;
 
 	// Pipeline and binding
 	virtual IRootSignature* CreateRootSignature(RootSignatureDesc desc) = 0;
@@ -105,9 +113,15 @@ public:
 	// Misc
 	virtual IFence* CreateFence(uint64_t initialValue) = 0;
 
+	// Placed resources are made resident and evicted through their heap, which affects all resources in it.
 	virtual void MakeResident(const std::vector<gxapi::IResource*>& objects) = 0;
 	virtual void Evict(const std::vector<gxapi::IResource*>& objects) = 0;
 
+	// The budget of the device's local memory changes as other applications come and go.
+	virtual VideoMemoryInfo GetVideoMemoryInfo() const = 0;
+	// Returns true if the budget changed since the last call.
+	virtual bool PollVideoMemoryBudgetChange() = 0;
+
 	// Debug
 	virtual void ReportLiveObjects() const = 0;
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Common.hpp"
+
+
+namespace inl {
+namespace gxapi {
+
+
+/// <summary> A block of GPU memory that placed resources can be created in. </summary>
+class IHeap {
+public:
+	virtual ~IHeap() = default;
+
+	virtual HeapDesc GetDesc() const = 0;
+};
+
+
+} // namespace gxapi
+} // namespace inl
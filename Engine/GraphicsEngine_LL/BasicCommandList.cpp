@@ -56,6 +56,7 @@ void BasicCommandList::NewScratchSpace(size_t sizeHint) {
 
 BasicCommandList::BasicCommandList(BasicCommandList&& rhs)
 	: m_resourceTransitions(std::move(rhs.m_resourceTransitions)),
+	m_statistics(rhs.m_statistics),
 	m_scratchSpacePool(rhs.m_scratchSpacePool),
 	m_commandAllocator(std::move(rhs.m_commandAllocator)),
 	m_commandList(std::move(rhs.m_commandList)),
@@ -71,6 +72,7 @@ BasicCommandList& BasicCommandList::operator=(BasicCommandList&& rhs) {
 	m_commandList = std::move(rhs.m_commandList);
 	m_scratchSpaces = std::move(rhs.m_scratchSpaces);
 	m_currentScratchSpace = rhs.m_currentScratchSpace;
+	m_statistics = rhs.m_statistics;
 
 	return *this;
 }
@@ -81,13 +83,8 @@ BasicCommandList::Decomposition BasicCommandList::Decompose() {
 	decomposition.commandAllocator = std::move(m_commandAllocator);
 	decomposition.commandList = std::move(m_commandList);
 	decomposition.scratchSpaces = std::move(m_scratchSpaces);
-	decomposition.usedResources.reserve(m_resourceTransitions.size());
 	decomposition.additionalResources = std::move(m_additionalResources);
-
-	// Copy the elements of state transition map to vector w/ transforming types.
-	for (const auto& v : m_resourceTransitions) {
-		decomposition.usedResources.push_back(ResourceUsage{ std::move(v.first.resource), v.first.subresource, v.second.firstState, v.second.lastState, v.second.multipleStates });
-	}
+	m_resourceTransitions.Extract(decomposition.usedResources);
 
 	return decomposition;
 }
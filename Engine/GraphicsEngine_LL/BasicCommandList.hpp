@@ -8,6 +8,8 @@
 #include "CommandListPool.hpp"
 #include "ScratchSpacePool.hpp"
 #include "HostDescHeap.hpp"
+#include "CommandListStatistics.hpp"
+#include "ResourceTransitionTracker.hpp"
 
 #include <vector>
 #include <memory>
@@ -30,20 +32,6 @@ struct SubresourceId {
 	unsigned subresource;
 };
 
-struct SubresourceUsageInfo {
-	gxapi::eResourceState firstState; /// <summary> Holds the target state of the first transition. </summary>
-	gxapi::eResourceState lastState; /// <summary> Holds the target state of the last transition. </summary>
-	bool multipleStates; /// <sumamry> True if resource was used in more than one state. </summary>
-};
-
-struct ResourceUsage {
-	MemoryObject resource;
-	unsigned subresource;
-	gxapi::eResourceState firstState;
-	gxapi::eResourceState lastState;
-	bool multipleStates;
-};
-
 
 } // namespace gxeng
 } // namespace inl
@@ -75,7 +63,7 @@ public:
 		CmdAllocPtr commandAllocator;
 		CmdListPtr commandList;
 		std::vector<ScratchSpacePtr> scratchSpaces;
-		std::vector<ResourceUsage> usedResources;
+		std::vector<ResourceUsage> usedResources; // sorted by resource address and subresource
 		std::vector<MemoryObject> additionalResources;
 	};
 public:
@@ -87,6 +75,9 @@ public:
 
 	gxapi::eCommandListType GetType() const { return m_commandList->GetType(); }
 
+	/// <summary> Counts the state changes recorded so far, and the redundant ones that were dropped. </summary>
+	virtual CommandListStatistics GetStatistics() const { return m_statistics; }
+
 	virtual Decomposition Decompose();
 protected:
 	BasicCommandList(
@@ -101,9 +92,10 @@ protected:
 	StackDescHeap* GetCurrentScratchSpace();
 	virtual void NewScratchSpace(size_t sizeHint);
 protected:
-	std::unordered_map<SubresourceId, SubresourceUsageInfo> m_resourceTransitions;
+	ResourceTransitionTracker m_resourceTransitions;
 	std::vector<MemoryObject> m_additionalResources;
 	gxapi::IGraphicsApi* m_graphicsApi;
+	CommandListStatistics m_statistics;
 private:
 	// Part sources
 	ScratchSpacePool* m_scratchSpacePool;
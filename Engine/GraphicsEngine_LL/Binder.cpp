@@ -4,6 +4,7 @@
 
 #include "Binder.hpp"
 #include <algorithm>
+#include <atomic>
 
 
 namespace inl {
@@ -12,18 +13,39 @@ namespace gxeng {
 
 
 Binder::Binder(inl::gxapi::IGraphicsApi* gxApi, const std::vector<BindParameterDesc>& parameters, const std::vector<gxapi::StaticSamplerDesc>& staticSamplers) {
+	static std::atomic<uint64_t> idCounter = 0;
+	m_id = ++idCounter;
+
 	CalculateLayout(parameters);
+	BuildLookup();
 	m_rootSignatureDesc.staticSamplers = staticSamplers;
 	m_rootSignature.reset(gxApi->CreateRootSignature(m_rootSignatureDesc));
 }
 
 void Binder::Translate(BindParameter parameter, int & rootParamIndex, int & rootTableIndex) const {
-	auto result = FindMapping(parameter);
-	if (result.second != true) {
+	const RootParameterMapping* mapping = FindMappingFast(parameter);
+	if (mapping == nullptr) {
 		throw OutOfRangeException("Parameter was not found.");
 	}
-	rootParamIndex = result.first->rootParamIndex;
-	rootTableIndex = result.first->rootTableIndex;
+	rootParamIndex = mapping->rootParamIndex;
+	rootTableIndex = mapping->rootTableIndex;
+}
+
+void Binder::Translate(const BindHandle& handle, int& rootParamIndex, int& rootTableIndex) const {
+	if (handle.binderId == m_id && m_id != 0) {
+		rootParamIndex = handle.rootParamIndex;
+		rootTableIndex = handle.rootTableIndex;
+	}
+	else {
+		Translate(handle.parameter, rootParamIndex, rootTableIndex);
+	}
+}
+
+BindHandle Binder::GetHandle(BindParameter parameter) const {
+	BindHandle handle(parameter);
+	Translate(parameter, handle.rootParamIndex, handle.rootTableIndex);
+	handle.binderId = m_id;
+	return handle;
 }
 
 
@@ -229,7 +251,60 @@ std::pair<std::vector<Binder::RootParameterMapping>::const_iterator, bool> Binde
 							   [](const RootParameterMapping& lhs, const RootParameterMapping& rhs) {
 		return RadixLess(lhs.bindParam, rhs.bindParam);
 	});
-	return{ it, it != m_parameters.end() };
+	bool found = it != m_parameters.end()
+		&& it->bindParam.type == param.type
+		&& it->bindParam.space == param.space
+		&& it->bindParam.reg == param.reg;
+	return{ it, found };
+}
+
+
+const Binder::RootParameterMapping* Binder::FindMappingFast(BindParameter param) const {
+	// there are only a few types and spaces, the ranges are scanned linearly
+	for (const LookupRange& range : m_lookupRanges) {
+		if (range.type == param.type && range.space == param.space) {
+			if (param.reg < range.firstReg || param.reg - range.firstReg >= range.numRegs) {
+				return nullptr;
+			}
+			uint32_t index = m_lookup[range.offset + param.reg - range.firstReg];
+			return index != NO_MAPPING ? &m_parameters[index] : nullptr;
+		}
+	}
+
+	auto result = FindMapping(param);
+	return result.second ? &*result.first : nullptr;
+}
+
+
+void Binder::BuildLookup() {
+	m_lookupRanges.clear();
+	m_lookup.clear();
+
+	// m_parameters is sorted by type, space and register, so parameters of a range are consecutive
+	size_t first = 0;
+	while (first < m_parameters.size()) {
+		const BindParameter& firstParam = m_parameters[first].bindParam;
+		size_t last = first + 1;
+		while (last < m_parameters.size()
+			   && m_parameters[last].bindParam.type == firstParam.type
+			   && m_parameters[last].bindParam.space == firstParam.space)
+		{
+			++last;
+		}
+
+		unsigned firstReg = firstParam.reg;
+		unsigned numRegs = m_parameters[last - 1].bindParam.reg - firstReg + 1;
+		if (numRegs <= MAX_LOOKUP_RANGE) {
+			LookupRange range{ firstParam.type, firstParam.space, firstReg, numRegs, (unsigned)m_lookup.size() };
+			m_lookup.resize(m_lookup.size() + numRegs, NO_MAPPING);
+			for (size_t i = first; i < last; ++i) {
+				m_lookup[range.offset + m_parameters[i].bindParam.reg - firstReg] = (uint32_t)i;
+			}
+			m_lookupRanges.push_back(range);
+		}
+
+		first = last;
+	}
 }
 
 
@@ -7,6 +7,7 @@
 #include <cassert>
 #include <iostream>
 #include <initializer_list>
+#include <vector>
 
 
 namespace inl {namespace gxapi {
@@ -55,6 +56,25 @@ struct BindParameter {
 };
 
 
+/// <summary>
+/// A bind parameter whose place in the root signature of a binder is already known.
+/// Get it from <see cref="Binder::GetHandle"/> in Setup, and bind with it in Execute to skip the lookup.
+/// </summary>
+/// <remarks>
+/// Bind parameters convert to unresolved handles, those are looked up on every bind as before.
+/// A handle used with another binder than the one that created it is looked up as well.
+/// </remarks>
+struct BindHandle {
+	BindHandle() = default;
+	BindHandle(BindParameter parameter) : parameter(parameter) {}
+
+	BindParameter parameter;
+	uint64_t binderId = 0; // 0 if not resolved
+	int rootParamIndex = -1;
+	int rootTableIndex = -1;
+};
+
+
 /// <summary>
 /// Used to construct a Binder object.
 /// You can (and have to) specify other things besides the register.
@@ -100,6 +120,13 @@ public:
 	/// <param name="rootTableIndex"> If the above record is a descriptor table, the index in the table. Otherwise undefined. </param>
 	void Translate(BindParameter parameter, int& rootParamIndex, int& rootTableIndex) const;
 
+	/// <summary> Same as above, but takes the result from the handle if it was created by this binder. </summary>
+	void Translate(const BindHandle& handle, int& rootParamIndex, int& rootTableIndex) const;
+
+	/// <summary> Looks up the parameter once, so that binding with the handle doesn't have to. </summary>
+	/// <exception cref="OutOfRangeException"> If the binder has no such parameter. </exception>
+	BindHandle GetHandle(BindParameter parameter) const;
+
 	/// <summary> Return the underlying root signature object. </summary>
 	gxapi::IRootSignature* GetRootSignature() const { return m_rootSignature.get(); }
 
@@ -115,8 +142,24 @@ private:
 	gxapi::DescriptorRange::eType CastRangeType(eBindParameterType source);
 
 	std::pair<std::vector<RootParameterMapping>::const_iterator, bool> FindMapping(BindParameter param) const;
+	const RootParameterMapping* FindMappingFast(BindParameter param) const;
+	void BuildLookup();
 private:
+	// Registers of one type and space, mapped directly to an index in m_parameters.
+	struct LookupRange {
+		eBindParameterType type;
+		unsigned space;
+		unsigned firstReg;
+		unsigned numRegs;
+		unsigned offset; // first element in m_lookup
+	};
+	static constexpr unsigned MAX_LOOKUP_RANGE = 1024; // sparser register ranges are binary searched instead
+	static constexpr uint32_t NO_MAPPING = uint32_t(-1);
+
 	std::vector<RootParameterMapping> m_parameters;
+	std::vector<LookupRange> m_lookupRanges;
+	std::vector<uint32_t> m_lookup; // indices into m_parameters, NO_MAPPING for registers not in the binder
+	uint64_t m_id = 0; // identifies the layout for handles, unique for each constructed binder
 	std::unique_ptr<gxapi::IRootSignature> m_rootSignature;
 	gxapi::RootSignatureDesc m_rootSignatureDesc;
 
@@ -9,6 +9,8 @@
 #include <BaseLibrary/Exception/Exception.hpp>
 
 #include <stdexcept>
+#include <vector>
+#include <cstring>
 
 
 namespace inl::gxeng {
@@ -26,24 +28,32 @@ public:
 	BindingManager();
 	BindingManager(gxapi::IGraphicsApi* graphicsApi, CommandListT* commandList, MemoryManager* memoryManager, VolatileViewHeap* volatileCbvHeap);
 
-	using RootTableManager<Type>::SetBinder;
 	using RootTableManager<Type>::SetDescriptorHeap;
 	using RootTableManager<Type>::CommitDrawCall;
+	using RootTableManager<Type>::GetDescriptorStatistics;
+	using RootTableManager<Type>::GetDescriptorTableStatistics;
 
-	void Bind(BindParameter parameter, const TextureView1D& shaderResource);
-	void Bind(BindParameter parameter, const TextureView2D& shaderResource);
-	void Bind(BindParameter parameter, const TextureView3D& shaderResource);
-	void Bind(BindParameter parameter, const TextureViewCube& shaderResource);
-	void Bind(BindParameter parameter, const ConstBufferView& shaderConstant);
+	void SetBinder(Binder* binder);
+	Binder* GetBinder() const { return m_binder; }
+	/// <summary> Forgets the binder after the command list's state was cleared. </summary>
+	void ClearBinder();
+
+	void Bind(const BindHandle& parameter, const TextureView1D& shaderResource);
+	void Bind(const BindHandle& parameter, const TextureView2D& shaderResource);
+	void Bind(const BindHandle& parameter, const TextureView3D& shaderResource);
+	void Bind(const BindHandle& parameter, const TextureViewCube& shaderResource);
+	void Bind(const BindHandle& parameter, const ConstBufferView& shaderConstant);
 
 	//! Offset was removed because:
 	//! When implicitly creating a CBV to accomodate data, previously set bytes cannot be retrieved, thus bytes before offset cannot be defined.
-	void Bind(BindParameter parameter, const void* shaderConstant, int size/*, int offset*/);
+	void Bind(const BindHandle& parameter, const void* shaderConstant, int size/*, int offset*/);
+
+	void Bind(const BindHandle& parameter, const RWTextureView1D& rwResource);
+	void Bind(const BindHandle& parameter, const RWTextureView2D& rwResource);
+	void Bind(const BindHandle& parameter, const RWTextureView3D& rwResource);
+	void Bind(const BindHandle& parameter, const RWBufferView& rwResource);
 
-	void Bind(BindParameter parameter, const RWTextureView1D& rwResource);
-	void Bind(BindParameter parameter, const RWTextureView2D& rwResource);
-	void Bind(BindParameter parameter, const RWTextureView3D& rwResource);
-	void Bind(BindParameter parameter, const RWBufferView& rwResource);
+	const StateFilterCounter& GetRootConstantStatistics() const { return m_rootConstantStatistics; }
 protected:
 	void SetRootConstants(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value);
 	void SetRootConstants(gxapi::IComputeCommandList* list, unsigned parameterIndex, unsigned destOffset, unsigned numValues, const uint32_t* value);
@@ -51,11 +61,15 @@ protected:
 	void SetRootConstantBuffer(gxapi::IComputeCommandList* list, unsigned parameterIndex, void* gpuVirtualAddress);
 
 private:
-	void BindTexture(BindParameter parameter, gxapi::DescriptorHandle handle);
-	void BindUav(BindParameter parameter, gxapi::DescriptorHandle handle);
+	void BindTexture(const BindHandle& parameter, gxapi::DescriptorHandle handle);
+	void BindUav(const BindHandle& parameter, gxapi::DescriptorHandle handle);
 private:
 	MemoryManager* m_memoryManager;
 	VolatileViewHeap* m_volatileCbvHeap;
+
+	// Last inline data bound to each root signature slot of the current binder, identical data is not rebound.
+	std::vector<std::vector<uint8_t>> m_rootConstants;
+	StateFilterCounter m_rootConstantStatistics;
 };
 
 
@@ -69,32 +83,47 @@ BindingManager<Type>::BindingManager(gxapi::IGraphicsApi* graphicsApi, CommandLi
 	: RootTableManager<Type>(graphicsApi, commandList), m_memoryManager(memoryManager), m_volatileCbvHeap(volatileCbvHeap)
 {}
 
+template <gxapi::eCommandListType Type>
+void BindingManager<Type>::SetBinder(Binder* binder) {
+	RootTableManager<Type>::SetBinder(binder);
+
+	// Changing the root signature invalidates all root arguments.
+	m_rootConstants.clear();
+	m_rootConstants.resize(binder->GetRootSignatureDesc().rootParameters.size());
+}
+
+template <gxapi::eCommandListType Type>
+void BindingManager<Type>::ClearBinder() {
+	m_binder = nullptr;
+	m_rootConstants.clear();
+}
+
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const TextureView1D& shaderResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const TextureView1D& shaderResource) {
 	return BindTexture(parameter, shaderResource.GetHandle());
 }
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const TextureView2D& shaderResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const TextureView2D& shaderResource) {
 	return BindTexture(parameter, shaderResource.GetHandle());
 }
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const TextureView3D& shaderResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const TextureView3D& shaderResource) {
 	return BindTexture(parameter, shaderResource.GetHandle());
 }
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const TextureViewCube& shaderResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const TextureViewCube& shaderResource) {
 	return BindTexture(parameter, shaderResource.GetHandle());
 }
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::BindTexture(BindParameter parameter, gxapi::DescriptorHandle handle) {
+void BindingManager<Type>::BindTexture(const BindHandle& parameter, gxapi::DescriptorHandle handle) {
 	assert(m_binder != nullptr);
 
 	int slot, tableIndex;
@@ -112,7 +141,7 @@ void BindingManager<Type>::BindTexture(BindParameter parameter, gxapi::Descripto
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const ConstBufferView& shaderConstant) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const ConstBufferView& shaderConstant) {
 	assert(m_binder != nullptr);
 
 	int slot, tableIndex;
@@ -121,6 +150,7 @@ void BindingManager<Type>::Bind(BindParameter parameter, const ConstBufferView&
 	const auto& rootParam = desc.rootParameters[slot];
 
 	if (rootParam.type == gxapi::RootParameterDesc::CBV) {
+		m_rootConstants[slot].clear();
 		SetRootConstantBuffer(m_commandList, slot, shaderConstant.GetResource().GetVirtualAddress());
 	}
 	else if (rootParam.type == gxapi::RootParameterDesc::DESCRIPTOR_TABLE) {
@@ -133,7 +163,7 @@ void BindingManager<Type>::Bind(BindParameter parameter, const ConstBufferView&
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const void* shaderConstant, int size /*, int offset*/) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const void* shaderConstant, int size /*, int offset*/) {
 	if (size % 4 != 0) {
 		throw InvalidArgumentException("Size must be a multiple of 4.");
 	}
@@ -144,6 +174,17 @@ void BindingManager<Type>::Bind(BindParameter parameter, const void* shaderConst
 	const gxapi::RootSignatureDesc& desc = m_binder->GetRootSignatureDesc();
 	m_binder->Translate(parameter, slot, tableIndex); // may throw out of range
 
+	// Root arguments keep their values between draws, skip the call if the same data is bound again.
+	if (desc.rootParameters[slot].type == gxapi::RootParameterDesc::CONSTANT || desc.rootParameters[slot].type == gxapi::RootParameterDesc::CBV) {
+		std::vector<uint8_t>& boundData = m_rootConstants[slot];
+		if (boundData.size() == size_t(size) && std::memcmp(boundData.data(), shaderConstant, size) == 0) {
+			++m_rootConstantStatistics.filtered;
+			return;
+		}
+		boundData.assign(reinterpret_cast<const uint8_t*>(shaderConstant), reinterpret_cast<const uint8_t*>(shaderConstant) + size);
+		++m_rootConstantStatistics.forwarded;
+	}
+
 	if (desc.rootParameters[slot].type == gxapi::RootParameterDesc::CONSTANT) {
 		assert(desc.rootParameters[slot].As<gxapi::RootParameterDesc::CONSTANT>().numConstants >= unsigned(size /*+ offset*/) / 4);
 		SetRootConstants(m_commandList, slot, /*offset*/0, size / 4, reinterpret_cast<const uint32_t*>(shaderConstant));
@@ -170,7 +211,7 @@ void BindingManager<Type>::Bind(BindParameter parameter, const void* shaderConst
 
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::BindUav(BindParameter parameter, gxapi::DescriptorHandle handle) {
+void BindingManager<Type>::BindUav(const BindHandle& parameter, gxapi::DescriptorHandle handle) {
 	assert(m_binder != nullptr);
 
 	int slot, tableIndex;
@@ -187,22 +228,22 @@ void BindingManager<Type>::BindUav(BindParameter parameter, gxapi::DescriptorHan
 }
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const RWTextureView1D& rwResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const RWTextureView1D& rwResource) {
 	return BindUav(parameter, rwResource.GetHandle());
 }
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const RWTextureView2D& rwResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const RWTextureView2D& rwResource) {
 	return BindUav(parameter, rwResource.GetHandle());
 }
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const RWTextureView3D& rwResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const RWTextureView3D& rwResource) {
 	return BindUav(parameter, rwResource.GetHandle());
 }
 
 template <gxapi::eCommandListType Type>
-void BindingManager<Type>::Bind(BindParameter parameter, const RWBufferView& rwResource) {
+void BindingManager<Type>::Bind(const BindHandle& parameter, const RWBufferView& rwResource) {
 	return BindUav(parameter, rwResource.GetHandle());
 }
 
@@ -36,15 +36,34 @@ void CommandAllocatorPool::RecycleAllocator(gxapi::ICommandAllocator* allocator)
 	{
 		case gxapi::eCommandListType::COPY:
 			m_cpPool.RecycleAllocator(allocator);
+			break;
 		case gxapi::eCommandListType::COMPUTE:
 			m_cuPool.RecycleAllocator(allocator);
+			break;
 		case gxapi::eCommandListType::GRAPHICS:
 			m_gxPool.RecycleAllocator(allocator);
+			break;
 		default:
 			assert(false); // hlye vagy bazmeg
 	}
 }
 
+
+PoolStatistics CommandAllocatorPool::GetStatistics(gxapi::eCommandListType type) const {
+	switch (type)
+	{
+		case gxapi::eCommandListType::COPY:
+			return m_cpPool.GetStatistics();
+		case gxapi::eCommandListType::COMPUTE:
+			return m_cuPool.GetStatistics();
+		case gxapi::eCommandListType::GRAPHICS:
+			return m_gxPool.GetStatistics();
+		default:
+			return {};
+	}
+}
+
+
 gxapi::IGraphicsApi* CommandAllocatorPool::GetGraphicsApi() const {
 	return m_gxPool.GetGraphicsApi();
 }
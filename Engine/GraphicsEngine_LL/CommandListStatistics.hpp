@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Number of calls of one kind that reached the command list. </summary>
+struct StateFilterCounter {
+	size_t forwarded = 0; /// <summary> Calls that changed state and were recorded. </summary>
+	size_t filtered = 0; /// <summary> Calls that would not have changed anything and were dropped. </summary>
+
+	StateFilterCounter& operator+=(const StateFilterCounter& rhs) {
+		forwarded += rhs.forwarded;
+		filtered += rhs.filtered;
+		return *this;
+	}
+};
+
+
+/// <summary>
+/// Shows how many state setting calls of a command list were dropped as redundant.
+/// Read it at the end of a node's Execute to measure the pass.
+/// </summary>
+struct CommandListStatistics {
+	StateFilterCounter pipelineStates;
+	StateFilterCounter binders;
+	StateFilterCounter rootConstants;
+	StateFilterCounter descriptors;
+	StateFilterCounter descriptorTables; /// <summary> Tables copied to scratch space, and the ones reused from an identical earlier table. </summary>
+	StateFilterCounter vertexBuffers;
+	StateFilterCounter indexBuffers;
+	StateFilterCounter resourceStates;
+};
+
+
+} // namespace inl::gxeng
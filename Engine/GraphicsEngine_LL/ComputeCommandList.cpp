@@ -46,7 +46,8 @@ ComputeCommandList::ComputeCommandList(
 
 ComputeCommandList::ComputeCommandList(ComputeCommandList&& rhs)
 	: CopyCommandList(std::move(rhs)),
-	m_commandList(rhs.m_commandList)
+	m_commandList(rhs.m_commandList),
+	m_currentPipelineState(rhs.m_currentPipelineState)
 {
 	rhs.m_commandList = nullptr;
 }
@@ -55,6 +56,7 @@ ComputeCommandList::ComputeCommandList(ComputeCommandList&& rhs)
 ComputeCommandList& ComputeCommandList::operator=(ComputeCommandList&& rhs) {
 	CopyCommandList::operator=(std::move(rhs));
 	m_commandList = rhs.m_commandList;
+	m_currentPipelineState = rhs.m_currentPipelineState;
 	rhs.m_commandList = nullptr;
 
 	return *this;
@@ -81,23 +83,51 @@ void ComputeCommandList::Dispatch(size_t numThreadGroupsX, size_t numThreadGroup
 //------------------------------------------------------------------------------
 void ComputeCommandList::ResetState(gxapi::IPipelineState* newState) {
 	m_commandList->ResetState(newState);
+	ClearStateCache();
+	m_currentPipelineState = newState;
 }
 
 void ComputeCommandList::SetPipelineState(gxapi::IPipelineState* pipelineState) {
+	if (pipelineState == m_currentPipelineState) {
+		++m_statistics.pipelineStates.filtered;
+		return;
+	}
+	++m_statistics.pipelineStates.forwarded;
+	m_currentPipelineState = pipelineState;
 	m_commandList->SetPipelineState(pipelineState);
 }
 
 
+void ComputeCommandList::ClearStateCache() {
+	m_currentPipelineState = nullptr;
+	m_computeBindingManager.ClearBinder();
+}
+
+
+CommandListStatistics ComputeCommandList::GetStatistics() const {
+	CommandListStatistics statistics = CopyCommandList::GetStatistics();
+	statistics.rootConstants += m_computeBindingManager.GetRootConstantStatistics();
+	statistics.descriptors += m_computeBindingManager.GetDescriptorStatistics();
+	statistics.descriptorTables += m_computeBindingManager.GetDescriptorTableStatistics();
+	return statistics;
+}
+
+
 //------------------------------------------------------------------------------
 // Set compute root signature stuff
 //------------------------------------------------------------------------------
 void ComputeCommandList::SetComputeBinder(Binder* binder) {
 	assert(binder != nullptr);
+	if (binder == m_computeBindingManager.GetBinder()) {
+		++m_statistics.binders.filtered;
+		return;
+	}
+	++m_statistics.binders.forwarded;
 	m_computeBindingManager.SetBinder(binder);
 }
 
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView1D& shaderResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const TextureView1D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -112,7 +142,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView1
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView2D& shaderResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const TextureView2D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -127,7 +157,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView2
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView3D& shaderResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const TextureView3D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -142,7 +172,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const TextureView3
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const ConstBufferView& shaderConstant) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const ConstBufferView& shaderConstant) {
 	if (dynamic_cast<const PersistentConstBuffer*>(&shaderConstant.GetResource())) {
 		m_additionalResources.push_back(shaderConstant.GetResource());
 	}
@@ -156,7 +186,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const ConstBufferV
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const void* shaderConstant, int size/*, int offset*/) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const void* shaderConstant, int size/*, int offset*/) {
 	try {
 		m_computeBindingManager.Bind(parameter, shaderConstant, size/*, offset*/);
 	}
@@ -166,7 +196,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const void* shader
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureView1D& rwResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const RWTextureView1D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -178,7 +208,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureVie
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureView2D& rwResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const RWTextureView2D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -190,7 +220,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureVie
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureView3D& rwResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const RWTextureView3D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -202,7 +232,7 @@ void ComputeCommandList::BindCompute(BindParameter parameter, const RWTextureVie
 	}
 }
 
-void ComputeCommandList::BindCompute(BindParameter parameter, const RWBufferView& rwResource) {
+void ComputeCommandList::BindCompute(const BindHandle& parameter, const RWBufferView& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	{
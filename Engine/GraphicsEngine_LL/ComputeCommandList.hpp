@@ -41,23 +41,28 @@ public:
 	// set compute root signature stuff
 	void SetComputeBinder(Binder* binder);
 
-	void BindCompute(BindParameter parameter, const TextureView1D& shaderResource);
-	void BindCompute(BindParameter parameter, const TextureView2D& shaderResource);
-	void BindCompute(BindParameter parameter, const TextureView3D& shaderResource);
-	void BindCompute(BindParameter parameter, const ConstBufferView& shaderConstant);
-	void BindCompute(BindParameter parameter, const void* shaderConstant, int size/*, int offset*/);
-	void BindCompute(BindParameter parameter, const RWTextureView1D& rwResource);
-	void BindCompute(BindParameter parameter, const RWTextureView2D& rwResource);
-	void BindCompute(BindParameter parameter, const RWTextureView3D& rwResource);
-	void BindCompute(BindParameter parameter, const RWBufferView& rwResource);
+	void BindCompute(const BindHandle& parameter, const TextureView1D& shaderResource);
+	void BindCompute(const BindHandle& parameter, const TextureView2D& shaderResource);
+	void BindCompute(const BindHandle& parameter, const TextureView3D& shaderResource);
+	void BindCompute(const BindHandle& parameter, const ConstBufferView& shaderConstant);
+	void BindCompute(const BindHandle& parameter, const void* shaderConstant, int size/*, int offset*/);
+	void BindCompute(const BindHandle& parameter, const RWTextureView1D& rwResource);
+	void BindCompute(const BindHandle& parameter, const RWTextureView2D& rwResource);
+	void BindCompute(const BindHandle& parameter, const RWTextureView3D& rwResource);
+	void BindCompute(const BindHandle& parameter, const RWBufferView& rwResource);
 
 	// UAV barriers
 	void UAVBarrier(const MemoryObject& memoryObject);
+
+	CommandListStatistics GetStatistics() const override;
 protected:
 	virtual Decomposition Decompose() override;
 	virtual void NewScratchSpace(size_t hint) override;
+	/// <summary> Forgets the tracked state after the underlying command list's state was cleared. </summary>
+	virtual void ClearStateCache();
 private:
 	gxapi::IComputeCommandList* m_commandList;
+	gxapi::IPipelineState* m_currentPipelineState = nullptr; // shared by compute and graphics
 
 	// scratch space managment
 	BindingManager<gxapi::eCommandListType::COMPUTE> m_computeBindingManager;
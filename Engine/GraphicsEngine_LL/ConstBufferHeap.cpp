@@ -1,13 +1,33 @@
 #include "ConstBufferHeap.hpp"
 
 #include <cassert>
+#include <cstring>
 
 namespace inl {
 namespace gxeng {
 
 
+namespace {
+
+// The block a recording thread carves its volatile constant buffers from.
+struct ThreadBlock {
+	uint64_t heapId = 0;
+	uint64_t frameId = 0;
+	gxapi::IResource* resource = nullptr;
+	uint8_t* cpuAddress = nullptr; // start of the free part
+	uint8_t* gpuAddress = nullptr;
+	size_t remaining = 0;
+};
+thread_local ThreadBlock threadBlock;
+
+std::atomic<uint64_t> heapIdCounter = 0;
+
+} // namespace
+
+
 ConstantBufferHeap::ConstantBufferHeap(gxapi::IGraphicsApi* graphicsApi) :
-	m_graphicsApi(graphicsApi)
+	m_graphicsApi(graphicsApi),
+	m_id(++heapIdCounter)
 {
 	m_pages.PushFront(CreatePage());
 }
@@ -16,16 +36,50 @@ ConstantBufferHeap::ConstantBufferHeap(gxapi::IGraphicsApi* graphicsApi) :
 VolatileConstBuffer ConstantBufferHeap::CreateVolatileBuffer(const void* data, uint32_t dataSize) {
 	uint32_t targetSize = (uint32_t)SnapUpward(dataSize, ALIGNEMENT);
 
+	Allocation allocation = Allocate(targetSize);
+	memcpy(allocation.cpuAddress, data, dataSize);
+
+	return VolatileConstBuffer(GetMemoryDesc(allocation.resource), allocation.gpuAddress, dataSize, targetSize);
+}
+
+
+auto ConstantBufferHeap::Allocate(size_t size) -> Allocation {
+	if (size > THREAD_BLOCK_SIZE) {
+		return AllocateFromPages(size);
+	}
+
+	// The block must be replaced if it was taken in a previous frame: its page only waits for that frame to finish.
+	ThreadBlock& block = threadBlock;
+	if (block.heapId != m_id || block.frameId != m_currFrameID.load(std::memory_order_relaxed) || block.remaining < size) {
+		uint64_t frameId = m_currFrameID.load(std::memory_order_relaxed);
+		Allocation blockAllocation = AllocateFromPages(THREAD_BLOCK_SIZE);
+		block.heapId = m_id;
+		block.frameId = frameId;
+		block.resource = blockAllocation.resource;
+		block.cpuAddress = blockAllocation.cpuAddress;
+		block.gpuAddress = blockAllocation.gpuAddress;
+		block.remaining = THREAD_BLOCK_SIZE;
+	}
+
+	Allocation allocation{ block.resource, block.cpuAddress, block.gpuAddress };
+	block.cpuAddress += size;
+	block.gpuAddress += size;
+	block.remaining -= size;
+	return allocation;
+}
+
+
+auto ConstantBufferHeap::AllocateFromPages(size_t size) -> Allocation {
 	std::lock_guard<std::mutex> lock(m_mutex);
 
 	MarkEmptyIfRecycled(m_pages.Front());
 
 	ConstBufferPage* targetPage = nullptr;
 
-	if (m_pages.Front().m_consumedSize + targetSize > m_pages.Front().m_pageSize) {
-		if (targetSize > PAGE_SIZE) {
+	if (m_pages.Front().m_consumedSize + size > m_pages.Front().m_pageSize) {
+		if (size > PAGE_SIZE) {
 			if (m_largePages.Count() == 0) {
-				m_largePages.PushFront(std::move(CreateLargePage(targetSize)));
+				m_largePages.PushFront(std::move(CreateLargePage(size)));
 			}
 			else {
 				if (HasBecomeAvailable(m_largePages.Front())) {
@@ -39,14 +93,14 @@ VolatileConstBuffer ConstantBufferHeap::CreateVolatileBuffer(const void* data, u
 				{
 					auto& currPage = m_largePages.Front();
 					MarkEmptyIfRecycled(currPage);
-					if (currPage.m_consumedSize + targetSize <= currPage.m_pageSize) {
+					if (currPage.m_consumedSize + size <= currPage.m_pageSize) {
 						break; // current front will be selected as the target page, see below
 					}
 				}
 
 				bool noSuitable = roundEnd == m_largePages.Begin();
 				if (noSuitable) {
-					m_largePages.PushFront(std::move(CreateLargePage(targetSize)));
+					m_largePages.PushFront(std::move(CreateLargePage(size)));
 				}
 			}
 
@@ -75,19 +129,23 @@ VolatileConstBuffer ConstantBufferHeap::CreateVolatileBuffer(const void* data, u
 	// used from the page
 	targetPage->m_ownerFrameID = m_currFrameID;
 	size_t offset = targetPage->m_consumedSize;
-	targetPage->m_consumedSize += targetSize;
+	targetPage->m_consumedSize += size;
 
-	void* cpuPtr = ((uint8_t*)targetPage->m_cpuAddress) + offset;
-	void* gpuPtr = ((uint8_t*)targetPage->m_gpuAddress) + offset;
+	return Allocation{
+		targetPage->m_representedMemory.get(),
+		((uint8_t*)targetPage->m_cpuAddress) + offset,
+		((uint8_t*)targetPage->m_gpuAddress) + offset
+	};
+}
 
-	memcpy(cpuPtr, data, dataSize);
 
+MemoryObjDesc ConstantBufferHeap::GetMemoryDesc(gxapi::IResource* resource) {
+	// the page owns the resource, buffers only refer to it
 	MemoryObjDesc desc;
 	desc.resident = true;
-	desc.resource = MemoryObjDesc::UniqPtr(targetPage->m_representedMemory.get(), [](gxapi::IResource*){});
+	desc.resource = MemoryObjDesc::UniqPtr(resource, [](gxapi::IResource*){});
 	desc.heap = eResourceHeap::CONSTANT;
-
-	return VolatileConstBuffer(std::move(desc), gpuPtr, dataSize, targetSize);
+	return desc;
 }
 
 
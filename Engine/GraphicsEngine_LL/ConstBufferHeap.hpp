@@ -10,6 +10,7 @@
 
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 namespace inl {
 namespace gxeng {
@@ -42,10 +43,19 @@ protected:
 		uint64_t m_ownerFrameID;
 	};
 
+	struct Allocation {
+		gxapi::IResource* resource;
+		uint8_t* cpuAddress;
+		uint8_t* gpuAddress;
+	};
+
 public:
 	ConstantBufferHeap(gxapi::IGraphicsApi* graphicsApi);
 
+	/// <summary> Copies the data to upload memory that stays valid until the GPU finishes the current frame. </summary>
+	/// <remarks> Small buffers are allocated from a block owned by the calling thread without locking. </remarks>
 	VolatileConstBuffer CreateVolatileBuffer(const void* data, uint32_t dataSize);
+
 	PersistentConstBuffer CreatePersistentBuffer(const void* data, uint32_t dataSize);
 
 	void OnFrameBeginDevice(uint64_t frameId) override;
@@ -61,19 +71,30 @@ protected:
 	RingBuffer<ConstBufferPage> m_pages;
 	std::mutex m_mutex;
 
-	uint64_t m_currFrameID = 1;
+	std::atomic<uint64_t> m_currFrameID = 1; // read by recording threads without the lock
 	uint64_t m_lastFinishedFrameID = 0;
+	const uint64_t m_id; // tells thread local blocks of different heaps apart
 
 protected:
-	// From ( https://msdn.microsoft.com/en-us/library/windows/desktop/dn899216%28v=vs.85%29.aspx )
-	// "Linear subresource copying must be aligned to 512 bytes"
-	static constexpr size_t ALIGNEMENT = 512;
-	static constexpr size_t PAGE_SIZE = 64_Ki;
+	// Constant buffer views must be placed at multiples of 256 bytes (D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT).
+	// The 512 byte alignment of linear subresource copies does not apply, these buffers are read directly.
+	static constexpr size_t ALIGNEMENT = 256;
+	static constexpr size_t PAGE_SIZE = 1_Mi;
+
+	// Recording threads take blocks of this size from the pages and carve their buffers from them without locking.
+	// A constant buffer view is at most 64 KiB (4096 float4s), so a block holds a few of even the largest binds,
+	// such as the instanced per-draw constants of the forward and shadow passes.
+	static constexpr size_t MAX_CONSTANT_BUFFER_SIZE = 64_Ki;
+	static constexpr size_t THREAD_BLOCK_SIZE = 4 * MAX_CONSTANT_BUFFER_SIZE;
+	static_assert(THREAD_BLOCK_SIZE <= PAGE_SIZE);
 
 	static constexpr size_t MAX_PERMANENT_LARGE_PAGE_COUNT = 5;
 
 	static size_t SnapUpward(size_t value, size_t gridSize);
 protected:
+	Allocation Allocate(size_t size);
+	Allocation AllocateFromPages(size_t size);
+	MemoryObjDesc GetMemoryDesc(gxapi::IResource* resource);
 	ConstBufferPage CreatePage();
 	ConstBufferPage CreateLargePage(size_t fittingSize);
 	bool HasBecomeAvailable(const ConstBufferPage& page);
@@ -31,7 +31,8 @@ CopyCommandList::CopyCommandList(
 
 CopyCommandList::CopyCommandList(CopyCommandList&& rhs)
 	: BasicCommandList(std::move(rhs)),
-	m_commandList(rhs.m_commandList)
+	m_commandList(rhs.m_commandList),
+	m_requestedStates(rhs.m_requestedStates)
 {
 	rhs.m_commandList = nullptr;
 }
@@ -40,6 +41,7 @@ CopyCommandList::CopyCommandList(CopyCommandList&& rhs)
 CopyCommandList& CopyCommandList::operator=(CopyCommandList&& rhs) {
 	BasicCommandList::operator=(std::move(rhs));
 	m_commandList = rhs.m_commandList;
+	m_requestedStates = rhs.m_requestedStates;
 	rhs.m_commandList = nullptr;
 
 	return *this;
@@ -51,39 +53,51 @@ void CopyCommandList::SetResourceState(const MemoryObject& resource, gxapi::eRes
 		throw InvalidArgumentException("You must not set resource state of UPLOAD staging buffers and VOLATILE CONSTANT buffers. They are GENERIC_READ.");
 	}
 
-	// Call recursively when ALL subresources are requested.
+	// Nodes often request the state a resource is already in, like once per draw call.
+	// Every call that touches the resource overwrites its cache entry, so a match means nothing changed since.
+	const gxapi::IResource* resourcePtr = resource._GetResourcePtr();
+	RequestedState& lastRequest = m_requestedStates[(reinterpret_cast<uintptr_t>(resourcePtr) >> 4) % REQUESTED_STATE_CACHE_SIZE];
+	if (lastRequest.resource == resourcePtr && lastRequest.subresource == subresource && lastRequest.state == state) {
+		++m_statistics.resourceStates.filtered;
+		return;
+	}
+	++m_statistics.resourceStates.forwarded;
+	lastRequest.resource = resourcePtr;
+	lastRequest.subresource = subresource;
+	lastRequest.state = state;
+
+	// Do each subresource when ALL of them are requested.
 	if (subresource == gxapi::ALL_SUBRESOURCES) {
-		for (unsigned s = 0; s < resource._GetResourcePtr()->GetNumSubresources(); ++s) {
-			SetResourceState(resource, state, s);
+		for (unsigned s = 0; s < resourcePtr->GetNumSubresources(); ++s) {
+			SetSubresourceState(resource, state, s);
 		}
 	}
-	// Do a single subresource
 	else {
-		SubresourceId resId{ resource, subresource };
-		auto iter = m_resourceTransitions.find(resId);
-		bool firstTransition = iter == m_resourceTransitions.end();
-		if (firstTransition) {
-			SubresourceUsageInfo info;
-			info.lastState = state;
-			info.firstState = state;
-			info.multipleStates = false;
-			m_resourceTransitions.insert({ std::move(resId), info });
-		}
-		else {
-			const auto& prevState = iter->second.lastState;
-
-			if (prevState != state) {
-				m_commandList->ResourceBarrier(
-					gxapi::TransitionBarrier{
-					resource._GetResourcePtr(),
-					prevState,
-					state,
-					subresource
-				}
-				);
-				iter->second.lastState = state;
-				iter->second.multipleStates = true;
+		SetSubresourceState(resource, state, subresource);
+	}
+}
+
+
+void CopyCommandList::SetSubresourceState(const MemoryObject& resource, gxapi::eResourceState state, unsigned subresource) {
+	ResourceUsage* usage = m_resourceTransitions.Find(resource, subresource);
+	bool firstTransition = usage == nullptr;
+	if (firstTransition) {
+		m_resourceTransitions.Insert(resource, subresource, state);
+	}
+	else {
+		const auto& prevState = usage->lastState;
+
+		if (prevState != state) {
+			m_commandList->ResourceBarrier(
+				gxapi::TransitionBarrier{
+				resource._GetResourcePtr(),
+				prevState,
+				state,
+				subresource
 			}
+			);
+			usage->lastState = state;
+			usage->multipleStates = true;
 		}
 	}
 }
@@ -147,6 +161,7 @@ void CopyCommandList::ExpectResourceState(const MemoryObject& resource, const st
 	struct SubresourceIterator {
 		SubresourceIterator(const MemoryObject& resource, const std::vector<uint32_t>& subresources) {
 			count = resource.GetNumSubresources();
+			iter = 0;
 			sub = &subresources;
 			all = false;
 			for (auto s : subresources) {
@@ -176,14 +191,13 @@ void CopyCommandList::ExpectResourceState(const MemoryObject& resource, const st
 	while (subiter.HasNext()) {
 		uint32_t subres = subiter.Get();
 
-		SubresourceId key{ resource, subres };
-		auto iter = m_resourceTransitions.find(key);
+		const ResourceUsage* usage = m_resourceTransitions.Find(resource, subres);
 
-		if (iter == m_resourceTransitions.end()) {
+		if (usage == nullptr) {
 			throw InvalidStateException("You must SetSubresourceState before binding the resource view to the pipeline.");
 		}
 		else {
-			gxapi::eResourceState currentState = iter->second.lastState;
+			gxapi::eResourceState currentState = usage->lastState;
 			bool ok = false;
 			for (auto it = anyOfStates.begin(); it != anyOfStates.end(); ++it) {
 				ok = ok || (currentState & *it);
@@ -8,6 +8,7 @@
 #include "../GraphicsApi_LL/ICommandList.hpp"
 
 #include <InlineMath.hpp>
+#include <array>
 #include <type_traits>
 #include <unordered_map>
 
@@ -118,8 +119,20 @@ protected:
 	//void ExpectResourceState(const MemoryObject& resource, gxapi::eResourceState state, unsigned subresource = gxapi::ALL_SUBRESOURCES);
 	//void ExpectResourceState(const MemoryObject& resource, const std::initializer_list<gxapi::eResourceState>& anyOfStates, unsigned subresource = gxapi::ALL_SUBRESOURCES);
 	virtual Decomposition Decompose() override;
+private:
+	void SetSubresourceState(const MemoryObject& resource, gxapi::eResourceState state, unsigned subresource);
 private:
 	gxapi::ICopyCommandList* m_commandList;
+
+	// The last state requested for recently used resources, indexed by resource address.
+	// Repeating a request cannot cause a transition, so it's dropped before looking up the subresources.
+	struct RequestedState {
+		const gxapi::IResource* resource = nullptr;
+		unsigned subresource = 0;
+		gxapi::eResourceState state;
+	};
+	static constexpr size_t REQUESTED_STATE_CACHE_SIZE = 64;
+	std::array<RequestedState, REQUESTED_STATE_CACHE_SIZE> m_requestedStates;
 };
 
 
@@ -4,6 +4,8 @@
 #include "CopyCommandList.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <cassert>
 
 
 namespace inl {
@@ -12,24 +14,259 @@ namespace impl {
 
 
 
-CriticalBufferHeap::CriticalBufferHeap(gxapi::IGraphicsApi * graphicsApi) :
-	m_graphicsApi(graphicsApi)
+CriticalBufferHeap::CriticalBufferHeap(gxapi::IGraphicsApi * graphicsApi, std::shared_ptr<ResidencyManager> residencyManager) :
+	m_graphicsApi(graphicsApi),
+	m_residencyManager(std::move(residencyManager)),
+	m_pool(std::make_shared<HeapPool>()),
+	m_bufferPool(std::make_shared<BufferPool>())
 {}
 
 
+gxapi::ResourceAllocationInfo CriticalBufferHeap::GetAllocationInfo(gxapi::ResourceDesc& desc) const {
+	if (IsSmallPlacementCandidate(desc)) {
+		// The device reports the default alignment if the texture is too large for small placement.
+		desc.textureDesc.alignment = BLOCK_SIZE;
+		gxapi::ResourceAllocationInfo allocationInfo = m_graphicsApi->GetResourceAllocationInfo(desc);
+		if (allocationInfo.alignment == BLOCK_SIZE) {
+			return allocationInfo;
+		}
+		desc.textureDesc.alignment = 0;
+	}
+	return m_graphicsApi->GetResourceAllocationInfo(desc);
+}
+
+
 MemoryObjDesc CriticalBufferHeap::Allocate(gxapi::ResourceDesc desc, gxapi::ClearValue* clearValue) {
-	MemoryObjDesc result = MemoryObjDesc(
-		m_graphicsApi->CreateCommittedResource(
-			gxapi::HeapProperties(gxapi::eHeapType::DEFAULT, gxapi::eCpuPageProperty::UNKNOWN, gxapi::eMemoryPool::UNKNOWN),
-			gxapi::eHeapFlags::NONE,
-			desc,
-			gxapi::eResourceState::COMMON,
-			clearValue
-		),
-		eResourceHeap::CRITICAL
-	);
-
-	return result;
+	gxapi::ResourceAllocationInfo allocationInfo = GetAllocationInfo(desc);
+
+	if (!IsPlaced(allocationInfo)) {
+		MemoryObjDesc result = MemoryObjDesc(
+			m_graphicsApi->CreateCommittedResource(
+				gxapi::HeapProperties(gxapi::eHeapType::DEFAULT, gxapi::eCpuPageProperty::UNKNOWN, gxapi::eMemoryPool::UNKNOWN),
+				gxapi::eHeapFlags::NONE,
+				desc,
+				gxapi::eResourceState::COMMON,
+				clearValue
+			),
+			eResourceHeap::CRITICAL
+		);
+
+		return TrackResidency(std::move(result), allocationInfo.sizeInBytes, false);
+	}
+
+	// Buddy ranges are aligned to their size, rounding up to the alignment aligns the placement too.
+	size_t numBlocks = size_t((allocationInfo.sizeInBytes + BLOCK_SIZE - 1) / BLOCK_SIZE);
+	numBlocks = std::max(numBlocks, size_t(allocationInfo.alignment / BLOCK_SIZE));
+
+	eHeapClass heapClass = GetHeapClass(desc);
+	auto& heaps = m_pool->heaps[(int)heapClass];
+
+	std::lock_guard<std::mutex> lkg(m_pool->mutex);
+
+	// First fit, older heaps first so that newer ones are more likely to get empty.
+	PlacementHeap* placementHeap = nullptr;
+	size_t firstBlock = 0;
+	for (auto& heap : heaps) {
+		try {
+			firstBlock = heap->allocator.Allocate(numBlocks);
+			placementHeap = heap.get();
+			break;
+		}
+		catch (std::bad_alloc&) {
+			// try next heap
+		}
+	}
+	if (placementHeap == nullptr) {
+		gxapi::HeapDesc heapDesc{ HEAP_SIZE, gxapi::HeapProperties(gxapi::eHeapType::DEFAULT), GetHeapFlags(heapClass) };
+		heaps.push_back(std::make_unique<PlacementHeap>(m_graphicsApi->CreateHeap(heapDesc)));
+		placementHeap = heaps.back().get();
+		firstBlock = placementHeap->allocator.Allocate(numBlocks);
+	}
+
+	gxapi::IResource* resource;
+	try {
+		resource = m_graphicsApi->CreatePlacedResource(placementHeap->heap.get(), firstBlock * BLOCK_SIZE, desc, gxapi::eResourceState::COMMON, clearValue);
+	}
+	catch (...) {
+		placementHeap->allocator.Deallocate(firstBlock);
+		throw;
+	}
+	++placementHeap->numAllocations;
+
+	// Return the blocks to the heap when the last reference to the resource is gone.
+	std::shared_ptr<HeapPool> pool = m_pool;
+	MemoryObjDesc result;
+	result.resource = MemoryObjDesc::UniqPtr(resource, [pool, placementHeap, firstBlock](gxapi::IResource* ptr) {
+		delete ptr;
+		std::lock_guard<std::mutex> lkg(pool->mutex);
+		placementHeap->allocator.Deallocate(firstBlock);
+		--placementHeap->numAllocations;
+	});
+	result.resident = true;
+	result.heap = eResourceHeap::CRITICAL;
+
+	// Placed resources can only be paged with their whole heap.
+	return TrackResidency(std::move(result), allocationInfo.sizeInBytes, true);
+}
+
+
+LinearBuffer CriticalBufferHeap::AllocateBuffer(uint64_t sizeInBytes) {
+	if (sizeInBytes > MAX_SUBALLOCATED_BUFFER_SIZE) {
+		return LinearBuffer(Allocate(gxapi::ResourceDesc::Buffer(sizeInBytes)));
+	}
+
+	size_t numSlots = size_t((std::max(sizeInBytes, uint64_t(1)) + BUFFER_SLOT_SIZE - 1) / BUFFER_SLOT_SIZE);
+
+	std::lock_guard<std::mutex> lkg(m_bufferPool->mutex);
+
+	// First fit, same as the heaps.
+	BufferChunk* chunk = nullptr;
+	size_t firstSlot = 0;
+	for (auto& candidate : m_bufferPool->chunks) {
+		try {
+			firstSlot = candidate->allocator.Allocate(numSlots);
+			chunk = candidate.get();
+			break;
+		}
+		catch (std::bad_alloc&) {
+			// try next chunk
+		}
+	}
+	if (chunk == nullptr) {
+		LinearBuffer buffer(Allocate(gxapi::ResourceDesc::Buffer(BUFFER_CHUNK_SIZE)));
+		buffer.SetName("Shared buffer chunk");
+		m_bufferPool->chunks.push_back(std::make_unique<BufferChunk>(std::move(buffer)));
+		chunk = m_bufferPool->chunks.back().get();
+		firstSlot = chunk->allocator.Allocate(numSlots);
+	}
+	++chunk->numAllocations;
+
+	// Return the slots to the chunk when the last copy of the buffer is gone.
+	std::shared_ptr<BufferPool> pool = m_bufferPool;
+	std::shared_ptr<void> allocation(nullptr, [pool, chunk, firstSlot](void*) {
+		std::lock_guard<std::mutex> lkg(pool->mutex);
+		chunk->allocator.Deallocate(firstSlot);
+		--chunk->numAllocations;
+	});
+
+	return LinearBuffer(chunk->buffer, firstSlot * BUFFER_SLOT_SIZE, sizeInBytes, std::move(allocation));
+}
+
+
+bool CriticalBufferHeap::IsPlaced(const gxapi::ResourceAllocationInfo& allocationInfo) {
+	// Large resources would waste most of a heap, they get their own. So do multisampled textures,
+	// the heaps are created with the default alignment, and can't place the 4 MiB aligned ones.
+	return allocationInfo.sizeInBytes <= MAX_PLACED_SIZE && allocationInfo.alignment <= HEAP_ALIGNMENT;
+}
+
+
+std::vector<CriticalBufferHeap::HeapStatistics> CriticalBufferHeap::GetStatistics() const {
+	std::lock_guard<std::mutex> lkg(m_pool->mutex);
+
+	std::vector<HeapStatistics> statistics;
+	for (int heapClass = 0; heapClass < 3; ++heapClass) {
+		for (auto& heap : m_pool->heaps[heapClass]) {
+			HeapStatistics stats;
+			stats.heapClass = (eHeapClass)heapClass;
+			stats.size = HEAP_SIZE;
+			stats.usedSize = heap->allocator.GetAllocatedSize() * BLOCK_SIZE;
+			stats.largestFreeBlock = heap->allocator.GetLargestFreeSize() * BLOCK_SIZE;
+			stats.numAllocations = heap->numAllocations;
+			statistics.push_back(stats);
+		}
+	}
+
+	return statistics;
+}
+
+
+std::vector<CriticalBufferHeap::HeapStatistics> CriticalBufferHeap::GetBufferChunkStatistics() const {
+	std::lock_guard<std::mutex> lkg(m_bufferPool->mutex);
+
+	std::vector<HeapStatistics> statistics;
+	for (auto& chunk : m_bufferPool->chunks) {
+		HeapStatistics stats;
+		stats.heapClass = eHeapClass::BUFFERS;
+		stats.size = BUFFER_CHUNK_SIZE;
+		stats.usedSize = chunk->allocator.GetAllocatedSize() * BUFFER_SLOT_SIZE;
+		stats.largestFreeBlock = chunk->allocator.GetLargestFreeSize() * BUFFER_SLOT_SIZE;
+		stats.numAllocations = chunk->numAllocations;
+		statistics.push_back(stats);
+	}
+
+	return statistics;
+}
+
+
+void CriticalBufferHeap::TrimEmptyHeaps() {
+	// Chunks first, their resources are placed in the heaps. In-flight frames may still hold them though.
+	{
+		std::lock_guard<std::mutex> lkg(m_bufferPool->mutex);
+		auto& chunks = m_bufferPool->chunks;
+		chunks.erase(std::remove_if(chunks.begin(), chunks.end(), [](const std::unique_ptr<BufferChunk>& chunk) {
+			return chunk->numAllocations == 0;
+		}), chunks.end());
+	}
+
+	std::lock_guard<std::mutex> lkg(m_pool->mutex);
+
+	for (auto& heaps : m_pool->heaps) {
+		heaps.erase(std::remove_if(heaps.begin(), heaps.end(), [](const std::unique_ptr<PlacementHeap>& heap) {
+			return heap->numAllocations == 0;
+		}), heaps.end());
+	}
+}
+
+
+auto CriticalBufferHeap::GetHeapClass(const gxapi::ResourceDesc& desc) -> eHeapClass {
+	if (desc.type == gxapi::eResourceType::BUFFER) {
+		return eHeapClass::BUFFERS;
+	}
+	if (desc.textureDesc.flags & (gxapi::eResourceFlags::ALLOW_RENDER_TARGET | gxapi::eResourceFlags::ALLOW_DEPTH_STENCIL)) {
+		return eHeapClass::RT_DS_TEXTURES;
+	}
+	return eHeapClass::TEXTURES;
+}
+
+
+gxapi::eHeapFlags CriticalBufferHeap::GetHeapFlags(eHeapClass heapClass) {
+	switch (heapClass) {
+		case eHeapClass::BUFFERS: return gxapi::eHeapFlags::ALLOW_ONLY_BUFFERS;
+		case eHeapClass::TEXTURES: return gxapi::eHeapFlags::ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		case eHeapClass::RT_DS_TEXTURES: return gxapi::eHeapFlags::ALLOW_ONLY_RT_DS_TEXTURES;
+		default: assert(false); return gxapi::eHeapFlags::NONE;
+	}
+}
+
+
+bool CriticalBufferHeap::IsSmallPlacementCandidate(const gxapi::ResourceDesc& desc) {
+	// Render targets, depth buffers and multisampled textures always need the larger alignments.
+	return desc.type == gxapi::eResourceType::TEXTURE
+		&& GetHeapClass(desc) == eHeapClass::TEXTURES
+		&& desc.textureDesc.multisampleCount <= 1
+		&& desc.textureDesc.alignment == 0;
+}
+
+
+MemoryObjDesc CriticalBufferHeap::TrackResidency(MemoryObjDesc desc, uint64_t sizeInBytes, bool pinned) {
+	if (!m_residencyManager) {
+		return desc;
+	}
+
+	gxapi::IResource* resource = desc.resource.get();
+	MemoryObjDesc::Deleter deleter = desc.resource.get_deleter();
+	desc.resource.release();
+
+	m_residencyManager->Register(resource, sizeInBytes, pinned);
+
+	// Stop tracking before the heap gets the memory back.
+	std::shared_ptr<ResidencyManager> residencyManager = m_residencyManager;
+	desc.resource = MemoryObjDesc::UniqPtr(resource, [residencyManager, deleter](gxapi::IResource* ptr) {
+		residencyManager->Unregister(ptr);
+		deleter(ptr);
+	});
+
+	return desc;
 }
 
 
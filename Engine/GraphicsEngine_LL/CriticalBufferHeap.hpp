@@ -2,21 +2,127 @@
 
 #include "../GraphicsApi_LL/IGraphicsApi.hpp"
 #include "../GraphicsApi_LL/IResource.hpp"
+#include "../GraphicsApi_LL/IHeap.hpp"
+#include "../BaseLibrary/Memory/BuddyAllocationEngine.hpp"
 
 #include "MemoryObject.hpp"
+#include "ResidencyManager.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace inl {
 namespace gxeng {
 
 namespace impl {
 
+
+/// <summary>
+/// Allocates device local resources as placed resources in large heaps.
+/// <para/>
+/// Buffers, textures and render target/depth stencil textures are kept in separate
+/// heaps, as the lowest resource heap tier requires. Resources too large for
+/// suballocation, or aligned more strictly than the heaps, like multisampled
+/// textures, are created as committed resources. Small textures are placed at 4 KiB
+/// granularity where the device allows it, instead of the default 64 KiB.
+/// <para/>
+/// Small buffers don't get a resource of their own, they are ranges of larger buffer
+/// resources shared with other small buffers.
+/// <para/>
+/// This class is thread safe.
+/// </summary>
 class CriticalBufferHeap {
 public:
-	CriticalBufferHeap(gxapi::IGraphicsApi* graphicsApi);
+	enum class eHeapClass { BUFFERS = 0, TEXTURES, RT_DS_TEXTURES };
+
+	/// <summary> Occupancy of a heap placed resources are suballocated from. </summary>
+	struct HeapStatistics {
+		eHeapClass heapClass;
+		size_t size;
+		size_t usedSize;
+		size_t largestFreeBlock; /// <summary> A lot smaller than size-usedSize means fragmentation. </summary>
+		size_t numAllocations;
+	};
+
+	static constexpr size_t HEAP_SIZE = 64 * 1024 * 1024;
+	static constexpr size_t HEAP_ALIGNMENT = 64 * 1024; // default placement alignment, the heaps are created with it
+	static constexpr size_t BLOCK_SIZE = 4 * 1024; // small resource placement alignment
+	static constexpr size_t MAX_PLACED_SIZE = HEAP_SIZE / 4;
+
+	static constexpr size_t BUFFER_CHUNK_SIZE = 4 * 1024 * 1024;
+	static constexpr size_t BUFFER_SLOT_SIZE = 256; // constant buffer alignment, the strictest of buffer views
+	static constexpr size_t MAX_SUBALLOCATED_BUFFER_SIZE = BUFFER_CHUNK_SIZE / 16;
+public:
+	/// <param name="residencyManager"> The allocated resources are registered in it. May be null. </param>
+	CriticalBufferHeap(gxapi::IGraphicsApi* graphicsApi, std::shared_ptr<ResidencyManager> residencyManager = nullptr);
+
+	/// <summary> Size and alignment of the resource as this heap allocates it. </summary>
+	/// <remarks> Small textures are given 4 KiB alignment if the device allows it, <paramref name="desc"/> is updated then. </remarks>
+	gxapi::ResourceAllocationInfo GetAllocationInfo(gxapi::ResourceDesc& desc) const;
+
 	MemoryObjDesc Allocate(gxapi::ResourceDesc desc, gxapi::ClearValue* clearValue = nullptr);
 
+	/// <summary> Allocates a buffer. Small ones are ranges of a buffer resource shared with other buffers. </summary>
+	/// <remarks> Buffers sharing a resource share its tracked state too, and are equal as MemoryObjects.
+	///		A range is reused as soon as its buffer is released. Work using the old buffer is always
+	///		queued before the upload to the new one, the command queue keeps them in order. </remarks>
+	LinearBuffer AllocateBuffer(uint64_t sizeInBytes);
+
+	/// <summary> True if a resource of this size and alignment is placed in a shared heap, false if committed. </summary>
+	/// <remarks> Placed resources are paged in and out together with all others in their heap. </remarks>
+	static bool IsPlaced(const gxapi::ResourceAllocationInfo& allocationInfo);
+
+	std::vector<HeapStatistics> GetStatistics() const;
+
+	/// <summary> Occupancy of the shared buffer resources, the heap class is always BUFFERS. </summary>
+	/// <remarks> The shared buffers themselves are placed in the heaps listed by GetStatistics. </remarks>
+	std::vector<HeapStatistics> GetBufferChunkStatistics() const;
+
+	/// <summary> Releases shared buffers and heaps that have nothing allocated from them. </summary>
+	/// <remarks> Meant to be called after large batches of resources were released, e.g. on level change. </remarks>
+	void TrimEmptyHeaps();
+
+protected:
+	struct PlacementHeap {
+		PlacementHeap(gxapi::IHeap* heap) : heap(heap), allocator(HEAP_SIZE / BLOCK_SIZE), numAllocations(0) {}
+		std::unique_ptr<gxapi::IHeap> heap;
+		BuddyAllocationEngine allocator;
+		size_t numAllocations;
+	};
+
+	// Shared with the deleters of the placed resources so that heaps outlive all resources in them.
+	struct HeapPool {
+		std::vector<std::unique_ptr<PlacementHeap>> heaps[3]; // indexed by eHeapClass
+		std::mutex mutex;
+	};
+
+	struct BufferChunk {
+		BufferChunk(LinearBuffer buffer) : buffer(std::move(buffer)), allocator(BUFFER_CHUNK_SIZE / BUFFER_SLOT_SIZE), numAllocations(0) {}
+		LinearBuffer buffer;
+		BuddyAllocationEngine allocator;
+		size_t numAllocations;
+	};
+
+	// Shared with the buffers allocated from the chunks. Kept apart from the heap pool,
+	// the chunks' resources hold on to that one.
+	struct BufferPool {
+		std::vector<std::unique_ptr<BufferChunk>> chunks;
+		std::mutex mutex;
+	};
+
+	static eHeapClass GetHeapClass(const gxapi::ResourceDesc& desc);
+	static gxapi::eHeapFlags GetHeapFlags(eHeapClass heapClass);
+	static bool IsSmallPlacementCandidate(const gxapi::ResourceDesc& desc);
+
+	/// <summary> Registers the resource in the residency manager until it is destroyed. </summary>
+	MemoryObjDesc TrackResidency(MemoryObjDesc desc, uint64_t sizeInBytes, bool pinned);
+
 protected:
 	gxapi::IGraphicsApi* m_graphicsApi;
+	std::shared_ptr<ResidencyManager> m_residencyManager;
+	std::shared_ptr<HeapPool> m_pool;
+	std::shared_ptr<BufferPool> m_bufferPool;
 };
 
 
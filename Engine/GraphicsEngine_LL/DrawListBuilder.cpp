@@ -0,0 +1,302 @@
+#include "DrawListBuilder.hpp"
+
+#include "MeshEntity.hpp"
+#include "Mesh.hpp"
+#include "Material.hpp"
+#include "LodSelector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <xmmintrin.h>
+
+
+namespace inl::gxeng {
+
+
+ViewFrustum::ViewFrustum(const Mat44& viewProjection) {
+	// Points are transformed as row vectors, so clip space coordinates are dot products with the columns.
+	Vec4 columns[4];
+	for (int col = 0; col < 4; ++col) {
+		columns[col] = { viewProjection(0, col), viewProjection(1, col), viewProjection(2, col), viewProjection(3, col) };
+	}
+
+	m_planes[0] = columns[3] + columns[0];
+	m_planes[1] = columns[3] - columns[0];
+	m_planes[2] = columns[3] + columns[1];
+	m_planes[3] = columns[3] - columns[1];
+	m_planes[4] = columns[2];
+	m_planes[5] = columns[3] - columns[2];
+
+	for (auto& plane : m_planes) {
+		float length = Vec3(plane.xyz).Length();
+		if (length > 0.0f) {
+			plane /= length;
+		}
+	}
+}
+
+
+ViewFrustum ViewFrustum::Extruded(const Vec3& direction) const {
+	ViewFrustum extruded = *this;
+	for (auto& plane : extruded.m_planes) {
+		if (Dot(Vec3(plane.xyz), direction) > 0.0f) {
+			plane = { 0.0f, 0.0f, 0.0f, 1.0f };
+		}
+	}
+	return extruded;
+}
+
+
+ClusterCuller::ClusterCuller(const Mat44& viewProjection, const Vec3& cameraPosition)
+	: m_frustum(viewProjection), m_cameraPosition(cameraPosition)
+{
+	// Unproject a triangle that is counter-clockwise on the screen to find which way the normals of front faces point.
+	// Whether the projection is left or right handed does not matter this way.
+	Mat44 inverse = viewProjection.Inverse();
+	auto Unproject = [&inverse](float x, float y) {
+		Vec4 point = Vec4(x, y, 0.5f, 1.0f) * inverse;
+		return Vec3(point.xyz) / point.w;
+	};
+	Vec3 p0 = Unproject(0.0f, 0.0f);
+	Vec3 p1 = Unproject(0.5f, 0.0f);
+	Vec3 p2 = Unproject(0.0f, 0.5f);
+	Vec3 normal = Cross(p1 - p0, p2 - p0);
+	m_frontSign = Dot(normal, p0 - m_cameraPosition) >= 0.0f ? 1.0f : -1.0f;
+}
+
+
+void ClusterCuller::Cull(const MeshEntity& entity, std::vector<IndexRange>& ranges) const {
+	ranges.clear();
+	const Mesh* mesh = entity.GetMesh();
+	if (mesh == nullptr || mesh->GetNumLods() == 0) {
+		return;
+	}
+	const auto& clusters = mesh->GetClusters();
+	if (clusters.empty()) {
+		const Mesh::Lod& lod = mesh->GetLod(0);
+		ranges.push_back({ lod.firstIndex, lod.numIndices });
+		return;
+	}
+
+	Mat44 transform = entity.GetTransform();
+	Vec3 scale = entity.GetScale();
+	float maxScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+	// Rotations and uniform scaling keep the angles between normals, so the cones stay valid.
+	// The triangles keep their winding if mirrored in all three axes, but the transformed axis flips.
+	bool conesValid = scale.x == scale.y && scale.y == scale.z && scale.x != 0.0f;
+	float axisSign = scale.x < 0.0f ? -1.0f : 1.0f;
+
+	for (const MeshCluster& cluster : clusters) {
+		Vec3 center = Vec3((Vec4(cluster.center, 1.0f) * transform).xyz);
+		float radius = cluster.radius * maxScale;
+
+		bool visible = true;
+		for (size_t i = 0; i < 6 && visible; ++i) {
+			const Vec4& plane = m_frustum[i];
+			visible = Dot(Vec3(plane.xyz), center) + plane.w >= -radius;
+		}
+
+		// All triangles face away if the view rays to the whole sphere are within the cone of back face normals.
+		if (visible && conesValid && cluster.coneCutoff < 1.0f) {
+			Vec3 axis = Vec3((Vec4(cluster.coneAxis, 0.0f) * transform).xyz);
+			float axisLength = axis.Length();
+			if (axisLength > 0.0f) {
+				Vec3 backAxis = axis * (-m_frontSign * axisSign / axisLength);
+				Vec3 toCenter = center - m_cameraPosition;
+				visible = Dot(toCenter, backAxis) <= cluster.coneCutoff * toCenter.Length() + radius;
+			}
+		}
+
+		if (!visible) {
+			continue;
+		}
+		if (!ranges.empty() && ranges.back().firstIndex + ranges.back().numIndices == cluster.firstIndex) {
+			ranges.back().numIndices += cluster.numIndices;
+		}
+		else {
+			ranges.push_back({ cluster.firstIndex, cluster.numIndices });
+		}
+	}
+}
+
+
+void DrawListBuilder::SetEntities(const EntityCollection<MeshEntity>& entities) {
+	size_t count = entities.Size();
+	size_t paddedCount = (count + 3) & ~size_t(3);
+
+	m_changed = count != m_entities.size();
+
+	// Keep the previous bounds, the collection iterates in the same order as long as it's not modified.
+	m_entities.resize(count);
+	m_poses.resize(count);
+	for (auto* vec : { &m_centerX, &m_centerY, &m_centerZ, &m_extentX, &m_extentY, &m_extentZ }) {
+		vec->resize(paddedCount, 0.0f);
+	}
+
+	size_t index = 0;
+	for (const MeshEntity* entity : entities) {
+		EntityPose pose = GetPose(*entity);
+		if (m_entities[index] != entity || !(m_poses[index] == pose)) {
+			m_entities[index] = entity;
+			m_poses[index] = pose;
+			CalculateBounds(index, *entity);
+			m_changed = true;
+		}
+		++index;
+	}
+}
+
+
+bool DrawListBuilder::EntityPose::operator==(const EntityPose& rhs) const {
+	return mesh == rhs.mesh
+		&& position == rhs.position
+		&& rotation == rhs.rotation
+		&& scale == rhs.scale
+		&& meshCenter == rhs.meshCenter
+		&& meshExtent == rhs.meshExtent;
+}
+
+
+DrawListBuilder::EntityPose DrawListBuilder::GetPose(const MeshEntity& entity) {
+	EntityPose pose;
+	pose.mesh = entity.GetMesh();
+	pose.position = entity.GetPosition();
+	pose.rotation = entity.GetRotation();
+	pose.scale = entity.GetScale();
+	if (pose.mesh != nullptr) {
+		pose.meshCenter = pose.mesh->GetBoundingBoxCenter();
+		pose.meshExtent = pose.mesh->GetBoundingBoxExtent();
+	}
+	else {
+		pose.meshCenter = pose.meshExtent = { 0, 0, 0 };
+	}
+	return pose;
+}
+
+
+void DrawListBuilder::CalculateBounds(size_t index, const MeshEntity& entity) {
+	const Mesh* mesh = entity.GetMesh();
+	if (mesh == nullptr) {
+		const float inf = std::numeric_limits<float>::infinity();
+		m_centerX[index] = m_centerY[index] = m_centerZ[index] = 0.0f;
+		m_extentX[index] = m_extentY[index] = m_extentZ[index] = inf;
+		return;
+	}
+
+	// Transform the box and take the box around it: the extent is projected onto the world axes.
+	Mat44 transform = entity.GetTransform();
+	const Vec3& center = mesh->GetBoundingBoxCenter();
+	const Vec3& extent = mesh->GetBoundingBoxExtent();
+
+	Vec3 worldCenter = Vec3((Vec4(center, 1.0f) * transform).xyz);
+	Vec3 worldExtent;
+	for (int col = 0; col < 3; ++col) {
+		worldExtent[col] = std::abs(transform(0, col)) * extent.x
+			+ std::abs(transform(1, col)) * extent.y
+			+ std::abs(transform(2, col)) * extent.z;
+	}
+
+	m_centerX[index] = worldCenter.x;
+	m_centerY[index] = worldCenter.y;
+	m_centerZ[index] = worldCenter.z;
+	m_extentX[index] = worldExtent.x;
+	m_extentY[index] = worldExtent.y;
+	m_extentZ[index] = worldExtent.z;
+}
+
+
+void DrawListBuilder::Cull(const ViewFrustum& frustum, std::vector<bool>& visible) const {
+	size_t count = m_entities.size();
+	visible.resize(count);
+
+	// Broadcast the planes once, absolute values are needed for the projected radius of the boxes.
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+	for (int i = 0; i < 6; ++i) {
+		const Vec4& plane = frustum[i];
+		planeX[i] = _mm_set1_ps(plane.x);
+		planeY[i] = _mm_set1_ps(plane.y);
+		planeZ[i] = _mm_set1_ps(plane.z);
+		planeW[i] = _mm_set1_ps(plane.w);
+		absPlaneX[i] = _mm_set1_ps(std::abs(plane.x));
+		absPlaneY[i] = _mm_set1_ps(std::abs(plane.y));
+		absPlaneZ[i] = _mm_set1_ps(std::abs(plane.z));
+	}
+	const __m128 zero = _mm_setzero_ps();
+
+	// Test four boxes against a plane at once. Boxes that are entirely behind any of the planes are culled.
+	// Infinite extents produce NaNs for axis aligned planes, which never compare less, so such boxes stay visible.
+	for (size_t base = 0; base < count; base += 4) {
+		__m128 centerX = _mm_loadu_ps(m_centerX.data() + base);
+		__m128 centerY = _mm_loadu_ps(m_centerY.data() + base);
+		__m128 centerZ = _mm_loadu_ps(m_centerZ.data() + base);
+		__m128 extentX = _mm_loadu_ps(m_extentX.data() + base);
+		__m128 extentY = _mm_loadu_ps(m_extentY.data() + base);
+		__m128 extentZ = _mm_loadu_ps(m_extentZ.data() + base);
+
+		__m128 outside = zero;
+		for (int i = 0; i < 6; ++i) {
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(planeX[i], centerX), _mm_mul_ps(planeY[i], centerY)),
+				_mm_add_ps(_mm_mul_ps(planeZ[i], centerZ), planeW[i]));
+			__m128 radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(absPlaneX[i], extentX), _mm_mul_ps(absPlaneY[i], extentY)),
+				_mm_mul_ps(absPlaneZ[i], extentZ));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int mask = _mm_movemask_ps(outside);
+		size_t last = std::min(base + 4, count);
+		for (size_t index = base; index < last; ++index) {
+			visible[index] = (mask & (1 << (index - base))) == 0;
+		}
+	}
+}
+
+
+void DrawListBuilder::Build(const ViewFrustum& frustum, std::vector<DrawItem>& drawList, const LodSelector* lodSelector) const {
+	std::vector<bool> visible;
+	Cull(frustum, visible);
+
+	drawList.clear();
+	for (size_t index = 0; index < m_entities.size(); ++index) {
+		if (!visible[index]) {
+			continue;
+		}
+		const MeshEntity* entity = m_entities[index];
+		Material* material = entity->GetMaterial();
+		unsigned lod = lodSelector != nullptr ? lodSelector->GetLod(index, entity) : 0;
+		drawList.push_back(DrawItem{ entity, entity->GetMesh(), material, material != nullptr ? material->GetShader() : nullptr, lod });
+	}
+
+	Sort(drawList);
+}
+
+
+void DrawListBuilder::Sort(std::vector<DrawItem>& drawList) {
+	auto LayoutHash = [](const DrawItem& item) {
+		return item.mesh != nullptr ? item.mesh->GetLayout().GetLayoutHash() : size_t(0);
+	};
+
+	std::sort(drawList.begin(), drawList.end(), [&LayoutHash](const DrawItem& lhs, const DrawItem& rhs) {
+		size_t lhsLayout = LayoutHash(lhs);
+		size_t rhsLayout = LayoutHash(rhs);
+		if (lhsLayout != rhsLayout) {
+			return lhsLayout < rhsLayout;
+		}
+		if (lhs.shader != rhs.shader) {
+			return std::less<const MaterialShader*>{}(lhs.shader, rhs.shader);
+		}
+		if (lhs.material != rhs.material) {
+			return std::less<Material*>{}(lhs.material, rhs.material);
+		}
+		if (lhs.mesh != rhs.mesh) {
+			return std::less<Mesh*>{}(lhs.mesh, rhs.mesh);
+		}
+		return lhs.lod < rhs.lod;
+	});
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "EntityCollection.hpp"
+
+#include <InlineMath.hpp>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+class MeshEntity;
+class Mesh;
+class LodSelector;
+class Material;
+class MaterialShader;
+
+
+/// <summary> The six clip planes of a view-projection matrix. </summary>
+/// <remarks> Expects a D3D style projection that maps visible depth to [0, 1]. </remarks>
+class ViewFrustum {
+public:
+	ViewFrustum() = default;
+	explicit ViewFrustum(const Mat44& viewProjection);
+
+	/// <summary> Drops the planes which a box moving along <paramref name="direction"/> would eventually get inside of. </summary>
+	/// <remarks> Boxes outside the result cannot cast shadows into the frustum for a directional light. </remarks>
+	ViewFrustum Extruded(const Vec3& direction) const;
+
+	/// <summary> Plane equations in world space, the normals point inside. </summary>
+	/// <remarks> Order is left, right, bottom, top, near, far. </remarks>
+	const Vec4& operator[](size_t index) const { return m_planes[index]; }
+private:
+	Vec4 m_planes[6];
+};
+
+
+/// <summary> Culls the clusters of meshes, see <see cref="MeshOptimization::clusters"/>, one entity at a time. </summary>
+/// <remarks>
+/// Clusters outside the frustum and clusters whose triangles all face away from the camera are dropped.
+/// Neither changes the depth of the visible pixels, so a depth prepass may cull differently.
+/// </remarks>
+class ClusterCuller {
+public:
+	/// <summary> Consecutive visible clusters, merged into one draw. </summary>
+	struct IndexRange {
+		unsigned firstIndex;
+		unsigned numIndices;
+	};
+public:
+	ClusterCuller() = default;
+	/// <param name="viewProjection"> Decides the frustum and which way front faces turn, counter-clockwise on the screen. </param>
+	ClusterCuller(const Mat44& viewProjection, const Vec3& cameraPosition);
+
+	/// <summary> Replaces the ranges with the visible part of the entity's full mesh. </summary>
+	/// <remarks> The whole first level of detail if the mesh has no clusters. </remarks>
+	void Cull(const MeshEntity& entity, std::vector<IndexRange>& ranges) const;
+private:
+	ViewFrustum m_frustum;
+	Vec3 m_cameraPosition = { 0, 0, 0 };
+	float m_frontSign = 1.0f; // sign of the dot product of front face normals and the view ray
+};
+
+
+/// <summary> A mesh entity that passed culling. </summary>
+struct DrawItem {
+	const MeshEntity* entity;
+	Mesh* mesh;
+	Material* material;
+	const MaterialShader* shader;
+	unsigned lod = 0; /// <summary> Level of detail of the mesh to draw. </summary>
+};
+
+
+/// <summary>
+/// Culls the mesh entities of a scene against view frustums and emits the visible ones as a draw list.
+/// <para/>
+/// The draw list is sorted by vertex layout and material shader first, which decide the pipeline state,
+/// then by material and mesh, so that consecutive draws only need to rebind what actually changed.
+/// </summary>
+/// <remarks>
+/// The world space bounds are calculated once in <see cref="SetEntities"/>, and can be culled against
+/// any number of frustums afterwards, like the cascades of a shadow map.
+/// </remarks>
+class DrawListBuilder {
+public:
+	/// <summary> Calculates the world space bounding boxes of the entities. </summary>
+	/// <remarks> Call once per frame, after the entities have been moved.
+	///		Bounds of entities that have not moved since the previous call are reused. </remarks>
+	void SetEntities(const EntityCollection<MeshEntity>& entities);
+
+	/// <summary> True if the entities or any of their bounds changed in the last call to <see cref="SetEntities"/>. </summary>
+	bool HasChanged() const { return m_changed; }
+
+	/// <summary> Marks the entities whose bounding boxes intersect the frustum. </summary>
+	/// <param name="visible"> Resized to the number of entities, true for the ones in the frustum. </param>
+	void Cull(const ViewFrustum& frustum, std::vector<bool>& visible) const;
+
+	/// <summary> Culls the entities against the frustum and replaces the draw list with the sorted visible ones. </summary>
+	/// <param name="lodSelector"> Updated with the same entities, the full meshes are drawn if null. </param>
+	void Build(const ViewFrustum& frustum, std::vector<DrawItem>& drawList, const LodSelector* lodSelector = nullptr) const;
+
+	/// <summary> Sorts the draw list by pipeline state, material, mesh and level of detail. </summary>
+	static void Sort(std::vector<DrawItem>& drawList);
+
+	size_t GetNumEntities() const { return m_entities.size(); }
+	const MeshEntity* GetEntity(size_t index) const { return m_entities[index]; }
+private:
+	struct EntityPose {
+		const Mesh* mesh;
+		Vec3 position;
+		Quat rotation;
+		Vec3 scale;
+		Vec3 meshCenter;
+		Vec3 meshExtent;
+
+		bool operator==(const EntityPose& rhs) const;
+	};
+
+	static EntityPose GetPose(const MeshEntity& entity);
+	void CalculateBounds(size_t index, const MeshEntity& entity);
+private:
+	std::vector<const MeshEntity*> m_entities;
+	std::vector<EntityPose> m_poses; // the state the bounds were calculated from
+	bool m_changed = true;
+
+	// Bounding boxes as structure of arrays, padded to a multiple of four.
+	std::vector<float> m_centerX, m_centerY, m_centerZ;
+	std::vector<float> m_extentX, m_extentY, m_extentZ;
+};
+
+
+} // namespace inl::gxeng
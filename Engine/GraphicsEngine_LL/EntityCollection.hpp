@@ -1,6 +1,10 @@
 #pragma once
 
-#include <set>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
 
 #include <BaseLibrary\Exception\Exception.hpp>
 
@@ -8,11 +12,27 @@ namespace inl {
 namespace gxeng {
 
 
+/// <summary>
+/// An unordered set of entities stored densely, so that render passes iterate a contiguous array.
+/// <para/>
+/// Adding and removing is O(1). Removal moves the last entity into the hole, so the order changes,
+/// but handles returned by <see cref="Add"/> stay valid until their own entity is removed.
+/// </summary>
 template <class EntityType>
 class EntityCollection {
 public:
-	using iterator = typename std::set<EntityType*>::iterator;
-	using const_iterator = typename std::set<EntityType*>::const_iterator;
+	/// <summary> Identifies an entity in the collection, unaffected by other entities being added or removed. </summary>
+	struct Handle {
+		uint32_t slot = std::numeric_limits<uint32_t>::max();
+		uint32_t generation = 0;
+
+		bool operator==(const Handle& rhs) const { return slot == rhs.slot && generation == rhs.generation; }
+		bool operator!=(const Handle& rhs) const { return !(*this == rhs); }
+	};
+
+	// The entities cannot be replaced via iterators, only via Add/Remove.
+	using iterator = typename std::vector<EntityType*>::const_iterator;
+	using const_iterator = typename std::vector<EntityType*>::const_iterator;
 public:
 	iterator begin();
 	iterator end();
@@ -24,23 +44,62 @@ public:
 	bool IsEmpty() const;
 	size_t Size() const;
 
-	void Add(EntityType* entity);
+	/// <summary> Returns the index-th entity in iteration order. </summary>
+	EntityType* operator[](size_t index) const;
+
+	Handle Add(EntityType* entity);
 	void Remove(EntityType* entity);
+	void Remove(Handle handle);
 	bool Contains(EntityType* entity) const;
+	bool Contains(Handle handle) const;
 	void Clear();
+
+	/// <summary> Returns the handle of the entity, or an invalid handle if it's not a member. </summary>
+	Handle GetHandle(EntityType* entity) const;
+	EntityType* Get(Handle handle) const;
+	/// <summary> The position of the entity in iteration order. </summary>
+	size_t GetIndex(Handle handle) const;
 private:
-	std::set<EntityType*> m_entites;
+	struct Slot {
+		uint32_t index; // into the dense arrays, or the next free slot if this is free
+		uint32_t generation;
+	};
+	static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+	// Slot of each member entity, an open addressing table with linear probing.
+	// It is kept at most half full and only allocates when it grows.
+	struct LookupEntry {
+		const EntityType* entity = nullptr; // empty if null
+		uint32_t slot = NO_SLOT;
+	};
+	static constexpr size_t MIN_LOOKUP_SIZE = 16;
+
+	const Slot& GetSlot(Handle handle) const;
+
+	size_t LookupHome(const EntityType* entity) const;
+	/// <summary> Position of the entity in the table, or of the empty entry where it would go. </summary>
+	size_t LookupPosition(const EntityType* entity) const;
+	uint32_t FindSlot(const EntityType* entity) const;
+	void InsertLookup(const EntityType* entity, uint32_t slot);
+	void EraseLookup(const EntityType* entity);
+private:
+	std::vector<EntityType*> m_entites;
+	std::vector<uint32_t> m_slotOfIndex;
+
+	std::vector<Slot> m_slots;
+	uint32_t m_firstFreeSlot = NO_SLOT;
+	std::vector<LookupEntry> m_lookup;
 };
 
 
 template <class EntityType>
 typename EntityCollection<EntityType>::iterator EntityCollection<EntityType>::begin() {
-	return m_entites.begin();
+	return m_entites.cbegin();
 }
 
 template <class EntityType>
 typename EntityCollection<EntityType>::iterator EntityCollection<EntityType>::end() {
-	return m_entites.end();
+	return m_entites.cend();
 }
 
 template <class EntityType>
@@ -74,29 +133,181 @@ size_t EntityCollection<EntityType>::Size() const {
 }
 
 template <class EntityType>
-void EntityCollection<EntityType>::Add(EntityType* entity) {
-	auto result = m_entites.insert(entity);
-	if (result.second == false) {
+EntityType* EntityCollection<EntityType>::operator[](size_t index) const {
+	return m_entites[index];
+}
+
+template <class EntityType>
+typename EntityCollection<EntityType>::Handle EntityCollection<EntityType>::Add(EntityType* entity) {
+	if (entity == nullptr) {
+		throw InvalidArgumentException("Entity must not be null.");
+	}
+	if (FindSlot(entity) != NO_SLOT) {
 		throw InvalidArgumentException("Entity already member of this collection.");
 	}
+
+	uint32_t slot = m_firstFreeSlot;
+	if (slot != NO_SLOT) {
+		m_firstFreeSlot = m_slots[slot].index;
+	}
+	else {
+		slot = (uint32_t)m_slots.size();
+		m_slots.push_back({ NO_SLOT, 0 });
+	}
+
+	m_slots[slot].index = (uint32_t)m_entites.size();
+	m_entites.push_back(entity);
+	m_slotOfIndex.push_back(slot);
+	InsertLookup(entity, slot);
+
+	return Handle{ slot, m_slots[slot].generation };
 }
 
 template <class EntityType>
 void EntityCollection<EntityType>::Remove(EntityType* entity) {
-	m_entites.erase(entity);
+	Handle handle = GetHandle(entity);
+	if (handle.slot != NO_SLOT) {
+		Remove(handle);
+	}
+}
+
+template <class EntityType>
+void EntityCollection<EntityType>::Remove(Handle handle) {
+	if (!Contains(handle)) {
+		throw InvalidArgumentException("Handle does not refer to a member of this collection.");
+	}
+
+	// Move the last entity into the hole.
+	Slot& slot = m_slots[handle.slot];
+	const uint32_t index = slot.index;
+	const uint32_t lastIndex = (uint32_t)m_entites.size() - 1;
+
+	EraseLookup(m_entites[index]);
+	if (index != lastIndex) {
+		m_entites[index] = m_entites[lastIndex];
+		m_slotOfIndex[index] = m_slotOfIndex[lastIndex];
+		m_slots[m_slotOfIndex[index]].index = index;
+	}
+	m_entites.pop_back();
+	m_slotOfIndex.pop_back();
+
+	// Bump the generation to invalidate outstanding handles.
+	++slot.generation;
+	slot.index = m_firstFreeSlot;
+	m_firstFreeSlot = handle.slot;
 }
 
 template <class EntityType>
 bool EntityCollection<EntityType>::Contains(EntityType* entity) const {
-	return m_entites.count(entity) > 0;
+	return FindSlot(entity) != NO_SLOT;
+}
+
+template <class EntityType>
+bool EntityCollection<EntityType>::Contains(Handle handle) const {
+	return handle.slot < m_slots.size()
+		&& m_slots[handle.slot].generation == handle.generation
+		&& m_slots[handle.slot].index < m_entites.size()
+		&& m_slotOfIndex[m_slots[handle.slot].index] == handle.slot;
 }
 
 template <class EntityType>
 void EntityCollection<EntityType>::Clear() {
+	for (uint32_t slot : m_slotOfIndex) {
+		++m_slots[slot].generation;
+		m_slots[slot].index = m_firstFreeSlot;
+		m_firstFreeSlot = slot;
+	}
 	m_entites.clear();
+	m_slotOfIndex.clear();
+	std::fill(m_lookup.begin(), m_lookup.end(), LookupEntry{});
+}
+
+template <class EntityType>
+typename EntityCollection<EntityType>::Handle EntityCollection<EntityType>::GetHandle(EntityType* entity) const {
+	uint32_t slot = FindSlot(entity);
+	if (slot == NO_SLOT) {
+		return Handle{};
+	}
+	return Handle{ slot, m_slots[slot].generation };
+}
+
+template <class EntityType>
+EntityType* EntityCollection<EntityType>::Get(Handle handle) const {
+	return m_entites[GetSlot(handle).index];
+}
+
+template <class EntityType>
+size_t EntityCollection<EntityType>::GetIndex(Handle handle) const {
+	return GetSlot(handle).index;
+}
+
+template <class EntityType>
+auto EntityCollection<EntityType>::GetSlot(Handle handle) const -> const Slot& {
+	if (!Contains(handle)) {
+		throw InvalidArgumentException("Handle does not refer to a member of this collection.");
+	}
+	return m_slots[handle.slot];
+}
+
+template <class EntityType>
+size_t EntityCollection<EntityType>::LookupHome(const EntityType* entity) const {
+	// Fibonacci hashing, the low bits of pointers are mostly zero.
+	uint64_t hash = uint64_t(reinterpret_cast<uintptr_t>(entity)) * 0x9E3779B97F4A7C15ull;
+	return size_t(hash >> 32) & (m_lookup.size() - 1);
+}
+
+template <class EntityType>
+size_t EntityCollection<EntityType>::LookupPosition(const EntityType* entity) const {
+	const size_t mask = m_lookup.size() - 1;
+	size_t position = LookupHome(entity);
+	while (m_lookup[position].entity != nullptr && m_lookup[position].entity != entity) {
+		position = (position + 1) & mask;
+	}
+	return position;
+}
+
+template <class EntityType>
+uint32_t EntityCollection<EntityType>::FindSlot(const EntityType* entity) const {
+	if (m_lookup.empty() || entity == nullptr) {
+		return NO_SLOT;
+	}
+	const LookupEntry& entry = m_lookup[LookupPosition(entity)];
+	return entry.entity == entity ? entry.slot : NO_SLOT;
+}
+
+template <class EntityType>
+void EntityCollection<EntityType>::InsertLookup(const EntityType* entity, uint32_t slot) {
+	// The entity is already in the dense array.
+	if (m_entites.size() * 2 > m_lookup.size()) {
+		std::vector<LookupEntry> old = std::move(m_lookup);
+		m_lookup.assign(std::max(MIN_LOOKUP_SIZE, old.size() * 2), LookupEntry{});
+		for (const LookupEntry& entry : old) {
+			if (entry.entity != nullptr) {
+				m_lookup[LookupPosition(entry.entity)] = entry;
+			}
+		}
+	}
+	m_lookup[LookupPosition(entity)] = LookupEntry{ entity, slot };
+}
+
+template <class EntityType>
+void EntityCollection<EntityType>::EraseLookup(const EntityType* entity) {
+	// Shift the following entries of the run back so that lookups need no tombstones.
+	const size_t mask = m_lookup.size() - 1;
+	size_t hole = LookupPosition(entity);
+	assert(m_lookup[hole].entity == entity);
+	for (size_t position = (hole + 1) & mask; m_lookup[position].entity != nullptr; position = (position + 1) & mask) {
+		size_t distanceFromHome = (position - LookupHome(m_lookup[position].entity)) & mask;
+		size_t distanceFromHole = (position - hole) & mask;
+		if (distanceFromHome >= distanceFromHole) {
+			m_lookup[hole] = m_lookup[position];
+			hole = position;
+		}
+	}
+	m_lookup[hole] = LookupEntry{};
 }
 
 
 
 } // namespace gxeng
-} // namespace inl
\ No newline at end of file
+} // namespace inl
@@ -20,6 +20,7 @@ namespace gxeng {
 class CommandAllocatorPool;
 class CommandListPool;
 class ScratchSpacePool;
+class VolatileViewHeapPool;
 class Scene;
 class PerspectiveCamera;
 class RenderTargetView2D;
@@ -33,6 +34,7 @@ struct FrameContext {
 	CommandAllocatorPool* commandAllocatorPool = nullptr;
 	CommandListPool* commandListPool = nullptr;
 	ScratchSpacePool* scratchSpacePool = nullptr;
+	VolatileViewHeapPool* volatileViewHeapPool = nullptr;
 	MemoryManager* memoryManager = nullptr;
 	CbvSrvUavHeap* textureSpace = nullptr;
 	RTVHeap* rtvHeap = nullptr;
@@ -28,7 +28,11 @@ GraphicsCommandList::GraphicsCommandList(
 
 GraphicsCommandList::GraphicsCommandList(GraphicsCommandList&& rhs)
 	: ComputeCommandList(std::move(rhs)),
-	m_commandList(rhs.m_commandList)
+	m_commandList(rhs.m_commandList),
+	m_vertexBuffers(std::move(rhs.m_vertexBuffers)),
+	m_indexBufferAddress(rhs.m_indexBufferAddress),
+	m_indexBufferSize(rhs.m_indexBufferSize),
+	m_indexBuffer32Bit(rhs.m_indexBuffer32Bit)
 {
 	rhs.m_commandList = nullptr;
 }
@@ -37,6 +41,10 @@ GraphicsCommandList::GraphicsCommandList(GraphicsCommandList&& rhs)
 GraphicsCommandList& GraphicsCommandList::operator=(GraphicsCommandList&& rhs) {
 	ComputeCommandList::operator=(std::move(rhs));
 	m_commandList = rhs.m_commandList;
+	m_vertexBuffers = std::move(rhs.m_vertexBuffers);
+	m_indexBufferAddress = rhs.m_indexBufferAddress;
+	m_indexBufferSize = rhs.m_indexBufferSize;
+	m_indexBuffer32Bit = rhs.m_indexBuffer32Bit;
 	rhs.m_commandList = nullptr;
 
 	return *this;
@@ -50,6 +58,23 @@ BasicCommandList::Decomposition GraphicsCommandList::Decompose() {
 }
 
 
+void GraphicsCommandList::ClearStateCache() {
+	ComputeCommandList::ClearStateCache();
+	m_graphicsBindingManager.ClearBinder();
+	m_vertexBuffers.clear();
+	m_indexBufferAddress = nullptr;
+}
+
+
+CommandListStatistics GraphicsCommandList::GetStatistics() const {
+	CommandListStatistics statistics = ComputeCommandList::GetStatistics();
+	statistics.rootConstants += m_graphicsBindingManager.GetRootConstantStatistics();
+	statistics.descriptors += m_graphicsBindingManager.GetDescriptorStatistics();
+	statistics.descriptorTables += m_graphicsBindingManager.GetDescriptorTableStatistics();
+	return statistics;
+}
+
+
 //------------------------------------------------------------------------------
 // Clear buffers
 //------------------------------------------------------------------------------
@@ -105,7 +130,18 @@ void GraphicsCommandList::DrawInstanced(unsigned numVertices,
 
 void GraphicsCommandList::SetIndexBuffer(const IndexBuffer* resource, bool is32Bit) {
 	ExpectResourceState(*resource, gxapi::eResourceState::INDEX_BUFFER, { gxapi::ALL_SUBRESOURCES });
-	m_commandList->SetIndexBuffer(resource->GetVirtualAddress(),
+
+	void* virtualAddress = resource->GetVirtualAddress();
+	if (virtualAddress == m_indexBufferAddress && resource->GetSize() == m_indexBufferSize && is32Bit == m_indexBuffer32Bit) {
+		++m_statistics.indexBuffers.filtered;
+		return;
+	}
+	++m_statistics.indexBuffers.forwarded;
+	m_indexBufferAddress = virtualAddress;
+	m_indexBufferSize = resource->GetSize();
+	m_indexBuffer32Bit = is32Bit;
+
+	m_commandList->SetIndexBuffer(virtualAddress,
 		resource->GetSize(),
 		is32Bit ? gxapi::eFormat::R32_UINT : gxapi::eFormat::R16_UINT);
 }
@@ -129,6 +165,24 @@ void GraphicsCommandList::SetVertexBuffers(unsigned startSlot,
 		virtualAddresses[i] = resources[i]->GetVirtualAddress();
 	}
 
+	// Skip if all slots already hold the same buffers.
+	if (m_vertexBuffers.size() < startSlot + count) {
+		m_vertexBuffers.resize(startSlot + count, VertexBufferBinding{ nullptr, 0, 0 });
+	}
+	bool redundant = true;
+	for (unsigned i = 0; i < count; ++i) {
+		VertexBufferBinding& binding = m_vertexBuffers[startSlot + i];
+		if (binding.virtualAddress != virtualAddresses[i] || binding.size != sizeInBytes[i] || binding.stride != strideInBytes[i]) {
+			binding = { virtualAddresses[i], sizeInBytes[i], strideInBytes[i] };
+			redundant = false;
+		}
+	}
+	if (redundant) {
+		++m_statistics.vertexBuffers.filtered;
+		return;
+	}
+	++m_statistics.vertexBuffers.forwarded;
+
 	m_commandList->SetVertexBuffers(startSlot,
 		count,
 		virtualAddresses.get(),
@@ -196,11 +250,16 @@ void GraphicsCommandList::SetViewports(unsigned numViewports, gxapi::Viewport* v
 
 void GraphicsCommandList::SetGraphicsBinder(Binder* binder) {
 	assert(binder != nullptr);
+	if (binder == m_graphicsBindingManager.GetBinder()) {
+		++m_statistics.binders.filtered;
+		return;
+	}
+	++m_statistics.binders.forwarded;
 	m_graphicsBindingManager.SetBinder(binder);
 }
 
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureView1D& shaderResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const TextureView1D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -215,7 +274,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureVie
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureView2D& shaderResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const TextureView2D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -230,7 +289,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureVie
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureView3D& shaderResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const TextureView3D& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -245,7 +304,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureVie
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureViewCube& shaderResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const TextureViewCube& shaderResource) {
 	ExpectResourceState(
 		shaderResource.GetResource(),
 		gxapi::eResourceState{ gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE },
@@ -260,7 +319,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const TextureVie
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const ConstBufferView& shaderConstant) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const ConstBufferView& shaderConstant) {
 	if (dynamic_cast<const PersistentConstBuffer*>(&shaderConstant.GetResource())) {
 		m_additionalResources.push_back(shaderConstant.GetResource());
 	}
@@ -274,7 +333,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const ConstBuffe
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const void* shaderConstant, int size/*, int offset*/) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const void* shaderConstant, int size/*, int offset*/) {
 	try {
 		m_graphicsBindingManager.Bind(parameter, shaderConstant, size/*, offset*/);
 	}
@@ -291,7 +350,7 @@ void GraphicsCommandList::NewScratchSpace(size_t hint) {
 }
 
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureView1D& rwResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const RWTextureView1D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -303,7 +362,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureV
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureView2D& rwResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const RWTextureView2D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -315,7 +374,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureV
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureView3D& rwResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const RWTextureView3D& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	try {
@@ -327,7 +386,7 @@ void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWTextureV
 	}
 }
 
-void GraphicsCommandList::BindGraphics(BindParameter parameter, const RWBufferView& rwResource) {
+void GraphicsCommandList::BindGraphics(const BindHandle& parameter, const RWBufferView& rwResource) {
 	ExpectResourceState(rwResource.GetResource(), gxapi::eResourceState::UNORDERED_ACCESS, rwResource.GetSubresourceList());
 
 	{
@@ -83,22 +83,36 @@ public:
 	// set graphics root signature stuff
 	void SetGraphicsBinder(Binder* binder);
 
-	void BindGraphics(BindParameter parameter, const TextureView1D& shaderResource);
-	void BindGraphics(BindParameter parameter, const TextureView2D& shaderResource);
-	void BindGraphics(BindParameter parameter, const TextureView3D& shaderResource);
-	void BindGraphics(BindParameter parameter, const TextureViewCube& shaderResource);
-	void BindGraphics(BindParameter parameter, const ConstBufferView& shaderConstant);
-	void BindGraphics(BindParameter parameter, const void* shaderConstant, int size/*, int offset*/);
-	void BindGraphics(BindParameter parameter, const RWTextureView1D& rwResource);
-	void BindGraphics(BindParameter parameter, const RWTextureView2D& rwResource);
-	void BindGraphics(BindParameter parameter, const RWTextureView3D& rwResource);
-	void BindGraphics(BindParameter parameter, const RWBufferView& rwResource);
+	void BindGraphics(const BindHandle& parameter, const TextureView1D& shaderResource);
+	void BindGraphics(const BindHandle& parameter, const TextureView2D& shaderResource);
+	void BindGraphics(const BindHandle& parameter, const TextureView3D& shaderResource);
+	void BindGraphics(const BindHandle& parameter, const TextureViewCube& shaderResource);
+	void BindGraphics(const BindHandle& parameter, const ConstBufferView& shaderConstant);
+	void BindGraphics(const BindHandle& parameter, const void* shaderConstant, int size/*, int offset*/);
+	void BindGraphics(const BindHandle& parameter, const RWTextureView1D& rwResource);
+	void BindGraphics(const BindHandle& parameter, const RWTextureView2D& rwResource);
+	void BindGraphics(const BindHandle& parameter, const RWTextureView3D& rwResource);
+	void BindGraphics(const BindHandle& parameter, const RWBufferView& rwResource);
+
+	CommandListStatistics GetStatistics() const override;
 protected:
 	virtual Decomposition Decompose() override;
 	virtual void NewScratchSpace(size_t hint) override;
+	virtual void ClearStateCache() override;
 private:
 	gxapi::IGraphicsCommandList* m_commandList;
 
+	// input assembler state, calls that would set the same buffers are dropped
+	struct VertexBufferBinding {
+		void* virtualAddress;
+		unsigned size;
+		unsigned stride;
+	};
+	std::vector<VertexBufferBinding> m_vertexBuffers; // indexed by slot, null address if not yet set
+	void* m_indexBufferAddress = nullptr;
+	size_t m_indexBufferSize = 0;
+	bool m_indexBuffer32Bit = false;
+
 	// scratch space managment
 	BindingManager<gxapi::eCommandListType::GRAPHICS> m_graphicsBindingManager;
 };
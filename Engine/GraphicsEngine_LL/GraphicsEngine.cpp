@@ -82,9 +82,10 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_commandAllocatorPool(desc.graphicsApi),
 	m_commandListPool(desc.graphicsApi),
 	m_scratchSpacePool(desc.graphicsApi, gxapi::eDescriptorHeapType::CBV_SRV_UAV),
+	m_volatileViewHeapPool(desc.graphicsApi),
 	m_textureSpace(desc.graphicsApi),
 	m_masterCommandQueue(desc.graphicsApi->CreateCommandQueue(CommandQueueDesc{ eCommandListType::GRAPHICS }), desc.graphicsApi->CreateFence(0)),
-	m_residencyQueue(std::unique_ptr<gxapi::IFence>(desc.graphicsApi->CreateFence(0))),
+	m_residencyQueue(std::unique_ptr<gxapi::IFence>(desc.graphicsApi->CreateFence(0)), &m_memoryManager.GetResidencyManager()),
 	m_memoryManager(desc.graphicsApi),
 	m_dsvHeap(desc.graphicsApi),
 	m_rtvHeap(desc.graphicsApi),
@@ -140,6 +141,7 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 	m_commandAllocatorPool.SetLogStream(&m_logStreamPipeline);
 
 	m_pipelineEventDispatcher += &m_memoryManager.GetUploadManager();
+	m_pipelineEventDispatcher += &m_memoryManager.GetResidencyManager();
 	// DELETE THIS
 	m_pipelineEventPrinter.SetLog(&m_logStreamPipeline);
 	m_pipelineEventDispatcher += &m_pipelineEventPrinter;
@@ -154,7 +156,12 @@ GraphicsEngine::GraphicsEngine(GraphicsEngineDesc desc)
 GraphicsEngine::~GraphicsEngine() {
 	std::cout << "Graphics engine shutting down..." << std::endl;
 	SyncPoint lastSync = m_masterCommandQueue.Signal();
-	lastSync.Wait();
+	try {
+		m_residencyQueue.Wait(lastSync);
+	}
+	catch (std::exception&) {
+		// The GPU is stuck behind a failed residency init, the residency queue releases it when destroyed.
+	}
 	std::cout << "Graphics engine deleting..." << std::endl;
 }
 
@@ -166,7 +173,7 @@ void GraphicsEngine::Update(float elapsed) {
 	// Wait for previous frame on this BB to complete
 	int backBufferIndex = m_swapChain->GetCurrentBufferIndex();
 	if (m_frameEndFenceValues[backBufferIndex]) {
-		m_frameEndFenceValues[backBufferIndex].Wait();
+		m_residencyQueue.Wait(m_frameEndFenceValues[backBufferIndex]);
 	}
 
 	// Set up context
@@ -180,6 +187,7 @@ void GraphicsEngine::Update(float elapsed) {
 	context.commandAllocatorPool = &m_commandAllocatorPool;
 	context.commandListPool = &m_commandListPool;
 	context.scratchSpacePool = &m_scratchSpacePool;
+	context.volatileViewHeapPool = &m_volatileViewHeapPool;
 	context.memoryManager = &m_memoryManager;
 	context.textureSpace = &m_textureSpace;
 	context.rtvHeap = &m_rtvHeap;
@@ -227,7 +235,7 @@ void GraphicsEngine::SetScreenSize(unsigned width, unsigned height) {
 	}
 
 	SyncPoint sp = m_masterCommandQueue.Signal();
-	sp.Wait();
+	m_residencyQueue.Wait(sp);
 
 	m_backBufferHeap.reset();
 	m_scheduler.ReleaseResources();
@@ -250,6 +258,16 @@ bool GraphicsEngine::GetFullScreen() const {
 
 
 // Resources
+void GraphicsEngine::SetMemoryBudget(uint64_t bytes) {
+	m_memoryManager.GetResidencyManager().SetBudget(bytes);
+}
+uint64_t GraphicsEngine::GetMemoryBudget() const {
+	return m_memoryManager.GetResidencyManager().GetBudget();
+}
+ResidencyStatistics GraphicsEngine::GetResidencyStatistics() const {
+	return m_memoryManager.GetResidencyManager().GetStatistics();
+}
+
 Mesh* GraphicsEngine::CreateMesh() {
 	return new Mesh(&m_memoryManager);
 }
@@ -386,6 +404,15 @@ void GraphicsEngine::LoadPipeline(const std::string& graphDesc) {
 	Pipeline pipeline;
 	pipeline.CreateFromDescription(graphDesc, m_nodeFactory);
 
+	const Pipeline::CompilationReport& report = pipeline.GetCompilationReport();
+	m_logStreamPipeline.Event("Pipeline compiled: " + std::to_string(report.numNodes) + " nodes, "
+							  + std::to_string(report.prunedNodes.size()) + " pruned, "
+							  + std::to_string(report.foldedNodes.size()) + " folded, "
+							  + std::to_string(report.numTasks) + " tasks.");
+	for (const auto& name : report.prunedNodes) {
+		m_logStreamPipeline.Event("Pruned node, its outputs reach no sink: " + name);
+	}
+
 	EngineContext engineContext(1, 1);
 	for (auto& node : pipeline) {
 		if (auto graphicsNode = dynamic_cast<GraphicsNode*>(&node)) {
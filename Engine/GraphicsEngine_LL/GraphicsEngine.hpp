@@ -6,6 +6,7 @@
 #include "CommandAllocatorPool.hpp"
 #include "CommandListPool.hpp"
 #include "ScratchSpacePool.hpp"
+#include "VolatileViewHeapPool.hpp"
 #include "ResourceResidencyQueue.hpp"
 #include "PipelineEventDispatcher.hpp"
 #include "PipelineEventListener.hpp"
@@ -109,6 +110,12 @@ public:
 	MaterialShaderEquation* CreateMaterialShaderEquation();
 	MaterialShaderGraph* CreateMaterialShaderGraph();
 
+	/// <summary> Overrides the video memory the engine's resources may occupy, zero follows the budget the OS gives. </summary>
+	/// <remarks> When over the budget, the least recently used resources are evicted. </remarks>
+	void SetMemoryBudget(uint64_t bytes);
+	uint64_t GetMemoryBudget() const;
+	ResidencyStatistics GetResidencyStatistics() const;
+
 
 	// Scene
 	Scene* CreateScene(std::string name);
@@ -160,6 +167,7 @@ private:
 	CommandAllocatorPool m_commandAllocatorPool;
 	CommandListPool m_commandListPool;
 	ScratchSpacePool m_scratchSpacePool; // Creates CBV_SRV_UAV type scratch spaces
+	VolatileViewHeapPool m_volatileViewHeapPool;
 	CbvSrvUavHeap m_textureSpace;
 	Pipeline m_pipeline;
 	Scheduler m_scheduler;
@@ -0,0 +1,76 @@
+#include "LodSelector.hpp"
+
+#include "MeshEntity.hpp"
+#include "Mesh.hpp"
+#include "BasicCamera.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace inl::gxeng {
+
+
+
+void LodSelector::Update(const EntityCollection<MeshEntity>& entities, const BasicCamera& camera, float viewportHeight) {
+	// Pixels a model space error of 1 covers at unit distance, from the vertical field of view of the projection.
+	const float projectionScale = std::abs(camera.GetProjectionMatrix()(1, 1)) * viewportHeight * 0.5f;
+	const Vec3 cameraPosition = camera.GetPosition();
+	const float nearPlane = std::max(camera.GetNearPlane(), std::numeric_limits<float>::min());
+
+	size_t count = entities.Size();
+	m_entities.resize(count, nullptr);
+	m_lods.resize(count, 0);
+
+	size_t index = 0;
+	for (const MeshEntity* entity : entities) {
+		// A different entity got the index, it starts from the full mesh.
+		if (m_entities[index] != entity) {
+			m_entities[index] = entity;
+			m_lods[index] = 0;
+		}
+
+		const Mesh* mesh = entity->GetMesh();
+		unsigned numLods = mesh != nullptr ? (unsigned)mesh->GetNumLods() : 0;
+		if (numLods <= 1) {
+			m_lods[index] = 0;
+			++index;
+			continue;
+		}
+
+		// Distance to the bounding sphere, the error grows with the largest scale.
+		Mat44 transform = entity->GetTransform();
+		Vec3 scale = entity->GetScale();
+		float maxScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+		Vec3 worldCenter = Vec3((Vec4(mesh->GetBoundingBoxCenter(), 1.0f) * transform).xyz);
+		float radius = mesh->GetBoundingBoxExtent().Length() * maxScale;
+		float distance = std::max((worldCenter - cameraPosition).Length() - radius, nearPlane);
+
+		auto ScreenError = [&](unsigned lod) {
+			return mesh->GetLod(lod).error * maxScale * projectionScale / distance;
+		};
+
+		unsigned lod = std::min(m_lods[index], numLods - 1);
+		while (lod > 0 && ScreenError(lod) > m_threshold) {
+			--lod;
+		}
+		while (lod + 1 < numLods && ScreenError(lod + 1) <= m_threshold * (1.0f - m_hysteresis)) {
+			++lod;
+		}
+		m_lods[index] = lod;
+
+		++index;
+	}
+}
+
+
+unsigned LodSelector::GetLod(size_t index, const MeshEntity* entity) const {
+	if (index < m_entities.size() && m_entities[index] == entity) {
+		return m_lods[index];
+	}
+	return 0;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "EntityCollection.hpp"
+
+#include <InlineMath.hpp>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+class MeshEntity;
+class BasicCamera;
+
+
+/// <summary>
+/// Picks the level of detail of each mesh entity by how large the simplification error of the levels looks on the screen.
+/// <para/>
+/// The coarsest level whose error projects to at most the threshold is drawn. Coarser levels are only switched to
+/// once their error is below the threshold by the hysteresis, so entities at the switching distance don't flicker.
+/// </summary>
+/// <remarks>
+/// Selection depends only on the camera and the previous selection, passes drawing the same entities with the
+/// same camera select the same levels, as needed for depth prepasses.
+/// </remarks>
+class LodSelector {
+public:
+	/// <summary> Largest error of a level on the screen, in pixels. </summary>
+	void SetThreshold(float pixels) { m_threshold = pixels; }
+	float GetThreshold() const { return m_threshold; }
+
+	/// <summary> Fraction of the threshold the error of a coarser level must be below to switch to it. </summary>
+	void SetHysteresis(float fraction) { m_hysteresis = fraction; }
+	float GetHysteresis() const { return m_hysteresis; }
+
+	/// <summary> Selects the levels of all entities, visible or not, once per frame. </summary>
+	/// <param name="viewportHeight"> Height of the render target in pixels. </param>
+	void Update(const EntityCollection<MeshEntity>& entities, const BasicCamera& camera, float viewportHeight);
+
+	/// <summary> The level of the index-th entity of the collection given to <see cref="Update"/>. </summary>
+	/// <remarks> The full mesh if the entity is not at that index. </remarks>
+	unsigned GetLod(size_t index, const MeshEntity* entity) const;
+private:
+	std::vector<const MeshEntity*> m_entities;
+	std::vector<unsigned> m_lods; // of the entities at the same index
+	float m_threshold = 1.0f;
+	float m_hysteresis = 0.25f;
+};
+
+
+} // namespace inl::gxeng
@@ -17,7 +17,8 @@ namespace gxeng {
 
 MemoryManager::MemoryManager(gxapi::IGraphicsApi* graphicsApi) :
 	m_graphicsApi(graphicsApi),
-	m_criticalHeap(graphicsApi),
+	m_residencyManager(std::make_shared<ResidencyManager>(graphicsApi)),
+	m_criticalHeap(graphicsApi, m_residencyManager),
 	m_uploadHeap(graphicsApi),
 	m_constBufferHeap(graphicsApi)
 {}
@@ -41,6 +42,16 @@ UploadManager& MemoryManager::GetUploadManager() {
 }
 
 
+ResidencyManager& MemoryManager::GetResidencyManager() {
+	return *m_residencyManager;
+}
+
+
+const ResidencyManager& MemoryManager::GetResidencyManager() const {
+	return *m_residencyManager;
+}
+
+
 VolatileConstBuffer MemoryManager::CreateVolatileConstBuffer(const void* data, uint32_t size) {
 	return m_constBufferHeap.CreateVolatileBuffer(data, size);
 }
@@ -52,17 +63,13 @@ PersistentConstBuffer MemoryManager::CreatePersistentConstBuffer(const void * da
 
 
 VertexBuffer MemoryManager::CreateVertexBuffer(eResourceHeapType heap, size_t size) {
-	MemoryObjDesc desc = AllocateResource(heap, gxapi::ResourceDesc::Buffer(size));
-
-	VertexBuffer result(std::move(desc));
+	VertexBuffer result(AllocateBuffer(heap, size));
 	return result;
 }
 
 
 IndexBuffer MemoryManager::CreateIndexBuffer(eResourceHeapType heap, size_t size, size_t indexCount) {
-	MemoryObjDesc desc = AllocateResource(heap, gxapi::ResourceDesc::Buffer(size));
-
-	IndexBuffer result(std::move(desc), indexCount);
+	IndexBuffer result(AllocateBuffer(heap, size), indexCount);
 	return result;
 }
 
@@ -141,10 +148,7 @@ TextureCube MemoryManager::CreateTextureCube(eResourceHeapType heap, uint64_t wi
 }
 */
 
-MemoryObjDesc MemoryManager::AllocateResource(eResourceHeapType heap, const gxapi::ResourceDesc& desc) {
-
-	gxapi::ClearValue* pClearValue = nullptr;
-
+std::optional<gxapi::ClearValue> MemoryManager::GetDefaultClearValue(const gxapi::ResourceDesc& desc) {
 	bool depthStencilTexture = (desc.type == gxapi::eResourceType::TEXTURE) && (desc.textureDesc.flags & gxapi::eResourceFlags::ALLOW_DEPTH_STENCIL);
 	bool renderTargetTexture = (desc.type == gxapi::eResourceType::TEXTURE) && (desc.textureDesc.flags & gxapi::eResourceFlags::ALLOW_RENDER_TARGET);
 
@@ -171,18 +175,23 @@ MemoryObjDesc MemoryManager::AllocateResource(eResourceHeapType heap, const gxap
 		}
 	}
 
-	gxapi::ClearValue dsvClearValue(clearFormat, 1, 0);
-	gxapi::ClearValue rtvClearValue(clearFormat, gxapi::ColorRGBA(0, 0, 0, 1));
-	if (depthStencilTexture) {
-		pClearValue = &dsvClearValue;
-	}
 	if (renderTargetTexture) {
-		pClearValue = &rtvClearValue;
+		return gxapi::ClearValue(clearFormat, gxapi::ColorRGBA(0, 0, 0, 1));
 	}
+	if (depthStencilTexture) {
+		return gxapi::ClearValue(clearFormat, 1, 0);
+	}
+	return {};
+}
+
+
+MemoryObjDesc MemoryManager::AllocateResource(eResourceHeapType heap, const gxapi::ResourceDesc& desc) {
+	std::optional<gxapi::ClearValue> clearValue = GetDefaultClearValue(desc);
+	gxapi::ClearValue* pClearValue = clearValue ? &clearValue.value() : nullptr;
 
 	switch(heap) {
 	case eResourceHeapType::CRITICAL: 
-		return m_criticalHeap.Allocate(std::move(desc), pClearValue);
+		return m_criticalHeap.Allocate(desc, pClearValue);
 		break;
 	default:
 		assert(false);
@@ -192,5 +201,17 @@ MemoryObjDesc MemoryManager::AllocateResource(eResourceHeapType heap, const gxap
 }
 
 
+LinearBuffer MemoryManager::AllocateBuffer(eResourceHeapType heap, size_t size) {
+	switch (heap) {
+	case eResourceHeapType::CRITICAL:
+		return m_criticalHeap.AllocateBuffer(size);
+	default:
+		assert(false);
+	}
+
+	return LinearBuffer();
+}
+
+
 } // namespace gxeng
 } // namespace inl
@@ -5,6 +5,7 @@
 #include "CriticalBufferHeap.hpp"
 #include "UploadManager.hpp"
 #include "ConstBufferHeap.hpp"
+#include "ResidencyManager.hpp"
 
 #include "../GraphicsApi_LL/Common.hpp"
 #include "../GraphicsApi_D3D12/DescriptorHeap.hpp"
@@ -15,6 +16,8 @@
 #include <mutex>
 #include <cassert>
 #include <type_traits>
+#include <optional>
+#include <memory>
 
 namespace inl {
 namespace gxeng {
@@ -68,7 +71,8 @@ public:
 	MemoryManager(gxapi::IGraphicsApi* graphicsApi);
 
 	/// <summary>
-	/// Makes given resources resident.
+	/// Makes given resources resident, and keeps them so until unlocked.
+	/// Least recently used resources are evicted if the residency budget would be exceeded.
 	/// </summary>
 	/// <exception cref="inl::gxapi::OutOfMemory">
 	/// If there is not enough free memory in the resource's appropriate
@@ -79,13 +83,15 @@ public:
 	void LockResident(IterT begin, IterT end);
 
 	/// <summary>
-	/// WRITE A DESCRIPTION
+	/// Allows the resources to be evicted again when memory is needed for others.
 	/// </summary>
 	void UnlockResident(const std::vector<MemoryObject>& resources);
 	template<typename IterT>
 	void UnlockResident(IterT begin, IterT end);
 
 	UploadManager& GetUploadManager();
+	ResidencyManager& GetResidencyManager();
+	const ResidencyManager& GetResidencyManager() const;
 	VolatileConstBuffer CreateVolatileConstBuffer(const void* data, uint32_t size);
 	PersistentConstBuffer CreatePersistentConstBuffer(const void* data, uint32_t size);
 
@@ -101,19 +107,22 @@ public:
 	Texture3D CreateTexture3D(eResourceHeapType heap, const Texture3DDesc& desc, gxapi::eResourceFlags flags = gxapi::eResourceFlags::NONE);
 	//TextureCube CreateTextureCube(eResourceHeapType heap, uint64_t width, uint32_t height, gxapi::eFormat format, gxapi::eResourceFlags flags = gxapi::eResourceFlags::NONE, uint16_t arraySize = 1);
 
+	/// <summary> The optimized clear value render targets and depth buffers are created with. </summary>
+	/// <returns> Empty for other resources. </returns>
+	static std::optional<gxapi::ClearValue> GetDefaultClearValue(const gxapi::ResourceDesc& desc);
+
 protected:
 	gxapi::IGraphicsApi* m_graphicsApi;
 
+	std::shared_ptr<ResidencyManager> m_residencyManager; // shared with the deleters, resources may outlive the memory manager
 	impl::CriticalBufferHeap m_criticalHeap;
 
 	UploadManager m_uploadHeap;
 	ConstantBufferHeap m_constBufferHeap;
 
-	std::mutex m_evictablesMtx;
-	std::unordered_set<MemoryObject> m_evictables;
-
 protected:
 	MemoryObjDesc AllocateResource(eResourceHeapType heap, const gxapi::ResourceDesc& desc);
+	LinearBuffer AllocateBuffer(eResourceHeapType heap, size_t size);
 };
 
 
@@ -121,53 +130,15 @@ template<typename IterT>
 void MemoryManager::LockResident(IterT begin, IterT end) {
 	static_assert(std::is_same<typename IterT::value_type, MemoryObject>::value);
 
-	std::vector<gxapi::IResource*> lowLevelTargets;
-	std::vector<MemoryObject> highLevelTargets;
-
-	{
-		std::lock_guard<std::mutex> lock(m_evictablesMtx);
-
-		IterT currIter = begin;
-		while (currIter != end) {
-			auto& curr = *(currIter++);
-			auto currEvictableIter = m_evictables.find(curr);
-			bool evictable = currEvictableIter != m_evictables.end();
-			if (evictable) {
-				assert(curr._GetResident());
-				m_evictables.erase(currEvictableIter);
-			}
-			else {
-				if (curr._GetResident() == false) {
-					lowLevelTargets.push_back(curr._GetResourcePtr());
-					highLevelTargets.push_back(curr);
-				}
-			}
-		}
-
-		try {
-			m_graphicsApi->MakeResident(lowLevelTargets);
-		}
-		catch (OutOfMemoryException&) {
-			std::vector<gxapi::IResource*> toEvict;
-			toEvict.reserve(m_evictables.size());
-			for (auto& curr : m_evictables) {
-				// NOTE I'm not sure why 'curr' is a const reference. I had to add a const cast.
-				toEvict.push_back(const_cast<gxapi::IResource*>(curr._GetResourcePtr()));
-			}
-			m_graphicsApi->Evict(toEvict);
-			m_evictables.clear();
-
-			m_graphicsApi->MakeResident(lowLevelTargets);
-		}
+	std::vector<gxapi::IResource*> resources;
+	for (IterT it = begin; it != end; ++it) {
+		resources.push_back(it->_GetResourcePtr());
 	}
 
-	assert(lowLevelTargets.size() == highLevelTargets.size());
-	for (size_t i = 0; i < highLevelTargets.size(); i++) {
-		auto currLowlevel = lowLevelTargets[i];
-		auto& currHighLevel = highLevelTargets[i];
-		assert(currHighLevel._GetResourcePtr() == currLowlevel);
+	m_residencyManager->Lock(resources);
 
-		currHighLevel._SetResident(true);
+	for (IterT it = begin; it != end; ++it) {
+		it->_SetResident(true);
 	}
 }
 
@@ -176,8 +147,12 @@ template<typename IterT>
 void MemoryManager::UnlockResident(IterT begin, IterT end) {
 	static_assert(std::is_same<typename IterT::value_type, MemoryObject>::value);
 
-	std::lock_guard<std::mutex> lock(m_evictablesMtx);
-	m_evictables.insert(begin, end);
+	std::vector<gxapi::IResource*> resources;
+	for (IterT it = begin; it != end; ++it) {
+		resources.push_back(it->_GetResourcePtr());
+	}
+
+	m_residencyManager->Unlock(resources);
 }
 
 } // namespace gxeng
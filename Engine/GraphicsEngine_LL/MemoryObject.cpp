@@ -152,16 +152,50 @@ void MemoryObject::InitResourceStates(gxapi::eResourceState initialState) {
 //==================================
 
 
+LinearBuffer::LinearBuffer(MemoryObjDesc&& desc) :
+	MemoryObject(std::move(desc))
+{
+	m_size = GetDescription().bufferDesc.sizeInBytes;
+}
+
+
+LinearBuffer::LinearBuffer(const LinearBuffer& buffer, uint64_t offset, uint64_t size, std::shared_ptr<void> allocation) :
+	MemoryObject(buffer),
+	m_offset(buffer.m_offset + offset),
+	m_size(size),
+	m_allocation(std::move(allocation))
+{
+	assert(offset + size <= buffer.m_size);
+}
+
+
+void* LinearBuffer::GetVirtualAddress() const {
+	return static_cast<uint8_t*>(MemoryObject::GetVirtualAddress()) + m_offset;
+}
+
+
 uint64_t LinearBuffer::GetSize() const {
-	return GetDescription().bufferDesc.sizeInBytes;
+	return m_size;
 }
 
+
+uint64_t LinearBuffer::GetOffset() const {
+	return m_offset;
+}
+
+
 IndexBuffer::IndexBuffer(MemoryObjDesc&& desc, size_t indexCount) :
 	LinearBuffer(std::move(desc)),
 	m_indexCount(indexCount)
 {}
 
 
+IndexBuffer::IndexBuffer(LinearBuffer buffer, size_t indexCount) :
+	LinearBuffer(std::move(buffer)),
+	m_indexCount(indexCount)
+{}
+
+
 size_t IndexBuffer::GetIndexCount() const {
 	return m_indexCount;
 }
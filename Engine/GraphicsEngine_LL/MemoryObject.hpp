@@ -119,14 +119,29 @@ protected:
 
 class LinearBuffer : public MemoryObject {
 public:
+	LinearBuffer() = default;
+	explicit LinearBuffer(MemoryObjDesc&& desc);
+	/// <summary> Refers to a range of <paramref name="buffer"/>, sharing its resource and tracked state. </summary>
+	/// <param name="allocation"> Released with the last copy of this buffer, frees the range. </param>
+	LinearBuffer(const LinearBuffer& buffer, uint64_t offset, uint64_t size, std::shared_ptr<void> allocation);
+
+	void* GetVirtualAddress() const;
 	uint64_t GetSize() const;
-	using MemoryObject::MemoryObject;
+	/// <summary> Where the buffer starts in the underlying resource. </summary>
+	uint64_t GetOffset() const;
+
+protected:
+	uint64_t m_offset = 0;
+	uint64_t m_size = 0;
+	std::shared_ptr<void> m_allocation;
 };
 
 
 class VertexBuffer : public LinearBuffer {
 public:
-	using LinearBuffer::LinearBuffer;
+	VertexBuffer() = default;
+	explicit VertexBuffer(MemoryObjDesc&& desc) : LinearBuffer(std::move(desc)) {}
+	explicit VertexBuffer(LinearBuffer buffer) : LinearBuffer(std::move(buffer)) {}
 };
 
 
@@ -134,6 +149,7 @@ class IndexBuffer : public LinearBuffer {
 public:
 	IndexBuffer() : m_indexCount(0) {}
 	IndexBuffer(MemoryObjDesc&& desc, size_t indexCount);
+	IndexBuffer(LinearBuffer buffer, size_t indexCount);
 
 	size_t GetIndexCount() const;
 
@@ -3,6 +3,12 @@
 #include "VertexCompressor.hpp"
 #include <BaseLibrary/ArrayView.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cassert>
+
 
 
 namespace inl {
@@ -10,29 +16,53 @@ namespace gxeng {
 
 
 
-void Mesh::Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices) {
+void Mesh::Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices,
+			   const VertexCompression& compression, const MeshOptimization& optimization)
+{
 	// Create constants
 	auto& elements = vertexReader->GetElements();
 	std::vector<bool> elementMap(elements.size(), true);
 
+	// Reorder triangles and vertices
+	std::vector<unsigned> indexList(indices, indices + numIndices);
+	std::vector<uint8_t> reorderedVertices;
+	Optimize(indexList, vertices, vertexReader, numVertices, optimization, reorderedVertices);
+
+	// Positions are quantized within the bounding box.
+	CalculateBoundingBox(vertices, vertexReader, numVertices, false);
+	m_compression = compression;
+	if (compression.positions && std::isfinite(m_boundingBoxExtent.x)) {
+		m_positionOffset = m_boundingBoxCenter - m_boundingBoxExtent;
+		m_positionScale = m_boundingBoxExtent * 2.0f;
+	}
+	else {
+		m_positionOffset = { 0, 0, 0 };
+		m_positionScale = { 1, 1, 1 };
+	}
+
 	// Compress vertices
-	VertexCompressor compressor{ vertexReader, elementMap };
+	VertexCompressor compressor{ vertexReader, elementMap, m_compression };
+	compressor.SetPositionRange(m_positionOffset, m_positionScale);
 	std::vector<uint8_t> compressedData = compressor.GetCompressedStream(vertices, numVertices);
 	auto offsets = compressor.GetCompressedOffsets();
+	auto formats = compressor.GetCompressedFormats();
+	m_isCompressed = !compressor.IsPassthrough();
 
 	// Set data
 	VertexStream stream;
 	stream.stride = compressor.GetCompressedStride();
 	stream.count = numVertices;
 	stream.data = compressedData.data();
-	MeshBuffer::Set(&stream, &stream + 1, indices, indices + numIndices);
+	MeshBuffer::Set(&stream, &stream + 1, indexList.data(), indexList.data() + indexList.size());
 
 	// Set stream elements.
 	std::vector<std::vector<Element>> layout;
 	layout.clear();
 	std::vector<Element> streamElements;
 	for (size_t i = 0; i < elements.size(); ++i) {
-		streamElements.push_back(Element{ elements[i].semantic, elements[i].index, offsets[i] });
+		if (offsets[i] >= 0) { // elements folded into others are not stored
+			streamElements.push_back(Element{ elements[i].semantic, elements[i].index, offsets[i], formats[i] });
+		}
 	}
 	layout.push_back(streamElements);
 
@@ -47,18 +77,62 @@ void Mesh::Update(const VertexBase* vertices, const IVertexReader* vertexReader,
 	std::vector<bool> elementMap(elements.size(), true);
 
 	// Compress vertices
-	VertexCompressor compressor{ vertexReader, elementMap };
+	VertexCompressor compressor{ vertexReader, elementMap, m_compression };
+	compressor.SetPositionRange(m_positionOffset, m_positionScale);
 	std::vector<uint8_t> compressedData = compressor.GetCompressedStream(vertices, numVertices);
-	auto offsets = compressor.GetCompressedOffsets();
 
 	// Update data
-	MeshBuffer::Update(0, compressedData.data(), numVertices, offsetInVertices);
+	if (m_vertexRemap.empty()) {
+		MeshBuffer::Update(0, compressedData.data(), numVertices, offsetInVertices);
+	}
+	else {
+		if (offsetInVertices + numVertices > m_vertexRemap.size()) {
+			throw OutOfRangeException("Data doesn't fit in given vertex buffer.");
+		}
+		// Reordered vertices that are still adjacent are uploaded together.
+		size_t stride = compressor.GetCompressedStride();
+		size_t first = 0;
+		while (first < numVertices) {
+			size_t last = first + 1;
+			while (last < numVertices && m_vertexRemap[offsetInVertices + last] == m_vertexRemap[offsetInVertices + last - 1] + 1) {
+				++last;
+			}
+			MeshBuffer::Update(0, compressedData.data() + first * stride, last - first, m_vertexRemap[offsetInVertices + first]);
+			first = last;
+		}
+	}
+
+	// Only grow the bounds, the overwritten vertices are not known anymore.
+	CalculateBoundingBox(vertices, vertexReader, numVertices, true);
+
+	// The triangles of the clusters stay the same, but their spheres and cones follow the vertices.
+	auto& semantics = vertexReader->GetSemantics();
+	bool hasPositions = std::find(semantics.begin(), semantics.end(), eVertexElementSemantic::POSITION) != semantics.end();
+	if (!m_clusters.empty() && hasPositions) {
+		if (offsetInVertices + numVertices > m_clusterPositions.size()) {
+			throw OutOfRangeException("Data doesn't fit in given vertex buffer.");
+		}
+		ReadPositions(vertices, vertexReader, numVertices, m_clusterPositions.data() + offsetInVertices);
+		m_clusters = MeshOptimizer::BuildClusters(m_clusterIndices, m_clusterPositions, m_clusterMaxVertices, m_clusterMaxTriangles);
+	}
 }
 
 
 void Mesh::Clear() {
 	MeshBuffer::Clear();
 	m_layout.Clear();
+	m_boundingBoxCenter = { 0, 0, 0 };
+	m_boundingBoxExtent = { 0, 0, 0 };
+	m_compression = {};
+	m_isCompressed = false;
+	m_positionOffset = { 0, 0, 0 };
+	m_positionScale = { 1, 1, 1 };
+	m_optimizationReport = {};
+	m_vertexRemap.clear();
+	m_lods.clear();
+	m_clusters.clear();
+	m_clusterIndices.clear();
+	m_clusterPositions.clear();
 }
 
 
@@ -67,6 +141,218 @@ const Mesh::Layout& Mesh::GetLayout() const {
 }
 
 
+const Vec3& Mesh::GetBoundingBoxCenter() const {
+	return m_boundingBoxCenter;
+}
+
+
+const Vec3& Mesh::GetBoundingBoxExtent() const {
+	return m_boundingBoxExtent;
+}
+
+
+const VertexCompression& Mesh::GetCompression() const {
+	return m_compression;
+}
+
+
+bool Mesh::IsCompressed() const {
+	return m_isCompressed;
+}
+
+
+const Vec3& Mesh::GetPositionOffset() const {
+	return m_positionOffset;
+}
+
+
+const Vec3& Mesh::GetPositionScale() const {
+	return m_positionScale;
+}
+
+
+const MeshOptimizationReport& Mesh::GetOptimizationReport() const {
+	return m_optimizationReport;
+}
+
+
+size_t Mesh::GetNumLods() const {
+	return m_lods.size();
+}
+
+
+const Mesh::Lod& Mesh::GetLod(size_t index) const {
+	assert(index < m_lods.size());
+	return m_lods[index];
+}
+
+
+const std::vector<MeshCluster>& Mesh::GetClusters() const {
+	return m_clusters;
+}
+
+
+void Mesh::Optimize(std::vector<unsigned>& indices, const VertexBase*& vertices, const IVertexReader* vertexReader, size_t numVertices,
+					const MeshOptimization& optimization, std::vector<uint8_t>& reorderedVertices)
+{
+	m_vertexRemap.clear();
+	m_clusters.clear();
+	m_clusterIndices.clear();
+	m_clusterPositions.clear();
+	m_optimizationReport = {};
+	m_optimizationReport.index16Bit = numVertices <= 0xFFFFu; // see MeshBuffer::Set
+
+	// Everything below indexes by the vertices, MeshBuffer::Set validates too late.
+	if (indices.size() % 3 != 0) {
+		throw InvalidArgumentException("Index count not divisible by 3. Must be triangles.");
+	}
+	if (std::any_of(indices.begin(), indices.end(), [numVertices](unsigned index) { return index >= numVertices; })) {
+		throw InvalidArgumentException("Indices over-index the vertex buffers.");
+	}
+	if (optimization.clusters && (optimization.clusterMaxVertices < 3 || optimization.clusterMaxTriangles < 1)) {
+		throw InvalidArgumentException("Clusters must fit at least one triangle.");
+	}
+
+	bool reordersTriangles = optimization.vertexCache || optimization.overdraw || optimization.numLods > 1;
+	if (!reordersTriangles && !optimization.vertexFetch && !optimization.clusters) {
+		m_lods = { Lod{ 0, unsigned(indices.size()), 0.0f } };
+		return; // plain meshes don't pay for simulating the cache
+	}
+
+	m_optimizationReport.acmrBefore = MeshOptimizer::CalculateACMR(indices, numVertices, optimization.cacheSize);
+	m_optimizationReport.atvrBefore = MeshOptimizer::CalculateATVR(indices, numVertices, optimization.cacheSize);
+
+	auto& semantics = vertexReader->GetSemantics();
+	bool hasPositions = std::find(semantics.begin(), semantics.end(), eVertexElementSemantic::POSITION) != semantics.end();
+	std::vector<Vec3> positions;
+	if (hasPositions && (optimization.overdraw || optimization.numLods > 1 || optimization.clusters)) {
+		positions.resize(numVertices);
+		ReadPositions(vertices, vertexReader, numVertices, positions.data());
+	}
+
+	// Simplified levels share the vertices, each level is simplified from the full mesh.
+	std::vector<std::vector<unsigned>> lodIndices;
+	std::vector<float> lodErrors;
+	lodIndices.push_back(indices);
+	lodErrors.push_back(0.0f);
+	if (!positions.empty() && optimization.numLods > 1) {
+		Vec3 minimum = positions[0];
+		Vec3 maximum = minimum;
+		for (const Vec3& position : positions) {
+			minimum = Vec3::Min(minimum, position);
+			maximum = Vec3::Max(maximum, position);
+		}
+		float maxError = optimization.lodMaxError * (maximum - minimum).Length();
+
+		size_t targetIndexCount = indices.size();
+		for (unsigned lod = 1; lod < optimization.numLods; ++lod) {
+			targetIndexCount = size_t(float(targetIndexCount / 3) * optimization.lodReduction) * 3;
+			float error = 0.0f;
+			std::vector<unsigned> simplified = MeshOptimizer::Simplify(indices, positions, targetIndexCount, maxError, &error);
+			if (simplified.empty() || simplified.size() > lodIndices.back().size() * 9 / 10) {
+				break; // the error limit or the borders don't let it get any simpler
+			}
+			lodIndices.push_back(std::move(simplified));
+			lodErrors.push_back(error);
+		}
+	}
+
+	if (optimization.vertexCache) {
+		for (auto& levelIndices : lodIndices) {
+			MeshOptimizer::OptimizeVertexCache(levelIndices, numVertices, optimization.cacheSize);
+		}
+	}
+
+	if (optimization.overdraw && optimization.vertexCache && !positions.empty()) {
+		MeshOptimizer::OptimizeOverdraw(lodIndices[0], positions, optimization.cacheSize, optimization.overdrawThreshold);
+	}
+
+	// The full mesh comes first in the index buffer, the ranges stay the same. Renumbering the vertices later doesn't move the triangles.
+	if (optimization.clusters && !positions.empty()) {
+		m_clusters = MeshOptimizer::BuildClusters(lodIndices[0], positions, optimization.clusterMaxVertices, optimization.clusterMaxTriangles);
+		m_clusterIndices = lodIndices[0];
+		m_clusterPositions = positions;
+		m_clusterMaxVertices = optimization.clusterMaxVertices;
+		m_clusterMaxTriangles = optimization.clusterMaxTriangles;
+	}
+
+	// Vertices are fetched in the order of the full mesh, the lower levels use a subset of them.
+	if (optimization.vertexFetch) {
+		m_vertexRemap = MeshOptimizer::OptimizeVertexFetch(lodIndices[0], numVertices);
+		for (size_t lod = 1; lod < lodIndices.size(); ++lod) {
+			for (unsigned& index : lodIndices[lod]) {
+				index = m_vertexRemap[index];
+			}
+		}
+
+		size_t stride = vertexReader->GetStride();
+		reorderedVertices.resize(numVertices * stride);
+		for (size_t i = 0; i < numVertices; ++i) {
+			memcpy(reorderedVertices.data() + m_vertexRemap[i] * stride, reinterpret_cast<const uint8_t*>(vertices) + i * stride, stride);
+		}
+		vertices = reinterpret_cast<const VertexBase*>(reorderedVertices.data());
+	}
+
+	m_optimizationReport.acmrAfter = MeshOptimizer::CalculateACMR(lodIndices[0], numVertices, optimization.cacheSize);
+	m_optimizationReport.atvrAfter = MeshOptimizer::CalculateATVR(lodIndices[0], numVertices, optimization.cacheSize);
+
+	// The levels are consecutive ranges of the same index buffer.
+	indices.clear();
+	m_lods.clear();
+	for (size_t lod = 0; lod < lodIndices.size(); ++lod) {
+		m_lods.push_back(Lod{ unsigned(indices.size()), unsigned(lodIndices[lod].size()), lodErrors[lod] });
+		indices.insert(indices.end(), lodIndices[lod].begin(), lodIndices[lod].end());
+	}
+}
+
+
+void Mesh::CalculateBoundingBox(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, bool merge) {
+	auto& semantics = vertexReader->GetSemantics();
+	if (std::find(semantics.begin(), semantics.end(), eVertexElementSemantic::POSITION) == semantics.end()) {
+		float inf = std::numeric_limits<float>::infinity();
+		m_boundingBoxCenter = { 0, 0, 0 };
+		m_boundingBoxExtent = { inf, inf, inf };
+		return;
+	}
+	if (numVertices == 0) {
+		return;
+	}
+
+	Vec3 minimum, maximum;
+	if (merge) {
+		minimum = m_boundingBoxCenter - m_boundingBoxExtent;
+		maximum = m_boundingBoxCenter + m_boundingBoxExtent;
+	}
+	else {
+		float inf = std::numeric_limits<float>::infinity();
+		minimum = { inf, inf, inf };
+		maximum = { -inf, -inf, -inf };
+	}
+
+	int index = vertexReader->GetIndices(eVertexElementSemantic::POSITION).front();
+	int stride = vertexReader->GetStride();
+	for (size_t i = 0; i < numVertices; ++i) {
+		const VertexBase& vertex = *reinterpret_cast<const VertexBase*>(reinterpret_cast<const uint8_t*>(vertices) + i*stride);
+		Vec3 position = *reinterpret_cast<const Vec3_Packed*>(vertexReader->GetPointer(vertex, eVertexElementSemantic::POSITION, index));
+		minimum = Vec3::Min(minimum, position);
+		maximum = Vec3::Max(maximum, position);
+	}
+
+	m_boundingBoxCenter = (minimum + maximum) * 0.5f;
+	m_boundingBoxExtent = (maximum - minimum) * 0.5f;
+}
+
+
+void Mesh::ReadPositions(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, Vec3* positions) {
+	int index = vertexReader->GetIndices(eVertexElementSemantic::POSITION).front();
+	int stride = vertexReader->GetStride();
+	for (size_t i = 0; i < numVertices; ++i) {
+		const VertexBase& vertex = *reinterpret_cast<const VertexBase*>(reinterpret_cast<const uint8_t*>(vertices) + i*stride);
+		positions[i] = *reinterpret_cast<const Vec3_Packed*>(vertexReader->GetPointer(vertex, eVertexElementSemantic::POSITION, index));
+	}
+}
+
+
 
 bool Mesh::Layout::EqualElements(const Layout& rhs) const {
 	if (m_elementHash != rhs.m_elementHash) {
@@ -84,7 +370,8 @@ bool Mesh::Layout::EqualElements(const Layout& rhs) const {
 	for (size_t i = 0; i < lhsElements.size(); ++i) {
 		if (lhsElements[i].semantic != rhsElements[i].semantic
 			|| lhsElements[i].index != rhsElements[i].index
-			|| lhsElements[i].offset != rhsElements[i].offset)
+			|| lhsElements[i].offset != rhsElements[i].offset
+			|| lhsElements[i].format != rhsElements[i].format)
 		{
 			return false;
 		}
@@ -107,7 +394,8 @@ bool Mesh::Layout::EqualLayout(const Layout& rhs) const {
 	for (size_t i = 0; i < lhsElements.size(); ++i) {
 		if (lhsElements[i].semantic != rhsElements[i].semantic
 			|| lhsElements[i].index != rhsElements[i].index
-			|| lhsElements[i].offset != rhsElements[i].offset)
+			|| lhsElements[i].offset != rhsElements[i].offset
+			|| lhsElements[i].format != rhsElements[i].format)
 		{
 			return false;
 		}
@@ -203,6 +491,7 @@ void Mesh::Layout::CalculateHashes(const std::vector<std::vector<Element>>& layo
 		layoutHash ^= inthash((size_t)e.semantic);
 		layoutHash ^= inthash((size_t)e.index);
 		layoutHash ^= inthash((size_t)e.offset);
+		layoutHash ^= inthash((size_t)e.format);
 	}
 
 	// now we order allElements to remove layout information, and keep only element information
@@ -212,6 +501,7 @@ void Mesh::Layout::CalculateHashes(const std::vector<std::vector<Element>>& layo
 		elementHash ^= inthash((size_t)e.semantic);
 		elementHash ^= inthash((size_t)e.index);
 		elementHash ^= inthash((size_t)e.offset);
+		elementHash ^= inthash((size_t)e.format);
 	}
 }
 
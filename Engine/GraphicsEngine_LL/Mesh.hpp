@@ -2,6 +2,8 @@
 
 #include "MeshBuffer.hpp"
 #include "Vertex.hpp"
+#include "VertexCompressor.hpp"
+#include "MeshOptimizer.hpp"
 
 #include <type_traits>
 
@@ -16,6 +18,13 @@ public:
 		eVertexElementSemantic semantic;
 		int index;
 		int offset;
+		gxapi::eFormat format;
+	};
+	/// <summary> A level of detail, a range of the index buffer. </summary>
+	struct Lod {
+		unsigned firstIndex;
+		unsigned numIndices;
+		float error; /// <summary> Approximate distance from the surface of the full mesh, in model space. </summary>
 	};
 	struct Layout {
 	public:
@@ -46,7 +55,13 @@ public:
 public:
 	Mesh(MemoryManager* memoryManager) : MeshBuffer(memoryManager) {}
 
-	void Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices);
+	/// <summary> Uploads the vertices and indices, reordering them and compressing the vertex elements as requested. </summary>
+	void Set(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, const unsigned* indices, size_t numIndices,
+			 const VertexCompression& compression = {}, const MeshOptimization& optimization = {});
+	/// <summary> Overwrites vertices, compressed the same way as in <see cref="Set"/>. </summary>
+	/// <remarks> Compressed positions outside the box given at Set are clamped.
+	///		Offsets are in the original order of the vertices, even if Set reordered them.
+	///		Clusters keep their triangles, their bounds are recalculated from the new positions. </remarks>
 	void Update(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, size_t offsetInVertices);
 	void Clear();
 
@@ -57,8 +72,56 @@ public:
 	using MeshBuffer::IsIndexBuffer32Bit;
 
 	const Layout& GetLayout() const;
+
+	/// <summary> Center of the axis aligned bounding box of the vertex positions in model space. </summary>
+	const Vec3& GetBoundingBoxCenter() const;
+	/// <summary> Half the size of the bounding box along each axis. </summary>
+	/// <remarks> Infinite if the vertices have no position, so that the mesh is never culled. </remarks>
+	const Vec3& GetBoundingBoxExtent() const;
+
+	const VertexCompression& GetCompression() const;
+	/// <summary> True if any vertex element is stored in a different format than in the vertex. </summary>
+	bool IsCompressed() const;
+	/// <summary> Positions are decoded as offset + scale * stored, shaders do it for every mesh. </summary>
+	/// <remarks> Uncompressed positions have zero offset and unit scale. </remarks>
+	const Vec3& GetPositionOffset() const;
+	/// <summary> See <see cref="GetPositionOffset"/>. </summary>
+	const Vec3& GetPositionScale() const;
+
+	/// <summary> Vertex cache efficiency of the mesh before and after the optimization of the last Set. </summary>
+	/// <remarks> The ratios are zero if Set was not asked to optimize. </remarks>
+	const MeshOptimizationReport& GetOptimizationReport() const;
+
+	/// <summary> Levels of detail from the full mesh to the simplest, at least one after Set. </summary>
+	size_t GetNumLods() const;
+	/// <summary> Draw this range of the index buffer, the whole buffer has all levels. </summary>
+	const Lod& GetLod(size_t index) const;
+
+	/// <summary> Clusters of the full mesh, in index buffer order, empty if not enabled in Set. </summary>
+	/// <remarks> Together they cover the range of the first level of detail. </remarks>
+	const std::vector<MeshCluster>& GetClusters() const;
+private:
+	void Optimize(std::vector<unsigned>& indices, const VertexBase*& vertices, const IVertexReader* vertexReader, size_t numVertices,
+				  const MeshOptimization& optimization, std::vector<uint8_t>& reorderedVertices);
+	void CalculateBoundingBox(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, bool merge);
+	static void ReadPositions(const VertexBase* vertices, const IVertexReader* vertexReader, size_t numVertices, Vec3* positions);
 private:
 	Layout m_layout;
+	Vec3 m_boundingBoxCenter = { 0, 0, 0 };
+	Vec3 m_boundingBoxExtent = { 0, 0, 0 };
+	VertexCompression m_compression;
+	bool m_isCompressed = false;
+	Vec3 m_positionOffset = { 0, 0, 0 };
+	Vec3 m_positionScale = { 1, 1, 1 };
+	MeshOptimizationReport m_optimizationReport;
+	std::vector<unsigned> m_vertexRemap; // new index of each vertex given to Set, empty if not reordered
+	std::vector<Lod> m_lods;
+	std::vector<MeshCluster> m_clusters;
+	// What the clusters were built from, in the original order of the vertices, to rebuild them on Update.
+	std::vector<unsigned> m_clusterIndices;
+	std::vector<Vec3> m_clusterPositions;
+	unsigned m_clusterMaxVertices = 0;
+	unsigned m_clusterMaxTriangles = 0;
 };
 
 
@@ -0,0 +1,596 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+#include <cmath>
+
+
+namespace inl::gxeng {
+
+
+namespace {
+
+/// <summary> Simulates a FIFO post-transform cache, the way most hardware works. </summary>
+class FifoCache {
+public:
+	FifoCache(size_t numVertices, unsigned size) : m_insertionTimes(numVertices, 0), m_size(size), m_time(size + 1) {}
+
+	/// <returns> True if the vertex had to be transformed. </returns>
+	bool Access(unsigned vertex) {
+		if (m_time - m_insertionTimes[vertex] <= m_size) {
+			return false;
+		}
+		m_insertionTimes[vertex] = m_time;
+		++m_time;
+		return true;
+	}
+
+	/// <summary> Cache misses of a triangle. </summary>
+	unsigned Access(const unsigned* triangle) {
+		return unsigned(Access(triangle[0])) + unsigned(Access(triangle[1])) + unsigned(Access(triangle[2]));
+	}
+
+	void Flush() {
+		m_time += m_size + 1;
+	}
+private:
+	std::vector<uint64_t> m_insertionTimes; // the vertex is in the cache if fewer than m_size vertices were inserted since
+	uint64_t m_size;
+	uint64_t m_time;
+};
+
+
+
+/// <summary> Sum of squared distances from planes, as a symmetric 4x4 matrix. </summary>
+struct Quadric {
+	double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+
+	static Quadric FromPlane(double nx, double ny, double nz, double d) {
+		Quadric q;
+		q.a00 = nx * nx; q.a01 = nx * ny; q.a02 = nx * nz;
+		q.a11 = ny * ny; q.a12 = ny * nz;
+		q.a22 = nz * nz;
+		q.b0 = nx * d; q.b1 = ny * d; q.b2 = nz * d;
+		q.c = d * d;
+		return q;
+	}
+
+	Quadric& operator+=(const Quadric& rhs) {
+		a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02; a11 += rhs.a11; a12 += rhs.a12; a22 += rhs.a22;
+		b0 += rhs.b0; b1 += rhs.b1; b2 += rhs.b2;
+		c += rhs.c;
+		return *this;
+	}
+
+	double Evaluate(const Vec3& p) const {
+		double x = p.x, y = p.y, z = p.z;
+		double result = a00 * x * x + a11 * y * y + a22 * z * z
+			+ 2 * (a01 * x * y + a02 * x * z + a12 * y * z)
+			+ 2 * (b0 * x + b1 * y + b2 * z)
+			+ c;
+		return std::max(result, 0.0);
+	}
+};
+
+} // namespace
+
+
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize) {
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0) {
+		return;
+	}
+
+	// Triangles of each vertex.
+	std::vector<unsigned> liveTriangles(numVertices, 0);
+	for (unsigned index : indices) {
+		++liveTriangles[index];
+	}
+	std::vector<size_t> adjacencyOffsets(numVertices + 1, 0);
+	std::partial_sum(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+	std::vector<unsigned> adjacency(indices.size());
+	{
+		std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i) {
+			adjacency[fill[indices[i]]++] = unsigned(i / 3);
+		}
+	}
+
+	// Tipsify: fan around a vertex, then continue with the adjacent vertex that is going to stay in the cache
+	// for all its remaining triangles and was put there the earliest.
+	std::vector<int64_t> cacheTimes(numVertices, 0);
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<unsigned> deadEnds;
+	std::vector<unsigned> candidates;
+	std::vector<unsigned> result;
+	result.reserve(indices.size());
+
+	int64_t time = cacheSize + 1;
+	size_t cursor = 0;
+	int64_t fanning = indices[0];
+	while (fanning >= 0) {
+		candidates.clear();
+		for (size_t i = adjacencyOffsets[fanning]; i < adjacencyOffsets[fanning + 1]; ++i) {
+			unsigned triangle = adjacency[i];
+			if (emitted[triangle]) {
+				continue;
+			}
+			for (size_t j = 0; j < 3; ++j) {
+				unsigned vertex = indices[3 * triangle + j];
+				result.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveTriangles[vertex];
+				if (time - cacheTimes[vertex] > cacheSize) {
+					cacheTimes[vertex] = time;
+					++time;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// Next vertex from the candidates.
+		fanning = -1;
+		int64_t bestPriority = -1;
+		for (unsigned vertex : candidates) {
+			if (liveTriangles[vertex] > 0) {
+				int64_t priority = 0;
+				if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize) {
+					priority = time - cacheTimes[vertex];
+				}
+				if (priority > bestPriority) {
+					bestPriority = priority;
+					fanning = vertex;
+				}
+			}
+		}
+
+		// Dead end, go back to recently used vertices, or to the first one with triangles left.
+		while (fanning < 0 && !deadEnds.empty()) {
+			unsigned vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (liveTriangles[vertex] > 0) {
+				fanning = vertex;
+			}
+		}
+		while (fanning < 0 && cursor < numVertices) {
+			if (liveTriangles[cursor] > 0) {
+				fanning = cursor;
+			}
+			++cursor;
+		}
+	}
+
+	assert(result.size() == numTriangles * 3);
+	indices = std::move(result);
+}
+
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<Vec3>& positions, unsigned cacheSize, float threshold) {
+	const size_t numTriangles = indices.size() / 3;
+	if (numTriangles == 0) {
+		return;
+	}
+
+	FifoCache cache(positions.size(), cacheSize);
+
+	// Hard boundaries: the vertex cache optimization jumped to unrelated triangles.
+	std::vector<size_t> hardBoundaries;
+	for (size_t triangle = 0; triangle < numTriangles; ++triangle) {
+		if (cache.Access(&indices[3 * triangle]) == 3) {
+			hardBoundaries.push_back(triangle);
+		}
+	}
+	hardBoundaries.push_back(numTriangles);
+
+	// Soft boundaries: split the hard clusters where the cache efficiency is already good enough.
+	std::vector<size_t> clusters;
+	for (size_t i = 0; i + 1 < hardBoundaries.size(); ++i) {
+		size_t first = hardBoundaries[i];
+		size_t last = hardBoundaries[i + 1];
+
+		cache.Flush();
+		size_t clusterMisses = 0;
+		for (size_t triangle = first; triangle < last; ++triangle) {
+			clusterMisses += cache.Access(&indices[3 * triangle]);
+		}
+		float clusterThreshold = threshold * float(clusterMisses) / float(last - first);
+
+		cache.Flush();
+		clusters.push_back(first);
+		size_t misses = 0;
+		size_t count = 0;
+		for (size_t triangle = first; triangle < last; ++triangle) {
+			misses += cache.Access(&indices[3 * triangle]);
+			++count;
+			if (triangle + 1 < last && float(misses) / float(count) <= clusterThreshold) {
+				clusters.push_back(triangle + 1);
+				cache.Flush();
+				misses = count = 0;
+			}
+		}
+	}
+	clusters.push_back(numTriangles);
+
+	// Area weighted centroid and normal of the clusters, and of the whole mesh.
+	const size_t numClusters = clusters.size() - 1;
+	std::vector<Vec3> centroids(numClusters, Vec3{ 0, 0, 0 });
+	std::vector<Vec3> normals(numClusters, Vec3{ 0, 0, 0 });
+	Vec3 meshCentroid = { 0, 0, 0 };
+	float meshArea = 0.0f;
+	for (size_t cluster = 0; cluster < numClusters; ++cluster) {
+		float area = 0.0f;
+		for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle) {
+			const Vec3& p0 = positions[indices[3 * triangle + 0]];
+			const Vec3& p1 = positions[indices[3 * triangle + 1]];
+			const Vec3& p2 = positions[indices[3 * triangle + 2]];
+			Vec3 normal = Cross(p1 - p0, p2 - p0);
+			float triangleArea = normal.Length();
+			centroids[cluster] += (p0 + p1 + p2) * (triangleArea / 3.0f);
+			normals[cluster] += normal;
+			area += triangleArea;
+		}
+		meshCentroid += centroids[cluster];
+		meshArea += area;
+		centroids[cluster] = area > 0.0f ? centroids[cluster] / area : Vec3{ 0, 0, 0 };
+	}
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : Vec3{ 0, 0, 0 };
+
+	// Clusters on the outside facing outward occlude the rest, they go first.
+	std::vector<float> sortKeys(numClusters);
+	for (size_t cluster = 0; cluster < numClusters; ++cluster) {
+		float length = normals[cluster].Length();
+		Vec3 direction = length > 0.0f ? normals[cluster] / length : Vec3{ 0, 0, 0 };
+		sortKeys[cluster] = Dot(centroids[cluster] - meshCentroid, direction);
+	}
+	std::vector<size_t> order(numClusters);
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+		return sortKeys[lhs] > sortKeys[rhs];
+	});
+
+	std::vector<unsigned> result;
+	result.reserve(indices.size());
+	for (size_t cluster : order) {
+		result.insert(result.end(), indices.begin() + 3 * clusters[cluster], indices.begin() + 3 * clusters[cluster + 1]);
+	}
+	indices = std::move(result);
+}
+
+
+std::vector<unsigned> MeshOptimizer::OptimizeVertexFetch(std::vector<unsigned>& indices, size_t numVertices) {
+	constexpr unsigned UNUSED = ~0u;
+
+	std::vector<unsigned> remap(numVertices, UNUSED);
+	unsigned next = 0;
+	for (unsigned& index : indices) {
+		if (remap[index] == UNUSED) {
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+	for (unsigned& newIndex : remap) {
+		if (newIndex == UNUSED) {
+			newIndex = next++;
+		}
+	}
+
+	return remap;
+}
+
+
+std::vector<unsigned> MeshOptimizer::Simplify(const std::vector<unsigned>& indices, const std::vector<Vec3>& positions,
+											   size_t targetIndexCount, float maxError, float* resultError)
+{
+	const size_t numVertices = positions.size();
+	size_t numTriangles = indices.size() / 3;
+	std::vector<unsigned> triangles(indices.begin(), indices.begin() + numTriangles * 3);
+	std::vector<bool> deleted(numTriangles, false);
+
+	// Vertices of the same position share a quadric, seams between them are not moved.
+	std::vector<unsigned> positionIds(numVertices);
+	std::vector<unsigned> positionVertexCount;
+	{
+		struct PositionHash {
+			size_t operator()(const Vec3& v) const {
+				return std::hash<float>{}(v.x) ^ (std::hash<float>{}(v.y) * 31) ^ (std::hash<float>{}(v.z) * 131);
+			}
+		};
+		struct PositionEqual {
+			bool operator()(const Vec3& lhs, const Vec3& rhs) const { return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z; }
+		};
+		std::unordered_map<Vec3, unsigned, PositionHash, PositionEqual> ids;
+		for (size_t v = 0; v < numVertices; ++v) {
+			auto it = ids.insert({ positions[v], unsigned(ids.size()) }).first;
+			positionIds[v] = it->second;
+			if (it->second >= positionVertexCount.size()) {
+				positionVertexCount.push_back(0);
+			}
+			++positionVertexCount[it->second];
+		}
+	}
+
+	// Edges used by a single triangle are on an open border, counted by position so that seams are not borders.
+	std::vector<bool> locked(numVertices, false);
+	{
+		std::unordered_map<uint64_t, int> edgeUses;
+		auto EdgeKey = [&](unsigned a, unsigned b) {
+			uint64_t pa = positionIds[a], pb = positionIds[b];
+			return pa < pb ? (pa << 32 | pb) : (pb << 32 | pa);
+		};
+		for (size_t t = 0; t < numTriangles; ++t) {
+			for (int e = 0; e < 3; ++e) {
+				++edgeUses[EdgeKey(triangles[3 * t + e], triangles[3 * t + (e + 1) % 3])];
+			}
+		}
+		for (size_t t = 0; t < numTriangles; ++t) {
+			for (int e = 0; e < 3; ++e) {
+				unsigned a = triangles[3 * t + e], b = triangles[3 * t + (e + 1) % 3];
+				if (edgeUses[EdgeKey(a, b)] == 1) {
+					locked[a] = locked[b] = true;
+				}
+			}
+		}
+		for (size_t v = 0; v < numVertices; ++v) {
+			if (positionVertexCount[positionIds[v]] > 1) {
+				locked[v] = true;
+			}
+		}
+	}
+
+	// Quadrics of the triangles' planes, and the triangles of each vertex.
+	std::vector<Quadric> quadrics(positionVertexCount.size());
+	std::vector<std::vector<unsigned>> vertexTriangles(numVertices);
+	for (size_t t = 0; t < numTriangles; ++t) {
+		const Vec3& p0 = positions[triangles[3 * t + 0]];
+		const Vec3& p1 = positions[triangles[3 * t + 1]];
+		const Vec3& p2 = positions[triangles[3 * t + 2]];
+		Vec3 normal = Cross(p1 - p0, p2 - p0);
+		float length = normal.Length();
+		if (length > 0.0f) {
+			normal = normal / length;
+			Quadric plane = Quadric::FromPlane(normal.x, normal.y, normal.z, -Dot(normal, p0));
+			for (int j = 0; j < 3; ++j) {
+				quadrics[positionIds[triangles[3 * t + j]]] += plane;
+			}
+		}
+		for (int j = 0; j < 3; ++j) {
+			vertexTriangles[triangles[3 * t + j]].push_back(unsigned(t));
+		}
+	}
+
+	// Collapses of a vertex onto a neighbor, cheapest first. Entries are outdated once the source's version changes.
+	struct Collapse {
+		double cost;
+		unsigned from, to;
+		unsigned version;
+		bool operator<(const Collapse& rhs) const { return cost > rhs.cost; }
+	};
+	std::priority_queue<Collapse> collapses;
+	std::vector<unsigned> versions(numVertices, 0);
+	std::vector<bool> removed(numVertices, false);
+
+	auto CollapseCost = [&](unsigned from, unsigned to) {
+		Quadric q = quadrics[positionIds[from]];
+		q += quadrics[positionIds[to]];
+		return q.Evaluate(positions[to]);
+	};
+	auto PushCollapses = [&](unsigned from) {
+		if (locked[from] || removed[from]) {
+			return;
+		}
+		for (unsigned t : vertexTriangles[from]) {
+			if (deleted[t]) {
+				continue;
+			}
+			for (int j = 0; j < 3; ++j) {
+				unsigned to = triangles[3 * t + j];
+				if (to != from) {
+					collapses.push({ CollapseCost(from, to), from, to, versions[from] });
+				}
+			}
+		}
+	};
+	// The triangles around the vertex must not flip or degenerate when it moves.
+	auto IsCollapseValid = [&](unsigned from, unsigned to) {
+		for (unsigned t : vertexTriangles[from]) {
+			const unsigned* tri = &triangles[3 * t];
+			if (deleted[t] || tri[0] == to || tri[1] == to || tri[2] == to) {
+				continue;
+			}
+			Vec3 before[3], after[3];
+			for (int j = 0; j < 3; ++j) {
+				before[j] = positions[tri[j]];
+				after[j] = tri[j] == from ? positions[to] : positions[tri[j]];
+			}
+			Vec3 normalBefore = Cross(before[1] - before[0], before[2] - before[0]);
+			Vec3 normalAfter = Cross(after[1] - after[0], after[2] - after[0]);
+			if (Dot(normalBefore, normalAfter) <= 0.0f) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	for (unsigned v = 0; v < numVertices; ++v) {
+		PushCollapses(v);
+	}
+
+	const double maxCost = double(maxError) * double(maxError);
+	double largestCost = 0.0;
+	while (numTriangles * 3 > targetIndexCount && !collapses.empty()) {
+		Collapse collapse = collapses.top();
+		collapses.pop();
+		if (collapse.version != versions[collapse.from] || removed[collapse.from] || removed[collapse.to]) {
+			continue;
+		}
+		if (collapse.cost > maxCost) {
+			break;
+		}
+		if (!IsCollapseValid(collapse.from, collapse.to)) {
+			continue;
+		}
+
+		// Move the triangles of the vertex to its neighbor, the ones on the edge vanish.
+		unsigned from = collapse.from, to = collapse.to;
+		for (unsigned t : vertexTriangles[from]) {
+			if (deleted[t]) {
+				continue;
+			}
+			unsigned* tri = &triangles[3 * t];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) {
+				deleted[t] = true;
+				--numTriangles;
+			}
+			else {
+				for (int j = 0; j < 3; ++j) {
+					tri[j] = tri[j] == from ? to : tri[j];
+				}
+				vertexTriangles[to].push_back(t);
+			}
+		}
+		vertexTriangles[from].clear();
+		removed[from] = true;
+		quadrics[positionIds[to]] += quadrics[positionIds[from]];
+		largestCost = std::max(largestCost, collapse.cost);
+
+		// Costs around the neighbor changed.
+		std::vector<unsigned> neighbors;
+		for (unsigned t : vertexTriangles[to]) {
+			if (!deleted[t]) {
+				neighbors.insert(neighbors.end(), &triangles[3 * t], &triangles[3 * t] + 3);
+			}
+		}
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+		for (unsigned v : neighbors) {
+			++versions[v];
+			PushCollapses(v);
+		}
+	}
+
+	std::vector<unsigned> result;
+	result.reserve(numTriangles * 3);
+	for (size_t t = 0; t < deleted.size(); ++t) {
+		if (!deleted[t]) {
+			result.insert(result.end(), &triangles[3 * t], &triangles[3 * t] + 3);
+		}
+	}
+	if (resultError) {
+		*resultError = float(std::sqrt(largestCost));
+	}
+	return result;
+}
+
+
+std::vector<MeshCluster> MeshOptimizer::BuildClusters(const std::vector<unsigned>& indices, const std::vector<Vec3>& positions,
+													   unsigned maxVertices, unsigned maxTriangles)
+{
+	assert(maxVertices >= 3 && maxTriangles >= 1);
+	const size_t numTriangles = indices.size() / 3;
+
+	std::vector<MeshCluster> clusters;
+	std::vector<unsigned> clusterOfVertex(positions.size(), ~0u); // a vertex is counted once per cluster
+	std::vector<unsigned> clusterVertices;
+
+	auto FinishCluster = [&](size_t firstTriangle, size_t lastTriangle) {
+		MeshCluster cluster;
+		cluster.firstIndex = unsigned(firstTriangle * 3);
+		cluster.numIndices = unsigned((lastTriangle - firstTriangle) * 3);
+
+		// Sphere around the bounding box of the vertices.
+		Vec3 minimum = positions[clusterVertices[0]];
+		Vec3 maximum = minimum;
+		for (unsigned v : clusterVertices) {
+			minimum = Vec3::Min(minimum, positions[v]);
+			maximum = Vec3::Max(maximum, positions[v]);
+		}
+		cluster.center = (minimum + maximum) * 0.5f;
+		cluster.radius = 0.0f;
+		for (unsigned v : clusterVertices) {
+			cluster.radius = std::max(cluster.radius, (positions[v] - cluster.center).Length());
+		}
+
+		// Cone around the normals, degenerate triangles don't face anywhere.
+		std::vector<Vec3> normals;
+		Vec3 axis = { 0, 0, 0 };
+		for (size_t t = firstTriangle; t < lastTriangle; ++t) {
+			const Vec3& p0 = positions[indices[3 * t + 0]];
+			const Vec3& p1 = positions[indices[3 * t + 1]];
+			const Vec3& p2 = positions[indices[3 * t + 2]];
+			Vec3 normal = Cross(p1 - p0, p2 - p0);
+			float length = normal.Length();
+			if (length > 0.0f) {
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+		float axisLength = axis.Length();
+		cluster.coneAxis = axisLength > 0.0f ? axis / axisLength : Vec3{ 0, 0, 0 };
+		float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+		for (const Vec3& normal : normals) {
+			minDot = std::min(minDot, Dot(normal, cluster.coneAxis));
+		}
+		cluster.coneCutoff = minDot > 0.0f ? std::sqrt(std::max(1.0f - minDot * minDot, 0.0f)) : 1.0f;
+
+		clusters.push_back(cluster);
+		clusterVertices.clear();
+	};
+
+	size_t firstTriangle = 0;
+	for (size_t t = 0; t < numTriangles; ++t) {
+		const unsigned clusterIndex = unsigned(clusters.size());
+		unsigned newVertices = 0;
+		for (int j = 0; j < 3; ++j) {
+			newVertices += clusterOfVertex[indices[3 * t + j]] != clusterIndex;
+		}
+		// Close the cluster if the triangle doesn't fit. Duplicate indices in a triangle overcount, which is harmless.
+		if (t > firstTriangle && (clusterVertices.size() + newVertices > maxVertices || t - firstTriangle >= maxTriangles)) {
+			FinishCluster(firstTriangle, t);
+			firstTriangle = t;
+		}
+		for (int j = 0; j < 3; ++j) {
+			unsigned v = indices[3 * t + j];
+			if (clusterOfVertex[v] != unsigned(clusters.size())) {
+				clusterOfVertex[v] = unsigned(clusters.size());
+				clusterVertices.push_back(v);
+			}
+		}
+	}
+	if (firstTriangle < numTriangles) {
+		FinishCluster(firstTriangle, numTriangles);
+	}
+
+	return clusters;
+}
+
+
+float MeshOptimizer::CalculateACMR(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize) {
+	size_t numTriangles = indices.size() / 3;
+	return numTriangles > 0 ? float(CountCacheMisses(indices, numVertices, cacheSize)) / float(numTriangles) : 0.0f;
+}
+
+
+float MeshOptimizer::CalculateATVR(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize) {
+	return numVertices > 0 ? float(CountCacheMisses(indices, numVertices, cacheSize)) / float(numVertices) : 0.0f;
+}
+
+
+size_t MeshOptimizer::CountCacheMisses(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize) {
+	FifoCache cache(numVertices, cacheSize);
+	size_t misses = 0;
+	for (unsigned index : indices) {
+		misses += cache.Access(index);
+	}
+	return misses;
+}
+
+
+} // namespace inl::gxeng
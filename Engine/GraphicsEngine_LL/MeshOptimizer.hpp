@@ -0,0 +1,85 @@
+#pragma once
+
+#include <InlineMath.hpp>
+#include <vector>
+#include <cstddef>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Selects how <see cref="Mesh::Set"/> reorders the triangles and vertices before uploading them. </summary>
+struct MeshOptimization {
+	bool vertexCache = false; /// <summary> Reorders the triangles so that the post-transform cache hits more often. </summary>
+	bool overdraw = false; /// <summary> Then draws clusters of outward facing triangles first. Needs positions and vertexCache. </summary>
+	bool vertexFetch = false; /// <summary> Reorders the vertices in the order the triangles first use them. </summary>
+	float overdrawThreshold = 1.05f; /// <summary> How much worse the ACMR of a cluster may get for smaller clusters, thus less overdraw. </summary>
+	unsigned cacheSize = 16; /// <summary> Entries of the simulated FIFO post-transform cache. </summary>
+
+	unsigned numLods = 1; /// <summary> Levels of detail to generate, including the full mesh. Needs positions. </summary>
+	float lodReduction = 0.5f; /// <summary> Triangles of a level relative to the previous one. </summary>
+	float lodMaxError = 0.05f; /// <summary> Relative to the bounding box diagonal, levels are not simplified further. </summary>
+
+	bool clusters = false; /// <summary> Splits the full mesh into clusters that are culled one by one. Needs positions. </summary>
+	unsigned clusterMaxVertices = 64;
+	unsigned clusterMaxTriangles = 124;
+};
+
+
+/// <summary> Consecutive triangles of a mesh, with the data to cull them together. </summary>
+struct MeshCluster {
+	unsigned firstIndex;
+	unsigned numIndices;
+	Vec3 center; /// <summary> Bounding sphere of the vertices, in model space. </summary>
+	float radius;
+	Vec3 coneAxis; /// <summary> Average direction of the triangles' normals, the cross product of their first two edges. </summary>
+	float coneCutoff; /// <summary> Sine of the largest angle between the axis and a normal, 1 or more if the normals are too spread to cull. </summary>
+};
+
+
+/// <summary> Post-transform cache efficiency of the triangle order, as simulated by a FIFO cache. </summary>
+struct MeshOptimizationReport {
+	float acmrBefore = 0.0f; /// <summary> Average cache miss ratio: vertex shader runs per triangle, 0.5 at best, 3 at worst. </summary>
+	float acmrAfter = 0.0f;
+	float atvrBefore = 0.0f; /// <summary> Average transform to vertex ratio: vertex shader runs per vertex, 1 at best. </summary>
+	float atvrAfter = 0.0f;
+	bool index16Bit = false; /// <summary> The index buffer fits 16 bit indices. </summary>
+};
+
+
+/// <summary> CPU side reordering of indexed triangle lists, to reduce the vertex shading and overdraw of drawing them. </summary>
+class MeshOptimizer {
+public:
+	/// <summary> Reorders the triangles for the post-transform vertex cache, using Tipsify (Sander et al. 2007). </summary>
+	static void OptimizeVertexCache(std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize);
+
+	/// <summary> Splits the triangles into clusters and orders them so that ones on the outside of the mesh, facing
+	///		outward, come first. Expects the triangles already optimized for the vertex cache. </summary>
+	/// <param name="threshold"> Clusters end once their ACMR is within this factor of the unsplit ACMR. </param>
+	static void OptimizeOverdraw(std::vector<unsigned>& indices, const std::vector<Vec3>& positions, unsigned cacheSize, float threshold);
+
+	/// <summary> Renumbers the vertices in the order the triangles first use them, unused vertices go last. </summary>
+	/// <returns> The new index of each old vertex. </returns>
+	static std::vector<unsigned> OptimizeVertexFetch(std::vector<unsigned>& indices, size_t numVertices);
+
+	/// <summary> Collapses edges in the order of the least quadric error (Garland and Heckbert 1997) until the
+	///		triangles fit in <paramref name="targetIndexCount"/>, or the error would exceed <paramref name="maxError"/>. </summary>
+	/// <remarks> Vertices are kept in place, only the indices change. Vertices on open borders and on attribute seams,
+	///		where vertices of the same position differ, are not moved. </remarks>
+	/// <param name="resultError"> The largest distance from the original surface, approximately. </param>
+	static std::vector<unsigned> Simplify(const std::vector<unsigned>& indices, const std::vector<Vec3>& positions,
+										  size_t targetIndexCount, float maxError, float* resultError = nullptr);
+
+	/// <summary> Splits the triangles, in their current order, into clusters of at most so many vertices and triangles. </summary>
+	/// <remarks> Ordering the triangles for the vertex cache first makes the clusters compact. </remarks>
+	static std::vector<MeshCluster> BuildClusters(const std::vector<unsigned>& indices, const std::vector<Vec3>& positions,
+												  unsigned maxVertices, unsigned maxTriangles);
+
+	static float CalculateACMR(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize);
+	static float CalculateATVR(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize);
+private:
+	static size_t CountCacheMisses(const std::vector<unsigned>& indices, size_t numVertices, unsigned cacheSize);
+};
+
+
+} // namespace inl::gxeng
@@ -39,11 +39,15 @@ SetupContext::SetupContext(MemoryManager* memoryManager,
 						   RTVHeap* rtvHeap,
 						   DSVHeap* dsvHeap,
 						   ShaderManager* shaderManager,
-						   gxapi::IGraphicsApi* graphicsApi)
+						   gxapi::IGraphicsApi* graphicsApi,
+						   TransientResourcePool* transientPool,
+						   unsigned taskIndex)
 	: m_memoryManager(memoryManager),
 	m_srvHeap(srvHeap),
 	m_rtvHeap(rtvHeap),
 	m_dsvHeap(dsvHeap),
+	m_transientPool(transientPool),
+	m_taskIndex(taskIndex),
 	m_shaderManager(shaderManager),
 	m_graphicsApi(graphicsApi)
 {}
@@ -73,15 +77,32 @@ Texture3D SetupContext::CreateTexture3D(const Texture3DDesc& desc, const Texture
 	return texture;
 }
 
+Texture2D SetupContext::CreateTransientTexture2D(const Texture2DDesc& desc, const TextureUsage& usage) const {
+	if (m_transientPool == nullptr) {
+		return CreateTexture2D(desc, usage);
+	}
+
+	gxapi::eResourceFlags flags;
+
+	if (!usage.shaderResource) flags += gxapi::eResourceFlags::DENY_SHADER_RESOURCE;
+	if (usage.renderTarget) flags += gxapi::eResourceFlags::ALLOW_RENDER_TARGET;
+	if (usage.depthStencil) flags += gxapi::eResourceFlags::ALLOW_DEPTH_STENCIL;
+	if (usage.randomAccess) flags += gxapi::eResourceFlags::ALLOW_UNORDERED_ACCESS;
+
+	return m_transientPool->CreateTexture2D(desc, flags, m_taskIndex);
+}
+
 
 TextureView2D SetupContext::CreateSrv(Texture2D& texture, gxapi::eFormat format, gxapi::SrvTexture2DArray desc) const {
 	if (m_srvHeap == nullptr) throw InvalidStateException("Cannot create srv without srv/cbv/uav heap.");
+	if (m_transientPool != nullptr) m_transientPool->Use(texture, m_taskIndex);
 
 	return TextureView2D{ texture, *m_srvHeap, format, desc };
 }
 
 TextureViewCube SetupContext::CreateSrv(Texture2D & texture, gxapi::eFormat format, gxapi::SrvTextureCubeArray desc) const {
 	if (m_srvHeap == nullptr) throw InvalidStateException("Cannot create srv without srv/cbv/uav heap.");
+	if (m_transientPool != nullptr) m_transientPool->Use(texture, m_taskIndex);
 
 	return TextureViewCube{ texture, *m_srvHeap, format, desc };
 }
@@ -94,6 +115,7 @@ TextureView3D SetupContext::CreateSrv(Texture3D & texture, gxapi::eFormat format
 
 RenderTargetView2D SetupContext::CreateRtv(Texture2D& texture, gxapi::eFormat format, gxapi::RtvTexture2DArray desc) const {
 	if (m_rtvHeap == nullptr) throw InvalidStateException("Cannot create rtv without rtv heap.");
+	if (m_transientPool != nullptr) m_transientPool->Use(texture, m_taskIndex);
 
 	return RenderTargetView2D{ texture, *m_rtvHeap, format, desc };
 }
@@ -101,6 +123,7 @@ RenderTargetView2D SetupContext::CreateRtv(Texture2D& texture, gxapi::eFormat fo
 
 DepthStencilView2D SetupContext::CreateDsv(Texture2D& texture, gxapi::eFormat format, gxapi::DsvTexture2DArray desc) const {
 	if (m_dsvHeap == nullptr) throw InvalidStateException("Cannot create dsv without dsv heap.");
+	if (m_transientPool != nullptr) m_transientPool->Use(texture, m_taskIndex);
 
 	return DepthStencilView2D{ texture, *m_dsvHeap, format, desc };
 }
@@ -108,6 +131,7 @@ DepthStencilView2D SetupContext::CreateDsv(Texture2D& texture, gxapi::eFormat fo
 
 RWTextureView2D SetupContext::CreateUav(Texture2D& rwTexture, gxapi::eFormat format, gxapi::UavTexture2DArray desc) const {
 	if (m_srvHeap == nullptr) throw InvalidStateException("Cannot create uav wihtout srv/cbv/uav heap.");
+	if (m_transientPool != nullptr) m_transientPool->Use(rwTexture, m_taskIndex);
 
 	return RWTextureView2D{ rwTexture, *m_srvHeap, format, desc };
 }
@@ -6,6 +6,7 @@
 #include "ResourceView.hpp"
 #include "ShaderManager.hpp"
 #include "VolatileViewHeap.hpp"
+#include "TransientResourcePool.hpp"
 #include "Binder.hpp"
 #include <cstdint>
 
@@ -80,7 +81,9 @@ public:
 				 RTVHeap* rtvHeap = nullptr,
 				 DSVHeap* dsvHeap = nullptr,
 				 ShaderManager* shaderManager = nullptr,
-				 gxapi::IGraphicsApi* graphicsApi = nullptr);
+				 gxapi::IGraphicsApi* graphicsApi = nullptr,
+				 TransientResourcePool* transientPool = nullptr,
+				 unsigned taskIndex = 0);
 	SetupContext(SetupContext&&) = delete;
 	SetupContext& operator=(SetupContext&&) = delete;
 	SetupContext(const SetupContext&) = delete;
@@ -93,6 +96,11 @@ public:
 	VertexBuffer CreateVertexBuffer(const void* data, size_t size) const;
 	IndexBuffer CreateIndexBuffer(const void* data, size_t size, size_t indexCount) const;
 
+	/// <summary> Creates a texture that is only needed within the frame, and may share memory with other such textures. </summary>
+	/// <remarks> Request it in every Setup, and clear it before use, its content is undefined.
+	///		It stays alive until the last task creating a view of it in Setup. </remarks>
+	Texture2D CreateTransientTexture2D(const Texture2DDesc& desc, const TextureUsage& usage) const;
+
 	// Create views
 	TextureView2D CreateSrv(Texture2D& texture, gxapi::eFormat format, gxapi::SrvTexture2DArray desc = {}) const;
 	TextureViewCube CreateSrv(Texture2D& texture, gxapi::eFormat format, gxapi::SrvTextureCubeArray desc) const;
@@ -119,6 +127,8 @@ private:
 	CbvSrvUavHeap* m_srvHeap;
 	RTVHeap* m_rtvHeap;
 	DSVHeap* m_dsvHeap;
+	TransientResourcePool* m_transientPool;
+	unsigned m_taskIndex;
 
 	// Shaders and PSOs
 	ShaderManager* m_shaderManager;
@@ -2,6 +2,11 @@
 
 #include "NodeUtility.hpp"
 
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cassert>
+
 
 namespace inl::gxeng::nodes {
 
@@ -115,6 +120,77 @@ gxapi::eFormat FormatDepthToColor(gxapi::eFormat sourceFormat) {
 }
 
 
-} // namespace inl::gxeng::nodes
+
+static const char* GetSemanticName(eVertexElementSemantic semantic) {
+	switch (semantic) {
+		case eVertexElementSemantic::POSITION:
+		case eVertexElementSemantic::POSITION2D:
+		case eVertexElementSemantic::POSITION4D:
+			return "POSITION";
+		case eVertexElementSemantic::NORMAL:
+			return "NORMAL";
+		case eVertexElementSemantic::TEX_COORD:
+			return "TEX_COORD";
+		case eVertexElementSemantic::COLOR:
+			return "COLOR";
+		case eVertexElementSemantic::TANGENT:
+			return "TANGENT";
+		case eVertexElementSemantic::BITANGENT:
+			return "BITANGENT";
+	}
+	assert(false);
+	return "";
+}
+
+
+std::vector<gxapi::InputElementDesc> GetInputLayout(const Mesh::Layout& layout, const std::vector<eVertexElementSemantic>& semantics) {
+	if (layout.GetStreamCount() == 0) {
+		throw InvalidArgumentException("Meshes must have a single interleaved buffer.");
+	}
+
+	std::vector<gxapi::InputElementDesc> inputElements;
+	for (auto semantic : semantics) {
+		auto& elements = layout[0];
+		auto it = std::find_if(elements.begin(), elements.end(), [semantic](const Mesh::Element& element) {
+			return element.semantic == semantic && element.index == 0;
+		});
+		if (it == elements.end() || it->offset < 0) {
+			throw InvalidArgumentException("Mesh lacks a vertex element required by the shader.");
+		}
+		inputElements.push_back(gxapi::InputElementDesc(GetSemanticName(semantic), 0, it->format, 0, (unsigned)it->offset));
+	}
+
+	return inputElements;
+}
 
 
+void MeshPipelineStates::Reset(const gxapi::GraphicsPipelineStateDesc& desc, std::vector<eVertexElementSemantic> semantics) {
+	assert(!semantics.empty());
+	m_desc = desc;
+	m_desc.inputLayout.elements = nullptr;
+	m_desc.inputLayout.numElements = 0;
+	m_semantics = std::move(semantics);
+	m_pipelineStates.clear();
+}
+
+
+gxapi::IPipelineState* MeshPipelineStates::Get(RenderContext& context, const Mesh::Layout& layout) {
+	assert(IsValid());
+
+	auto it = m_pipelineStates.find(layout);
+	if (it == m_pipelineStates.end()) {
+		std::vector<gxapi::InputElementDesc> inputElements = GetInputLayout(layout, m_semantics);
+
+		gxapi::GraphicsPipelineStateDesc desc = m_desc;
+		desc.inputLayout.elements = inputElements.data();
+		desc.inputLayout.numElements = (unsigned)inputElements.size();
+
+		std::unique_ptr<gxapi::IPipelineState> pipelineState(context.CreatePSO(desc));
+		it = m_pipelineStates.insert({ layout, std::move(pipelineState) }).first;
+	}
+
+	return it->second.get();
+}
+
+
+} // namespace inl::gxeng::nodes
@@ -1,6 +1,14 @@
 #pragma once
 
+#include "../Mesh.hpp"
+#include "../NodeContext.hpp"
+
 #include <GraphicsApi_LL/Common.hpp>
+#include <GraphicsApi_LL/IPipelineState.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 
 namespace inl::gxeng::nodes {
@@ -22,6 +30,42 @@ gxapi::eFormat FormatAnyToDepthStencil(gxapi::eFormat sourceFormat);
 /// </summary>
 gxapi::eFormat FormatDepthToColor(gxapi::eFormat sourceFormat);
 
+/// <summary>
+/// Describes the given elements of the mesh's first stream for a pipeline state's input layout.
+/// <para/>
+/// The formats are the ones the elements are stored in, the input assembler converts them to float.
+/// Compressed positions and normals still have to be decoded by the shader, see VertexDecode.hlsl.
+/// Throws if the layout lacks one of the elements.
+/// </summary>
+std::vector<gxapi::InputElementDesc> GetInputLayout(const Mesh::Layout& layout, const std::vector<eVertexElementSemantic>& semantics);
+
+
+/// <summary>
+/// The pipeline states of a node that draws meshes, one for each vertex layout.
+/// <para/>
+/// All of them are created from the same description, only the input layout differs.
+/// The shaders and the root signature of the description must outlive the pipeline states.
+/// </summary>
+class MeshPipelineStates {
+public:
+	/// <summary> Drops the pipeline states created so far, the next ones are created from the new description. </summary>
+	void Reset(const gxapi::GraphicsPipelineStateDesc& desc, std::vector<eVertexElementSemantic> semantics);
+	/// <summary> True if <see cref="Reset"/> was called. </summary>
+	bool IsValid() const { return !m_semantics.empty(); }
+
+	/// <summary> Returns the pipeline state for the layout, it is created on first use. </summary>
+	gxapi::IPipelineState* Get(RenderContext& context, const Mesh::Layout& layout);
+
+private:
+	struct LayoutHash {
+		size_t operator()(const Mesh::Layout& obj) const { return obj.GetLayoutHash(); }
+		bool operator()(const Mesh::Layout& lhs, const Mesh::Layout& rhs) const { return lhs.EqualLayout(rhs); }
+	};
+	gxapi::GraphicsPipelineStateDesc m_desc;
+	std::vector<eVertexElementSemantic> m_semantics;
+	std::unordered_map<Mesh::Layout, std::unique_ptr<gxapi::IPipelineState>, LayoutHash, LayoutHash> m_pipelineStates;
+};
+
 } // namespace inl::gxeng::nodes
 
 
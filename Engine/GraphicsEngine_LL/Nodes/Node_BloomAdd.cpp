@@ -119,9 +119,10 @@ void BloomAdd::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Bloom add full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -171,6 +172,7 @@ void BloomAdd::Execute(RenderContext& context) {
 	*/
 
 	commandList.SetResourceState(m_output_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_output_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_input0TexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 	commandList.SetResourceState(m_input1TexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
@@ -211,38 +213,33 @@ void BloomAdd::Execute(RenderContext& context) {
 
 
 void BloomAdd::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatAdd = eFormat::R16G16B16A16_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_input1TexSrv.GetResource().GetWidth(),
-			m_input1TexSrv.GetResource().GetHeight(),
-			formatAdd
-		};
+	using gxapi::eFormat;
 
-		Texture2D output_tex = context.CreateTexture2D(desc, {1, 1, 0, 0});
-		output_tex.SetName("Bloom add tex");
-		m_output_rtv = context.CreateRtv(output_tex, formatAdd, rtvDesc);
-		
-	}
+	auto formatAdd = eFormat::R16G16B16A16_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
+
+	Texture2DDesc desc{
+		m_input1TexSrv.GetResource().GetWidth(),
+		m_input1TexSrv.GetResource().GetHeight(),
+		formatAdd
+	};
+
+	Texture2D output_tex = context.CreateTransientTexture2D(desc, {1, 1, 0, 0});
+	output_tex.SetName("Bloom add tex");
+	m_output_rtv = context.CreateRtv(output_tex, formatAdd, rtvDesc);
 }
 
 
@@ -104,9 +104,10 @@ void BloomDownsample::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Bloom downsample full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -156,6 +157,7 @@ void BloomDownsample::Execute(RenderContext& context) {
 	*/
 
 	commandList.SetResourceState(m_downsample_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_downsample_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
 	RenderTargetView2D* pRTV = &m_downsample_rtv;
@@ -194,38 +196,33 @@ void BloomDownsample::Execute(RenderContext& context) {
 
 
 void BloomDownsample::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatDownsample = eFormat::R16G16B16A16_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth() / 2,
-			m_inputTexSrv.GetResource().GetHeight() / 2,
-			formatDownsample
-		};
+	using gxapi::eFormat;
 
-		Texture2D downsample_tex = context.CreateTexture2D(desc, {1, 1, 0, 0});
-		downsample_tex.SetName("Bloom Downsample tex");
-		m_downsample_rtv = context.CreateRtv(downsample_tex, formatDownsample, rtvDesc);
-		
-	}
+	auto formatDownsample = eFormat::R16G16B16A16_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
+
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth() / 2,
+		m_inputTexSrv.GetResource().GetHeight() / 2,
+		formatDownsample
+	};
+
+	Texture2D downsample_tex = context.CreateTransientTexture2D(desc, {1, 1, 0, 0});
+	downsample_tex.SetName("Bloom Downsample tex");
+	m_downsample_rtv = context.CreateRtv(downsample_tex, formatDownsample, rtvDesc);
 }
 
 
@@ -9,13 +9,22 @@
 #include "../GraphicsCommandList.hpp"
 
 #include <array>
+#include <cstddef>
+#include <algorithm>
 
 namespace inl::gxeng::nodes {
 
+/// <summary> Casters sharing a mesh are drawn with a single instanced call,
+///		their model matrices are indexed by the instance ID in the shader. </summary>
+static constexpr unsigned MAX_INSTANCES_PER_DRAW = 256;
+
 struct Uniforms
 {
-	Mat44_Packed model;
 	uint32_t cascadeIDX;
+	Vec3_Packed positionOffset; // shares the register of the index
+	Vec3_Packed positionScale;
+	float padding; // the array starts on a new register
+	Mat44_Packed models[MAX_INSTANCES_PER_DRAW];
 };
 
 static bool CheckMeshFormat(const Mesh& mesh) {
@@ -85,6 +94,15 @@ void CSM::Setup(SetupContext & context) {
 	m_entities = this->GetInput<1>().Get();
 	this->GetInput<1>().Clear();
 
+	m_camera = this->GetInput<3>().IsSet() ? this->GetInput<3>().Get() : nullptr;
+	this->GetInput<3>().Clear();
+
+	m_directionalLights = this->GetInput<4>().IsSet() ? this->GetInput<4>().Get() : nullptr;
+	this->GetInput<4>().Clear();
+
+	m_cameraViewportHeight = this->GetInput<5>().IsSet() ? (float)this->GetInput<5>().Get().GetHeight() : 0.0f;
+	this->GetInput<5>().Clear();
+
 	Texture2D& lightMVPTex = this->GetInput<2>().Get();
 	gxapi::SrvTexture2DArray srvDesc;
 	srvDesc.activeArraySize = 1;
@@ -104,7 +122,7 @@ void CSM::Setup(SetupContext & context) {
 
 		BindParameterDesc uniformsBindParamDesc;
 		m_uniformsBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
-		uniformsBindParamDesc.parameter = m_uniformsBindParam;
+		uniformsBindParamDesc.parameter = m_uniformsBindParam.parameter;
 		uniformsBindParamDesc.constantSize = sizeof(Uniforms);
 		uniformsBindParamDesc.relativeAccessFrequency = 0;
 		uniformsBindParamDesc.relativeChangeFrequency = 0;
@@ -136,9 +154,10 @@ void CSM::Setup(SetupContext & context) {
 		samplerDesc.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
 
 		m_binder = context.CreateBinder({ uniformsBindParamDesc, lightMVPBindParamDesc, sampBindParamDesc },{ samplerDesc });
+		m_uniformsBindParam = m_binder->GetHandle(m_uniformsBindParam.parameter);
 	}
 
-	if (!m_PSO || currDepthStencil != m_depthStencilFormat) {
+	if (!m_PSOs.IsValid() || currDepthStencil != m_depthStencilFormat) {
 		m_depthStencilFormat = currDepthStencil;
 
 		//TODO
@@ -151,15 +170,7 @@ void CSM::Setup(SetupContext & context) {
 
 		m_shader = context.CreateShader("CSM", shaderParts, "");
 
-		std::vector<gxapi::InputElementDesc> inputElementDesc = {
-			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-			gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-			gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
-		};
-
 		gxapi::GraphicsPipelineStateDesc psoDesc;
-		psoDesc.inputLayout.elements = inputElementDesc.data();
-		psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
 		psoDesc.rootSignature = m_binder->GetRootSignature();
 		psoDesc.vs = m_shader.vs;
 		psoDesc.ps = m_shader.ps;
@@ -171,7 +182,7 @@ void CSM::Setup(SetupContext & context) {
 
 		psoDesc.numRenderTargets = 0;
 
-		m_PSO.reset(context.CreatePSO(psoDesc));
+		m_PSOs.Reset(psoDesc, { eVertexElementSemantic::POSITION });
 	}
 }
 
@@ -189,7 +200,6 @@ void CSM::Execute(RenderContext & context) {
 	gxapi::Rectangle rect{ 0, (int)cascadeTextures.GetHeight(), 0, (int)cascadeTextures.GetWidth() };
 	commandList.SetScissorRects(1, &rect);
 
-	commandList.SetPipelineState(m_PSO.get());
 	commandList.SetGraphicsBinder(&m_binder.value());
 	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
 
@@ -200,6 +210,11 @@ void CSM::Execute(RenderContext & context) {
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
 
+	// The same casters are drawn into all cascades.
+	UpdateCasters();
+
+	Uniforms uniformsCBData;
+
 	commandList.SetResourceState(cascadeTextures, gxapi::eResourceState::DEPTH_WRITE, gxapi::ALL_SUBRESOURCES);
 	for (int cascadeIdx = 0; cascadeIdx < numCascades; ++cascadeIdx) {
 		commandList.SetRenderTargets(0, nullptr, &m_dsvs[cascadeIdx]);
@@ -214,44 +229,110 @@ void CSM::Execute(RenderContext & context) {
 		viewport.topLeftX = 0;
 		commandList.SetViewports(1, &viewport);
 
-		// Iterate over all entities
-		for (const MeshEntity* entity : *m_entities) {
+		// Iterate over casters, they are sorted by mesh so that runs of the same mesh are instanced
+		const Mesh* currentMesh = nullptr;
+		for (size_t first = 0; first < m_casters.size();) {
 			// Get entity parameters
-			Mesh* mesh = entity->GetMesh();
-			auto position = entity->GetPosition();
+			Mesh* mesh = m_casters[first].mesh;
 
-			if (mesh->GetIndexBuffer().GetIndexCount() == 3600)
-			{
-				continue; //skip quadcopter for visualization purposes (obscures camera...)
+			size_t last = first + 1;
+			while (last < m_casters.size() && last - first < MAX_INSTANCES_PER_DRAW && m_casters[last].mesh == mesh && m_casters[last].lod == m_casters[first].lod) {
+				++last;
 			}
+			const unsigned numInstances = unsigned(last - first);
 
-			// Draw mesh
-			if (!CheckMeshFormat(*mesh)) {
-				assert(false);
-				continue;
+			uniformsCBData.cascadeIDX = cascadeIdx;
+			uniformsCBData.positionOffset = mesh->GetPositionOffset();
+			uniformsCBData.positionScale = mesh->GetPositionScale();
+			for (unsigned instanceIdx = 0; instanceIdx < numInstances; ++instanceIdx) {
+				uniformsCBData.models[instanceIdx] = m_casters[first + instanceIdx].entity->GetTransform();
 			}
 
-			ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
+			commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, int(offsetof(Uniforms, models) + numInstances * sizeof(Mat44_Packed)));
 
-			Mat44 model = entity->GetTransform();
+			// Draw mesh
+			if (mesh != currentMesh) {
+				currentMesh = mesh;
+				commandList.SetPipelineState(m_PSOs.Get(context, mesh->GetLayout()));
+				ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
+
+				for (auto& vb : vertexBuffers) {
+					commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+				}
+				commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+
+				commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
+				commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
+			}
+			const Mesh::Lod& lod = mesh->GetLod(m_casters[first].lod);
+			commandList.DrawIndexedInstanced(lod.numIndices, lod.firstIndex, 0, numInstances);
 
-			Uniforms uniformsCBData;
-			uniformsCBData.model = model;
+			first = last;
+		}
+	}
+}
 
-			uniformsCBData.cascadeIDX = cascadeIdx;
 
-			commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
+void CSM::UpdateCasters() {
+	m_drawListBuilder.SetEntities(*m_entities);
 
-			for (auto& vb : vertexBuffers) {
-				commandList.SetResourceState(*vb, gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
-			}
-			commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+	bool canCull = m_camera != nullptr && m_directionalLights != nullptr && !m_directionalLights->IsEmpty();
+	if (!canCull) {
+		// Draw everything.
+		m_castersCulled = false;
+		m_casters.clear();
+		for (size_t i = 0; i < m_drawListBuilder.GetNumEntities(); ++i) {
+			const MeshEntity* entity = m_drawListBuilder.GetEntity(i);
+			m_casters.push_back(DrawItem{ entity, entity->GetMesh(), entity->GetMaterial(), nullptr });
+		}
+	}
+	else {
+		Mat44 viewProjection = m_camera->GetViewMatrix() * m_camera->GetProjectionMatrix();
+		Vec3 lightDirection = (*m_directionalLights->begin())->GetDirection();
+
+		// Nothing moved, last frame's casters are still valid.
+		if (m_castersCulled
+			&& !m_drawListBuilder.HasChanged()
+			&& m_castersViewProjection == viewProjection
+			&& m_castersLightDirection == lightDirection
+			&& m_castersViewportHeight == m_cameraViewportHeight)
+		{
+			return;
+		}
 
-			commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
-			commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-			commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		// Levels are picked as seen by the camera, the same as the surfaces receiving the shadows.
+		const LodSelector* lodSelector = nullptr;
+		if (m_cameraViewportHeight > 0.0f) {
+			m_lodSelector.Update(*m_entities, *m_camera, m_cameraViewportHeight);
+			lodSelector = &m_lodSelector;
 		}
+		m_drawListBuilder.Build(ViewFrustum(viewProjection).Extruded(lightDirection), m_casters, lodSelector);
+		m_castersCulled = true;
+		m_castersViewProjection = viewProjection;
+		m_castersLightDirection = lightDirection;
+		m_castersViewportHeight = m_cameraViewportHeight;
 	}
+
+	// Drop unsupported meshes and group the rest by mesh.
+	m_casters.erase(std::remove_if(m_casters.begin(), m_casters.end(), [](const DrawItem& caster) {
+		Mesh* mesh = caster.mesh;
+		if (mesh->GetLod(0).numIndices == 3600)
+		{
+			return true; //skip quadcopter for visualization purposes (obscures camera...)
+		}
+		if (!CheckMeshFormat(*mesh)) {
+			assert(false);
+			return true;
+		}
+		return false;
+	}), m_casters.end());
+
+	std::stable_sort(m_casters.begin(), m_casters.end(), [](const DrawItem& lhs, const DrawItem& rhs) {
+		if (lhs.mesh != rhs.mesh) {
+			return std::less<Mesh*>{}(lhs.mesh, rhs.mesh);
+		}
+		return lhs.lod < rhs.lod;
+	});
 }
 
 
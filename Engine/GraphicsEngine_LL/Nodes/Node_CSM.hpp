@@ -7,6 +7,9 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../DrawListBuilder.hpp"
+#include "../LodSelector.hpp"
+#include "NodeUtility.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -15,13 +18,23 @@
 namespace inl::gxeng::nodes {
 
 /// <summary>
-/// Inputs: render target, scene objects, light cascade MVP transform matrices in a texture
+/// Inputs: render target, scene objects, light cascade MVP transform matrices in a texture, camera, directional lights,
+///		depth buffer of the camera's view
 /// Output: render target
 /// </summary>
+/// <remarks>
+/// The camera and the lights are used to cull the shadow casters. The cascades themselves are calculated
+/// on the GPU, so casters are culled against the camera frustum extruded towards the light,
+/// which contains all cascades. All casters are drawn if the camera or the lights are not connected.
+/// <para/>
+/// Casters get the same levels of detail as the camera's view, so that shadows match the surfaces
+/// that receive them. Only the size of the depth buffer is used, for the camera's viewport height.
+/// Without it, the full meshes are drawn.
+/// </remarks>
 class CSM :
 	virtual public GraphicsNode,
 	virtual public GraphicsTask,
-	virtual public InputPortConfig<Texture2D, const EntityCollection<MeshEntity>*, Texture2D>,
+	virtual public InputPortConfig<Texture2D, const EntityCollection<MeshEntity>*, Texture2D, const BasicCamera*, const EntityCollection<DirectionalLight>*, Texture2D>,
 	virtual public OutputPortConfig<Texture2D>
 {
 public:
@@ -36,18 +49,33 @@ public:
 	void Setup(SetupContext& context) override;
 	void Execute(RenderContext& context) override;
 
+private:
+	void UpdateCasters();
+
 protected:
 	std::optional<Binder> m_binder;
-	BindParameter m_uniformsBindParam;
+	BindHandle m_uniformsBindParam; // bound for every draw
 	BindParameter m_lightMVPBindParam;
 	ShaderProgram m_shader;
-	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	MeshPipelineStates m_PSOs;
 	gxapi::eFormat m_depthStencilFormat;
 
 private: // render context
 	std::vector<DepthStencilView2D> m_dsvs;
 	const EntityCollection<MeshEntity>* m_entities;
+	const BasicCamera* m_camera;
+	const EntityCollection<DirectionalLight>* m_directionalLights;
+	float m_cameraViewportHeight; // zero if not known
 	TextureView2D m_lightMVPTexSrv;
+
+private: // caster culling, the caster list is reused while the scene, the camera and the light stand still
+	DrawListBuilder m_drawListBuilder;
+	LodSelector m_lodSelector;
+	std::vector<DrawItem> m_casters;
+	bool m_castersCulled = false;
+	Mat44 m_castersViewProjection;
+	Vec3 m_castersLightDirection;
+	float m_castersViewportHeight = 0.0f;
 };
 
 
@@ -172,9 +172,10 @@ void DOFMain::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("DOF full screen quad index buffer");
 	}
 
-	if (!m_main_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_main_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -300,6 +301,7 @@ void DOFMain::Execute(RenderContext& context) {
 
 	{ //main pass
 		commandList.SetResourceState(m_main_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+		commandList.ClearRenderTarget(m_main_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 
 		RenderTargetView2D* pRTV = &m_main_rtv;
 		commandList.SetRenderTargets(1, &pRTV, 0);
@@ -325,6 +327,7 @@ void DOFMain::Execute(RenderContext& context) {
 
 	{ //postfilter
 		commandList.SetResourceState(m_postfilter_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+		commandList.ClearRenderTarget(m_postfilter_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 		commandList.SetResourceState(m_main_srv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 		commandList.SetResourceState(m_originalTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
@@ -390,60 +393,53 @@ void DOFMain::Execute(RenderContext& context) {
 
 
 void DOFMain::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
+	using gxapi::eFormat;
+
+	auto format = eFormat::R16G16B16A16_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
 
-		using gxapi::eFormat;
+	Texture2DDesc desc;
 
-		auto format = eFormat::R16G16B16A16_FLOAT;
+	desc = {
+		m_inputTexSrv.GetResource().GetWidth(),
+		m_inputTexSrv.GetResource().GetHeight(),
+		format,
+	};
 
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
+	Texture2D main_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	main_tex.SetName("DOF main tex");
+	m_main_rtv = context.CreateRtv(main_tex, format, rtvDesc);
 
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
+	m_main_srv = context.CreateSrv(main_tex, format, srvDesc);
 
-		Texture2DDesc desc;
+	Texture2D postfilter_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	postfilter_tex.SetName("DOF postfilter tex");
+	m_postfilter_rtv = context.CreateRtv(postfilter_tex, format, rtvDesc);
 
-		desc = {
-			m_inputTexSrv.GetResource().GetWidth(),
-			m_inputTexSrv.GetResource().GetHeight(),
-			format,
-		};
+	m_postfilter_srv = context.CreateSrv(postfilter_tex, format, srvDesc);
 
-		Texture2D main_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		main_tex.SetName("DOF main tex");
-		m_main_rtv = context.CreateRtv(main_tex, format, rtvDesc);
-		
-		m_main_srv = context.CreateSrv(main_tex, format, srvDesc);
-		
-
-		Texture2D postfilter_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		postfilter_tex.SetName("DOF postfilter tex");
-		m_postfilter_rtv = context.CreateRtv(postfilter_tex, format, rtvDesc);
-		
-		m_postfilter_srv = context.CreateSrv(postfilter_tex, format, srvDesc);
-		
-
-		desc = {
-			m_originalTexSrv.GetResource().GetWidth(),
-			m_originalTexSrv.GetResource().GetHeight(), 
-			format
-		};
+	desc = {
+		m_originalTexSrv.GetResource().GetWidth(),
+		m_originalTexSrv.GetResource().GetHeight(), 
+		format
+	};
 
-		Texture2D upsample_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		upsample_tex.SetName("DOF upsample tex");
-		m_upsample_rtv = context.CreateRtv(upsample_tex, format, rtvDesc);
-		
-	}
+	Texture2D upsample_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	upsample_tex.SetName("DOF upsample tex");
+	m_upsample_rtv = context.CreateRtv(upsample_tex, format, rtvDesc);
 }
 
 
@@ -47,7 +47,6 @@ protected:
 	std::unique_ptr<gxapi::IPipelineState> m_upsample_PSO;
 
 protected: // outputs
-	bool m_outputTexturesInited = false;
 	RenderTargetView2D m_postfilter_rtv;
 	RenderTargetView2D m_main_rtv;
 	RenderTargetView2D m_upsample_rtv;
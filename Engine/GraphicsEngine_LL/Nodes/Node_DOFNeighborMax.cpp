@@ -104,9 +104,10 @@ void DOFNeighborMax::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("DOF neighbormax full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -156,6 +157,7 @@ void DOFNeighborMax::Execute(RenderContext& context) {
 	*/
 
 	commandList.SetResourceState(m_neighbormax_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_neighbormax_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
 	RenderTargetView2D* pRTV = &m_neighbormax_rtv;
@@ -194,38 +196,33 @@ void DOFNeighborMax::Execute(RenderContext& context) {
 
 
 void DOFNeighborMax::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatNeighborMax = eFormat::R16G16_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth(),
-			m_inputTexSrv.GetResource().GetHeight(),
-			formatNeighborMax
-		};
+	using gxapi::eFormat;
 
-		Texture2D neighbormax_tex = context.CreateTexture2D(desc, {true, true, false, false});
-		neighbormax_tex.SetName("DOF neighbormax tex");
-		m_neighbormax_rtv = context.CreateRtv(neighbormax_tex, formatNeighborMax, rtvDesc);
-		
-	}
+	auto formatNeighborMax = eFormat::R16G16_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
+
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth(),
+		m_inputTexSrv.GetResource().GetHeight(),
+		formatNeighborMax
+	};
+
+	Texture2D neighbormax_tex = context.CreateTransientTexture2D(desc, {true, true, false, false});
+	neighbormax_tex.SetName("DOF neighbormax tex");
+	m_neighbormax_rtv = context.CreateRtv(neighbormax_tex, formatNeighborMax, rtvDesc);
 }
 
 
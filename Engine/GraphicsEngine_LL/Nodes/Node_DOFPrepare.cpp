@@ -143,9 +143,10 @@ void DOFPrepare::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("DOF full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -199,7 +200,9 @@ void DOFPrepare::Execute(RenderContext& context) {
 	uniformsCBData.maxBlurDiameter = 33.0;
 
 	commandList.SetResourceState(m_prepare_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_prepare_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_depth_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_depth_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 	commandList.SetResourceState(m_depthTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
@@ -243,47 +246,41 @@ void DOFPrepare::Execute(RenderContext& context) {
 
 
 void DOFPrepare::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto format = eFormat::R16G16B16A16_FLOAT;
-		auto depthFormat = eFormat::R32_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth(), 
-			m_inputTexSrv.GetResource().GetHeight(),
-			format
-		};
+	using gxapi::eFormat;
 
-		//Texture2D prepare_tex = context.CreateTexture2D(m_inputTexSrv.GetResource().GetWidth()/2, m_inputTexSrv.GetResource().GetHeight()/2, format, {1, 1, 0, 0});
-		Texture2D prepare_tex = context.CreateTexture2D(desc, { true, true, false });
-		prepare_tex.SetName("DOF prepare tex");
-		m_prepare_rtv = context.CreateRtv(prepare_tex, format, rtvDesc);
-		
-
-		//Texture2D depth_tex = context.CreateTexture2D(m_inputTexSrv.GetResource().GetWidth() / 2, m_inputTexSrv.GetResource().GetHeight() / 2, depthFormat, { 1, 1, 0, 0 });
-		desc.format = depthFormat;
-		Texture2D depth_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		depth_tex.SetName("DOF depth tex");
-		m_depth_rtv = context.CreateRtv(depth_tex, depthFormat, rtvDesc);
-		
-	}
+	auto format = eFormat::R16G16B16A16_FLOAT;
+	auto depthFormat = eFormat::R32_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
+
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth(), 
+		m_inputTexSrv.GetResource().GetHeight(),
+		format
+	};
+
+	//Texture2D prepare_tex = context.CreateTexture2D(m_inputTexSrv.GetResource().GetWidth()/2, m_inputTexSrv.GetResource().GetHeight()/2, format, {1, 1, 0, 0});
+	Texture2D prepare_tex = context.CreateTransientTexture2D(desc, { true, true, false });
+	prepare_tex.SetName("DOF prepare tex");
+	m_prepare_rtv = context.CreateRtv(prepare_tex, format, rtvDesc);
+
+	//Texture2D depth_tex = context.CreateTexture2D(m_inputTexSrv.GetResource().GetWidth() / 2, m_inputTexSrv.GetResource().GetHeight() / 2, depthFormat, { 1, 1, 0, 0 });
+	desc.format = depthFormat;
+	Texture2D depth_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	depth_tex.SetName("DOF depth tex");
+	m_depth_rtv = context.CreateRtv(depth_tex, depthFormat, rtvDesc);
 }
 
 
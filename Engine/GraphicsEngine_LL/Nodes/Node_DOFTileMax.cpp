@@ -121,9 +121,10 @@ void DOFTileMax::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("DOF tilemax full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -175,6 +176,7 @@ void DOFTileMax::Execute(RenderContext& context) {
 	uniformsCBData.tileSize = 20.0;
 
 	commandList.SetResourceState(m_tilemax_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_tilemax_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 	commandList.SetResourceState(m_depthTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
@@ -215,40 +217,35 @@ void DOFTileMax::Execute(RenderContext& context) {
 
 
 void DOFTileMax::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
+	using gxapi::eFormat;
 
-		auto formatTileMax = eFormat::R16G16_FLOAT;
+	auto formatTileMax = eFormat::R16G16_FLOAT;
 
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
 
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
 
-		int tileSize = 20;
+	int tileSize = 20;
 
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth() / tileSize,
-			m_inputTexSrv.GetResource().GetHeight() / tileSize,
-			formatTileMax
-		};
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth() / tileSize,
+		m_inputTexSrv.GetResource().GetHeight() / tileSize,
+		formatTileMax
+	};
 
-		Texture2D tilemax_tex = context.CreateTexture2D(desc, {true, true, false, false});
-		tilemax_tex.SetName("DOF tilemax tex");
-		m_tilemax_rtv = context.CreateRtv(tilemax_tex, formatTileMax, rtvDesc);
-		
-	}
+	Texture2D tilemax_tex = context.CreateTransientTexture2D(desc, {true, true, false, false});
+	tilemax_tex.SetName("DOF tilemax tex");
+	m_tilemax_rtv = context.CreateRtv(tilemax_tex, formatTileMax, rtvDesc);
 }
 
 
@@ -7,11 +7,18 @@
 #include "../Image.hpp"
 #include "../DirectionalLight.hpp"
 #include "../GraphicsCommandList.hpp"
+#include "../DrawListBuilder.hpp"
 
 #include <array>
 
 namespace inl::gxeng::nodes {
 
+struct Transform
+{
+	Mat44_Packed MVP;
+	alignas(16) Vec3_Packed positionOffset;
+	alignas(16) Vec3_Packed positionScale;
+};
 
 static bool CheckMeshFormat(const Mesh& mesh) {
 	for (size_t i = 0; i < mesh.GetNumStreams(); i++) {
@@ -89,7 +96,7 @@ void DepthPrepass::Setup(SetupContext & context) {
 		BindParameterDesc transformBindParamDesc;
 		m_transformBindParam = BindParameter(eBindParameterType::CONSTANT, 0);
 		transformBindParamDesc.parameter = m_transformBindParam;
-		transformBindParamDesc.constantSize = sizeof(float) * 4 * 4;
+		transformBindParamDesc.constantSize = sizeof(Transform);
 		transformBindParamDesc.relativeAccessFrequency = 0;
 		transformBindParamDesc.relativeChangeFrequency = 0;
 		transformBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
@@ -122,18 +129,10 @@ void DepthPrepass::Setup(SetupContext & context) {
 		m_shader = context.CreateShader("DepthPrepass", shaderParts, "");
 	}
 
-	if (m_PSO == nullptr || m_depthStencilFormat != currDepthStencilFormat) {
+	if (!m_PSOs.IsValid() || m_depthStencilFormat != currDepthStencilFormat) {
 		m_depthStencilFormat = currDepthStencilFormat;
 
-		std::vector<gxapi::InputElementDesc> inputElementDesc = {
-			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-			gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-			gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
-		};
-
 		gxapi::GraphicsPipelineStateDesc psoDesc;
-		psoDesc.inputLayout.elements = inputElementDesc.data();
-		psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
 		psoDesc.rootSignature = m_binder->GetRootSignature();
 		psoDesc.vs = m_shader.vs;
 		psoDesc.ps = m_shader.ps;
@@ -145,7 +144,7 @@ void DepthPrepass::Setup(SetupContext & context) {
 
 		psoDesc.numRenderTargets = 0;
 
-		m_PSO.reset(context.CreatePSO(psoDesc));
+		m_PSOs.Reset(psoDesc, { eVertexElementSemantic::POSITION });
 	}
 }
 
@@ -173,7 +172,6 @@ void DepthPrepass::Execute(RenderContext & context) {
 	commandList.SetResourceState(m_targetDsv.GetResource(), gxapi::eResourceState::DEPTH_WRITE);
 	commandList.ClearDepthStencil(m_targetDsv, 1, 0, 0, nullptr, true, true);
 
-	commandList.SetPipelineState(m_PSO.get());
 	commandList.SetGraphicsBinder(&m_binder.value());
 	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
 
@@ -185,9 +183,16 @@ void DepthPrepass::Execute(RenderContext & context) {
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
+	std::vector<ClusterCuller::IndexRange> ranges;
+	ClusterCuller clusterCuller(viewProjection, m_camera->GetPosition());
+
+	m_lodSelector.Update(*m_entities, *m_camera, viewport.height);
 
 	// Iterate over all entities
+	size_t entityIndex = 0;
 	for (const MeshEntity* entity : *m_entities) {
+		const unsigned lodIndex = m_lodSelector.GetLod(entityIndex++, entity);
+
 		// Get entity parameters
 		Mesh* mesh = entity->GetMesh();
 		auto position = entity->GetPosition();
@@ -198,12 +203,15 @@ void DepthPrepass::Execute(RenderContext & context) {
 			continue;
 		}
 
+		commandList.SetPipelineState(m_PSOs.Get(context, mesh->GetLayout()));
 		ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
 
 		auto MVP = entity->GetTransform() * viewProjection;
 
-		Mat44_Packed transformCBData;
-		transformCBData = MVP;
+		Transform transformCBData;
+		transformCBData.MVP = MVP;
+		transformCBData.positionOffset = mesh->GetPositionOffset();
+		transformCBData.positionScale = mesh->GetPositionScale();
 
 		commandList.BindGraphics(m_transformBindParam, &transformCBData, sizeof(transformCBData));
 
@@ -214,7 +222,16 @@ void DepthPrepass::Execute(RenderContext & context) {
 
 		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		if (lodIndex == 0 && !mesh->GetClusters().empty()) {
+			clusterCuller.Cull(*entity, ranges);
+			for (const auto& range : ranges) {
+				commandList.DrawIndexedInstanced(range.numIndices, range.firstIndex);
+			}
+		}
+		else {
+			const Mesh::Lod& lod = mesh->GetLod(lodIndex);
+			commandList.DrawIndexedInstanced(lod.numIndices, lod.firstIndex);
+		}
 	}
 }
 
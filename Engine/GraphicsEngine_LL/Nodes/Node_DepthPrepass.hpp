@@ -7,6 +7,8 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../LodSelector.hpp"
+#include "NodeUtility.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -39,13 +41,14 @@ protected:
 	std::optional<Binder> m_binder;
 	BindParameter m_transformBindParam;
 	ShaderProgram m_shader;
-	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	MeshPipelineStates m_PSOs;
 	gxapi::eFormat m_depthStencilFormat = gxapi::eFormat::UNKNOWN;
 
 private: // execution context
 	DepthStencilView2D m_targetDsv;
 	const EntityCollection<MeshEntity>* m_entities;
 	const BasicCamera* m_camera;
+	LodSelector m_lodSelector; // must select the same as the forward render, it tests for equal depth
 };
 
 
@@ -335,135 +335,188 @@ void ForwardRender::Execute(RenderContext& context) {
 	Mat44 prevView = m_camera->GetPrevViewMatrix();
 	auto prevViewProjection = prevView * projection;
 
+	// Collect visible entities, sorted so that state only has to be changed when it differs.
+	m_drawListBuilder.SetEntities(*m_entities);
+	m_lodSelector.Update(*m_entities, *m_camera, viewport.height);
+	m_drawListBuilder.Build(ViewFrustum(viewProjection), m_drawList, &m_lodSelector);
+
+	// Frame-wide resources and constants, bound again whenever the binder changes.
+	commandList.SetResourceState(m_pointLightShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_cascadedShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_shadowMXTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_csmSplitsTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_lightMVPTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+	commandList.SetResourceState(m_lightCullDataView.GetResource(), {gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE	});
+
+	assert(m_directionalLights->Size() == 1);
+	const DirectionalLight* sun = *m_directionalLights->begin();
+
+	LightConstants lightConstants;
+	Vec4 vsLightDir = Vec4(sun->GetDirection(), 0.0f) * view;
+	lightConstants.direction = Vec3(vsLightDir.xyz).Normalized();
+	lightConstants.color = sun->GetColor();
+
+	Uniforms uniformsCBData;
+	uniformsCBData.screen_dimensions = Vec4((float)m_rtv.GetResource().GetWidth(), (float)m_rtv.GetResource().GetHeight(), 0.f, 0.f);
+	//uniformsCBData.ld[0].vs_position = Vec4(m_camera->GetPosition() + m_camera->GetLookDirection() * 5.f, 1.0f) * m_camera->GetViewMatrix();
+	uniformsCBData.ld[0].vs_position = Vec4(Vec3(0, 0, 1), 1.0f) * m_camera->GetViewMatrix();
+	uniformsCBData.ld[0].attenuation_end = Vec4(5.0f, 0.f, 0.f, 0.f);
+	uniformsCBData.ld[0].diffuse_color = Vec4(1.f, 0.f, 0.f, 1.f);
+	uniformsCBData.vs_cam_pos = Vec4(m_camera->GetPosition(), 1.0f) * m_camera->GetViewMatrix();
+	uniformsCBData.invV = m_camera->GetViewMatrix().Inverse();
+
+	uint32_t dispatchW, dispatchH;
+	SetWorkgroupSize((unsigned)m_rtv.GetResource().GetWidth(), (unsigned)m_rtv.GetResource().GetHeight(), 16, 16, dispatchW, dispatchH);
+
+	uniformsCBData.group_size_x = dispatchW;
+	uniformsCBData.group_size_y = dispatchH;
+
+	uniformsCBData.halfExposureFramerate = 0.5 * 0.75 * 150; //TODO add measured FPS (or target)
+	uniformsCBData.maxMotionBlurRadius = 20;
 
 	std::vector<const gxeng::VertexBuffer*> vertexBuffers;
 	std::vector<unsigned> sizes;
 	std::vector<unsigned> strides;
-
-	// Iterate over all entities
-	for (const MeshEntity* entity : *m_entities) {
+	std::vector<uint8_t> materialConstants;
+	std::vector<VsConstants> instanceConstants;
+	std::vector<ClusterCuller::IndexRange> ranges;
+	ClusterCuller clusterCuller(viewProjection, m_camera->GetPosition());
+
+	ScenarioData* scenario = nullptr;
+	const Mesh* currentMesh = nullptr;
+	const Material* currentMaterial = nullptr;
+	const MaterialShader* currentShader = nullptr;
+
+	// Iterate over visible entities, consecutive ones with the same mesh and material are instanced
+	for (size_t first = 0; first < m_drawList.size();) {
 		// Get entity parameters
-		Mesh* mesh = entity->GetMesh();
-		Material* material = entity->GetMaterial();
+		const DrawItem& item = m_drawList[first];
+		Mesh* mesh = item.mesh;
+		Material* material = item.material;
 
 		assert(mesh != nullptr);
 		assert(material != nullptr);
+		assert(item.shader != nullptr);
 
 		// Set pipeline state & binder
-		const Mesh::Layout& layout = mesh->GetLayout();
-		const MaterialShader* materialShader = material->GetShader();
-		assert(materialShader != nullptr);
-
-		ScenarioData& scenario = GetScenario(
-			context, layout, *materialShader, m_rtv.GetDescription().format, m_dsv.GetDescription().format);
-
-		commandList.SetPipelineState(scenario.pso.get());
-		commandList.SetGraphicsBinder(&scenario.binder);
+		bool scenarioChanged = scenario == nullptr
+			|| item.shader != currentShader
+			|| (mesh != currentMesh && !mesh->GetLayout().EqualLayout(currentMesh->GetLayout()));
+		if (scenarioChanged) {
+			scenario = &GetScenario(
+				context, mesh->GetLayout(), *item.shader, m_rtv.GetDescription().format, m_dsv.GetDescription().format);
+			currentShader = item.shader;
 
-		commandList.SetResourceState(m_pointLightShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_cascadedShadowMapTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_shadowMXTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_csmSplitsTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-		commandList.SetResourceState(m_lightMVPTexView.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+			commandList.SetPipelineState(scenario->pso.get());
+			commandList.SetGraphicsBinder(&scenario->binder);
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 400), m_pointLightShadowMapTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 400), m_pointLightShadowMapTexView);
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_cascadedShadowMapTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 500), m_cascadedShadowMapTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 501), m_shadowMXTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 502), m_csmSplitsTexView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 503), m_lightMVPTexView);
 
-		commandList.SetResourceState(m_lightCullDataView.GetResource(), {gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE	});
+			commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_lightCullDataView);
 
-		commandList.BindGraphics(BindParameter(eBindParameterType::TEXTURE, 600), m_lightCullDataView);
+			commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 100), &lightConstants, sizeof(lightConstants));
+			commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &uniformsCBData, sizeof(uniformsCBData));
+		}
 
 		// Set material parameters
-		std::vector<uint8_t> materialConstants(scenario.constantsSize);
-		for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
-			const Material::Parameter& param = (*material)[paramIdx];
-			switch (param.GetType()) {
-			case eMaterialShaderParamType::BITMAP_COLOR_2D:
-			case eMaterialShaderParamType::BITMAP_VALUE_2D:
-			{
-				BindParameter bindSlot(eBindParameterType::TEXTURE, scenario.offsets[paramIdx]);
-				commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
-				commandList.BindGraphics(bindSlot, ((Image*)param)->GetSrv());
-				break;
-			}
-			case eMaterialShaderParamType::COLOR:
-			{
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 0) = ((Vec4)param).x;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 4) = ((Vec4)param).y;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 8) = ((Vec4)param).z;
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx] + 12) = ((Vec4)param).w;
-				break;
-			}
-			case eMaterialShaderParamType::VALUE:
-			{
-				*reinterpret_cast<float*>(materialConstants.data() + scenario.offsets[paramIdx]) = ((float)param);
-				break;
+		if (scenarioChanged || material != currentMaterial) {
+			currentMaterial = material;
+
+			materialConstants.assign(scenario->constantsSize, 0);
+			for (size_t paramIdx = 0; paramIdx < material->GetParameterCount(); ++paramIdx) {
+				const Material::Parameter& param = (*material)[paramIdx];
+				switch (param.GetType()) {
+				case eMaterialShaderParamType::BITMAP_COLOR_2D:
+				case eMaterialShaderParamType::BITMAP_VALUE_2D:
+				{
+					commandList.SetResourceState(((Image*)param)->GetSrv().GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
+					commandList.BindGraphics(scenario->materialTextureParams[paramIdx], ((Image*)param)->GetSrv());
+					break;
+				}
+				case eMaterialShaderParamType::COLOR:
+				{
+					*reinterpret_cast<float*>(materialConstants.data() + scenario->offsets[paramIdx] + 0) = ((Vec4)param).x;
+					*reinterpret_cast<float*>(materialConstants.data() + scenario->offsets[paramIdx] + 4) = ((Vec4)param).y;
+					*reinterpret_cast<float*>(materialConstants.data() + scenario->offsets[paramIdx] + 8) = ((Vec4)param).z;
+					*reinterpret_cast<float*>(materialConstants.data() + scenario->offsets[paramIdx] + 12) = ((Vec4)param).w;
+					break;
+				}
+				case eMaterialShaderParamType::VALUE:
+				{
+					*reinterpret_cast<float*>(materialConstants.data() + scenario->offsets[paramIdx]) = ((float)param);
+					break;
+				}
+				}
 			}
+			if (scenario->constantsSize > 0) {
+				commandList.BindGraphics(scenario->materialConstantsParam, materialConstants.data(), (int)materialConstants.size());
 			}
 		}
-		if (scenario.constantsSize > 0) {
-			commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 200), materialConstants.data(), (int)materialConstants.size());
+
+		// Set vertex constants of the instances
+		size_t last = first + 1;
+		while (last < m_drawList.size()
+			&& last - first < MAX_INSTANCES_PER_DRAW
+			&& m_drawList[last].mesh == mesh
+			&& m_drawList[last].lod == item.lod
+			&& m_drawList[last].material == material)
+		{
+			++last;
+		}
+
+		instanceConstants.resize(last - first);
+		for (size_t instanceIdx = 0; instanceIdx < instanceConstants.size(); ++instanceIdx) {
+			const MeshEntity* entity = m_drawList[first + instanceIdx].entity;
+			VsConstants& vsConstants = instanceConstants[instanceIdx];
+			vsConstants.m = entity->GetTransform();
+			vsConstants.mvp = entity->GetTransform() * viewProjection;
+			vsConstants.mv = entity->GetTransform() * view;
+			vsConstants.prevMVP = entity->GetPrevTransform() * prevViewProjection;
 		}
 
-		assert(m_directionalLights->Size() == 1);
-		const DirectionalLight* sun = *m_directionalLights->begin();
-
-		// Set vertex and light constants
-		VsConstants vsConstants;
-		LightConstants lightConstants;
-		vsConstants.m = entity->GetTransform();
-		vsConstants.mvp = entity->GetTransform() * viewProjection;
-		vsConstants.mv = entity->GetTransform() * view;
-		vsConstants.v = view;
-		vsConstants.p = projection;
-		vsConstants.prevMVP = entity->GetPrevTransform() * prevViewProjection;
-		Vec4 vsLightDir = Vec4(sun->GetDirection(), 0.0f) * view;
-		lightConstants.direction = Vec3(vsLightDir.xyz).Normalized();
-		lightConstants.color = sun->GetColor();
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 0), &vsConstants, sizeof(vsConstants));
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 100), &lightConstants, sizeof(lightConstants));
-
-		Uniforms uniformsCBData;
-		uniformsCBData.screen_dimensions = Vec4((float)m_rtv.GetResource().GetWidth(), (float)m_rtv.GetResource().GetHeight(), 0.f, 0.f);
-		//uniformsCBData.ld[0].vs_position = Vec4(m_camera->GetPosition() + m_camera->GetLookDirection() * 5.f, 1.0f) * m_camera->GetViewMatrix();
-		uniformsCBData.ld[0].vs_position = Vec4(Vec3(0, 0, 1), 1.0f) * m_camera->GetViewMatrix();
-		uniformsCBData.ld[0].attenuation_end = Vec4(5.0f, 0.f, 0.f, 0.f);
-		uniformsCBData.ld[0].diffuse_color = Vec4(1.f, 0.f, 0.f, 1.f);
-		uniformsCBData.vs_cam_pos = Vec4(m_camera->GetPosition(), 1.0f) * m_camera->GetViewMatrix();
-		uniformsCBData.invV = m_camera->GetViewMatrix().Inverse();
-
-		uint32_t dispatchW, dispatchH;
-		SetWorkgroupSize((unsigned)m_rtv.GetResource().GetWidth(), (unsigned)m_rtv.GetResource().GetHeight(), 16, 16, dispatchW, dispatchH);
-
-		uniformsCBData.group_size_x = dispatchW;
-		uniformsCBData.group_size_y = dispatchH;
-
-		uniformsCBData.halfExposureFramerate = 0.5 * 0.75 * 150; //TODO add measured FPS (or target)
-		uniformsCBData.maxMotionBlurRadius = 20;
-
-		commandList.BindGraphics(BindParameter(eBindParameterType::CONSTANT, 600), &uniformsCBData, sizeof(uniformsCBData));
+		commandList.BindGraphics(scenario->vsConstantsParam, instanceConstants.data(), int(instanceConstants.size() * sizeof(VsConstants)));
 
 		// Set primitives
-		vertexBuffers.clear(); sizes.clear(); strides.clear();
-		for (size_t i = 0; i < mesh->GetNumStreams(); ++i) {
-			vertexBuffers.push_back(&mesh->GetVertexBuffer(i));
-			sizes.push_back((unsigned)mesh->GetVertexBuffer(i).GetSize());
-			strides.push_back((unsigned)mesh->GetVertexBufferStride(i));
+		if (scenarioChanged || mesh != currentMesh) {
+			MeshConstants meshConstants;
+			meshConstants.positionOffset = mesh->GetPositionOffset();
+			meshConstants.positionScale = mesh->GetPositionScale();
+			commandList.BindGraphics(scenario->meshConstantsParam, &meshConstants, sizeof(meshConstants));
+		}
+		if (mesh != currentMesh) {
+			currentMesh = mesh;
+
+			vertexBuffers.clear(); sizes.clear(); strides.clear();
+			for (size_t i = 0; i < mesh->GetNumStreams(); ++i) {
+				vertexBuffers.push_back(&mesh->GetVertexBuffer(i));
+				sizes.push_back((unsigned)mesh->GetVertexBuffer(i).GetSize());
+				strides.push_back((unsigned)mesh->GetVertexBufferStride(i));
 
-			commandList.SetResourceState(mesh->GetVertexBuffer(i), gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+				commandList.SetResourceState(mesh->GetVertexBuffer(i), gxapi::eResourceState::VERTEX_AND_CONSTANT_BUFFER);
+			}
+			commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
+			commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
+			commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
 		}
-		commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
-		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
-		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
 
-		// Drawcall
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		// Drawcall, the clusters of single full meshes are culled one by one
+		if (instanceConstants.size() == 1 && item.lod == 0 && !mesh->GetClusters().empty()) {
+			clusterCuller.Cull(*item.entity, ranges);
+			for (const auto& range : ranges) {
+				commandList.DrawIndexedInstanced(range.numIndices, range.firstIndex, 0, 1);
+			}
+		}
+		else {
+			const Mesh::Lod& lod = mesh->GetLod(item.lod);
+			commandList.DrawIndexedInstanced(lod.numIndices, lod.firstIndex, 0, (unsigned)instanceConstants.size());
+		}
 
+		first = last;
 	}
 }
 
@@ -511,7 +564,7 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		Binder binder;
 
 		binder = GenerateBinder(context, shader.GetShaderParameters(), offsets, constantsSize);
-		pso = CreatePso(context, binder, vsIt->second.vs, psIt->second.ps, renderTargetFormat, depthStencilFormat);
+		pso = CreatePso(context, layout, binder, vsIt->second.vs, psIt->second.ps, renderTargetFormat, depthStencilFormat);
 
 		auto res = m_scenarios.insert({ key, ScenarioData() });
 		scenarioIt = res.first;
@@ -521,6 +574,23 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		scenarioIt->second.offsets = std::move(offsets);
 		scenarioIt->second.binder = std::move(binder);
 		scenarioIt->second.constantsSize = constantsSize;
+
+		ScenarioData& scenario = scenarioIt->second;
+		scenario.vsConstantsParam = scenario.binder.GetHandle(BindParameter(eBindParameterType::CONSTANT, 0));
+		scenario.meshConstantsParam = scenario.binder.GetHandle(BindParameter(eBindParameterType::CONSTANT, 1));
+		if (scenario.constantsSize > 0) {
+			scenario.materialConstantsParam = scenario.binder.GetHandle(BindParameter(eBindParameterType::CONSTANT, 200));
+		}
+		const auto& shaderParams = shader.GetShaderParameters();
+		scenario.materialTextureParams.resize(shaderParams.size());
+		for (size_t paramIdx = 0; paramIdx < shaderParams.size(); ++paramIdx) {
+			if (shaderParams[paramIdx].type == eMaterialShaderParamType::BITMAP_COLOR_2D
+				|| shaderParams[paramIdx].type == eMaterialShaderParamType::BITMAP_VALUE_2D)
+			{
+				BindParameter bindSlot(eBindParameterType::TEXTURE, scenario.offsets[paramIdx]);
+				scenario.materialTextureParams[paramIdx] = scenario.binder.GetHandle(bindSlot);
+			}
+		}
 	}
 	else if (scenarioIt->second.renderTargetFormat != renderTargetFormat
 		|| scenarioIt->second.depthStencilFormat != depthStencilFormat)
@@ -528,7 +598,7 @@ ForwardRender::ScenarioData& ForwardRender::GetScenario(
 		auto& vs = m_vertexShaders.at(layout).vs;
 		auto& ps = m_materialShaders.at(shaderCode).ps;
 
-		auto newPso = CreatePso(context, scenarioIt->second.binder, vs, ps, renderTargetFormat, depthStencilFormat);
+		auto newPso = CreatePso(context, layout, scenarioIt->second.binder, vs, ps, renderTargetFormat, depthStencilFormat);
 
 		scenarioIt->second.pso = std::move(newPso);
 		scenarioIt->second.renderTargetFormat = renderTargetFormat;
@@ -557,7 +627,11 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		throw InvalidArgumentException("Mesh must have 3 attributes: position, normal, texcoord.");
 	}
 
-	std::string vertexShader =
+	// Texture coordinates are converted by the input layout, octahedral normals need decoding.
+	const bool octahedralNormals = elements[1].format == gxapi::eFormat::R16G16_SNORM || elements[1].format == gxapi::eFormat::R8G8_SNORM;
+
+	std::string vertexShader = std::string(
+		"#include \"VertexDecode\"\n"
 		"Texture2D<float4> lightMVPTex : register(t503);"
 		"struct VsConstants \n"
 		"{\n"
@@ -565,10 +639,16 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4x4 prevMVP;\n"
 		"	float4x4 MV;\n"
 		"	float4x4 M;\n"
-		"	float4x4 V;\n"
-		"	float4x4 P;\n"
 		"};\n"
-		"ConstantBuffer<VsConstants> vsConstants : register(b0);\n"
+		"cbuffer VsInstances : register(b0)\n"
+		"{\n"
+		"	VsConstants vsInstances[") + std::to_string(MAX_INSTANCES_PER_DRAW) + "];\n"
+		"};\n"
+		"cbuffer MeshConstants : register(b1)\n"
+		"{\n"
+		"	float3 positionOffset;\n"
+		"	float3 positionScale;\n"
+		"};\n"
 
 		"struct PS_Input\n"
 		"{\n"
@@ -581,9 +661,12 @@ std::string ForwardRender::GenerateVertexShader(const Mesh::Layout& layout) {
 		"	float4 currPosition : TEX_COORD4;\n"
 		"};\n"
 
-		"PS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD)\n"
+		"PS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD, uint instanceId : SV_InstanceID)\n"
 		"{\n"
+		"	VsConstants vsConstants = vsInstances[instanceId];\n"
 		"	PS_Input result;\n"
+		"	position = DecodePosition(position, positionOffset, positionScale);\n"
+		+ (octahedralNormals ? "	normal.xyz = DecodeOctahedral(normal.xy);\n" : "") +
 		//"	normal.xyz = normalize(normal.xyz);\n"
 		"	float3 viewNormal = mul(normal.xyz, (float3x3)vsConstants.MV);\n"
 
@@ -891,7 +974,7 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 
 	BindParameterDesc vsCbDesc;
 	vsCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 0);
-	vsCbDesc.constantSize = sizeof(VsConstants);
+	vsCbDesc.constantSize = sizeof(VsConstants) * MAX_INSTANCES_PER_DRAW;
 	vsCbDesc.relativeAccessFrequency = 0;
 	vsCbDesc.relativeChangeFrequency = 0;
 	vsCbDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
@@ -927,7 +1010,15 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 	samplerParam.registerSpace = 0;
 	samplerParam.shaderVisibility = gxapi::eShaderVisiblity::PIXEL;
 
+	BindParameterDesc meshCbDesc;
+	meshCbDesc.parameter = BindParameter(eBindParameterType::CONSTANT, 1);
+	meshCbDesc.constantSize = sizeof(MeshConstants);
+	meshCbDesc.relativeAccessFrequency = 0;
+	meshCbDesc.relativeChangeFrequency = 0;
+	meshCbDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
+
 	descs.push_back(vsCbDesc);
+	descs.push_back(meshCbDesc);
 	descs.push_back(lightCbDesc);
 	descs.push_back(lightUniformsCbDesc);
 
@@ -962,6 +1053,7 @@ Binder ForwardRender::GenerateBinder(RenderContext& context, const std::vector<M
 
 std::unique_ptr<gxapi::IPipelineState> ForwardRender::CreatePso(
 	RenderContext& context,
+	const Mesh::Layout& layout,
 	Binder& binder,
 	ShaderStage& vs,
 	ShaderStage & ps,
@@ -970,11 +1062,11 @@ std::unique_ptr<gxapi::IPipelineState> ForwardRender::CreatePso(
 {
 	std::unique_ptr<gxapi::IPipelineState> result;
 
-	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-		gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
-	};
+	std::vector<gxapi::InputElementDesc> inputElementDesc = GetInputLayout(layout, {
+		eVertexElementSemantic::POSITION,
+		eVertexElementSemantic::NORMAL,
+		eVertexElementSemantic::TEX_COORD,
+	});
 
 	gxapi::GraphicsPipelineStateDesc psoDesc;
 	psoDesc.inputLayout.elements = inputElementDesc.data();
@@ -7,6 +7,8 @@
 #include "../Material.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "../DrawListBuilder.hpp"
+#include "../LodSelector.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -47,15 +49,27 @@ private:
 		Binder binder;
 		std::vector<int> offsets;
 		size_t constantsSize;
+
+		// Slots bound for every draw, resolved once when the binder is created.
+		BindHandle vsConstantsParam;
+		BindHandle meshConstantsParam;
+		BindHandle materialConstantsParam;
+		std::vector<BindHandle> materialTextureParams; // indexed like offsets, unused for non-texture parameters
 	};
 	struct VsConstants {
 		Mat44_Packed mvp;
 		Mat44_Packed prevMVP;
 		Mat44_Packed mv;
 		Mat44_Packed m;
-		Mat44_Packed v;
-		Mat44_Packed p;
-	};	
+	};
+	/// <summary> Entities sharing a mesh and a material are drawn with a single instanced call,
+	///		their <see cref="VsConstants"/> are indexed by the instance ID in the vertex shader. </summary>
+	static constexpr unsigned MAX_INSTANCES_PER_DRAW = 128;
+	/// <summary> Decodes the positions of the mesh, see <see cref="Mesh::GetPositionOffset"/>. </summary>
+	struct MeshConstants {
+		alignas(16) Vec3_Packed positionOffset;
+		alignas(16) Vec3_Packed positionScale;
+	};
 	struct LightConstants {
 		alignas(16) Vec3_Packed direction;
 		alignas(16) Vec3_Packed color;
@@ -79,6 +93,7 @@ private:
 	Binder GenerateBinder(RenderContext& context, const std::vector<MaterialShaderParameter>& mtlParams, std::vector<int>& offsets, size_t& materialCbSize);
 	std::unique_ptr<gxapi::IPipelineState> CreatePso(
 		RenderContext& context,
+		const Mesh::Layout& layout,
 		Binder& binder,
 		ShaderStage& vs,
 		ShaderStage& ps,
@@ -109,6 +124,10 @@ private:
 	const BasicCamera* m_camera;
 	const EntityCollection<DirectionalLight>* m_directionalLights;
 
+	DrawListBuilder m_drawListBuilder;
+	LodSelector m_lodSelector; // selects the same as the depth prepass
+	std::vector<DrawItem> m_drawList;
+
 	TextureViewCube m_pointLightShadowMapTexView;
 	TextureView2D m_cascadedShadowMapTexView;
 	TextureView2D m_shadowMXTexView;
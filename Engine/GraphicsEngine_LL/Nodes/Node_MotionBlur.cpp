@@ -153,9 +153,10 @@ void MotionBlur::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Motion blur full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -210,6 +211,7 @@ void MotionBlur::Execute(RenderContext& context) {
 	uniformsCBData.maxSampleTapDistance = 6;
 
 	commandList.SetResourceState(m_motionblur_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_motionblur_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 	commandList.SetResourceState(m_velocityTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 	commandList.SetResourceState(m_neighborMaxTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
@@ -254,38 +256,33 @@ void MotionBlur::Execute(RenderContext& context) {
 
 
 void MotionBlur::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatMotionBlur = eFormat::R16G16B16A16_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth(),
-			m_inputTexSrv.GetResource().GetHeight(),
-			formatMotionBlur
-		};
+	using gxapi::eFormat;
 
-		Texture2D motionblur_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		motionblur_tex.SetName("Motion blur tex");
-		m_motionblur_rtv = context.CreateRtv(motionblur_tex, formatMotionBlur, rtvDesc);
-		
-	}
+	auto formatMotionBlur = eFormat::R16G16B16A16_FLOAT;
+
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
+
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth(),
+		m_inputTexSrv.GetResource().GetHeight(),
+		formatMotionBlur
+	};
+
+	Texture2D motionblur_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	motionblur_tex.SetName("Motion blur tex");
+	m_motionblur_rtv = context.CreateRtv(motionblur_tex, formatMotionBlur, rtvDesc);
 }
 
 
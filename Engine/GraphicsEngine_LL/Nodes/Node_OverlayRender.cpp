@@ -16,6 +16,12 @@
 
 namespace inl::gxeng::nodes {
 
+struct Transform
+{
+	Mat44_Packed MVP;
+	alignas(16) Vec3_Packed positionOffset;
+	alignas(16) Vec3_Packed positionScale;
+};
 
 static void ConvertToSubmittable(
 	Mesh* mesh,
@@ -126,7 +132,10 @@ void OverlayRender::Execute(RenderContext& context) {
 		auto world = entity->GetTransform();
 		auto MVP = viewProjection * world;
 
-		Mat44_Packed transformCBData = MVP;
+		Transform transformCBData;
+		transformCBData.MVP = MVP;
+		transformCBData.positionOffset = mesh->GetPositionOffset();
+		transformCBData.positionScale = mesh->GetPositionScale();
 
 		auto renderType = entity->GetSurfaceType();
 		if (renderType == OverlayEntity::COLORED) {
@@ -135,7 +144,7 @@ void OverlayRender::Execute(RenderContext& context) {
 				continue;
 			}
 
-			commandList.SetPipelineState(m_coloredPipeline.pso.get());
+			commandList.SetPipelineState(m_coloredPipeline.psos.Get(context, mesh->GetLayout()));
 			commandList.SetGraphicsBinder(&m_coloredPipeline.binder.value());
 
 			Vec4_Packed colorCBData = color;
@@ -145,7 +154,7 @@ void OverlayRender::Execute(RenderContext& context) {
 		}
 		else {
 			assert(renderType == OverlayEntity::TEXTURED);
-			commandList.SetPipelineState(m_texturedPipeline.pso.get());
+			commandList.SetPipelineState(m_texturedPipeline.psos.Get(context, mesh->GetLayout()));
 			commandList.SetGraphicsBinder(&m_texturedPipeline.binder.value());
 			commandList.SetResourceState(entity->GetTexture()->GetSrv().GetResource(), 
 										 gxapi::eResourceState(gxapi::eResourceState::PIXEL_SHADER_RESOURCE) + gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE);
@@ -160,7 +169,7 @@ void OverlayRender::Execute(RenderContext& context) {
 		commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
 		commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 		commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-		commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+		commandList.DrawIndexedInstanced(mesh->GetLod(0).numIndices, mesh->GetLod(0).firstIndex);
 	}
 }
 
@@ -172,7 +181,7 @@ void OverlayRender::InitColoredBindings(SetupContext& context) {
 		BindParameterDesc transformBindParamDesc;
 		m_coloredPipeline.transformParam = BindParameter(eBindParameterType::CONSTANT, 0);
 		transformBindParamDesc.parameter = m_coloredPipeline.transformParam;
-		transformBindParamDesc.constantSize = sizeof(float) * 4 * 4;
+		transformBindParamDesc.constantSize = sizeof(Transform);
 		transformBindParamDesc.relativeAccessFrequency = 0;
 		transformBindParamDesc.relativeChangeFrequency = 0;
 		transformBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
@@ -195,7 +204,7 @@ void OverlayRender::InitTexturedBindings(SetupContext& context) {
 		BindParameterDesc transformBindParamDesc;
 		m_texturedPipeline.transformParam = BindParameter(eBindParameterType::CONSTANT, 0);
 		transformBindParamDesc.parameter = m_texturedPipeline.transformParam;
-		transformBindParamDesc.constantSize = sizeof(float) * 4 * 4;
+		transformBindParamDesc.constantSize = sizeof(Transform);
 		transformBindParamDesc.relativeAccessFrequency = 0;
 		transformBindParamDesc.relativeChangeFrequency = 0;
 		transformBindParamDesc.shaderVisibility = gxapi::eShaderVisiblity::VERTEX;
@@ -231,14 +240,11 @@ void OverlayRender::InitTexturedBindings(SetupContext& context) {
 
 
 gxapi::GraphicsPipelineStateDesc OverlayRender::GetPsoDesc(
-	std::vector<gxapi::InputElementDesc>& inputElementDesc,
 	gxeng::ShaderProgram& shader,
 	const Binder& binder,
 	gxapi::eFormat renderTargetFormat) const
 {
 	gxapi::GraphicsPipelineStateDesc psoDesc;
-	psoDesc.inputLayout.elements = inputElementDesc.data();
-	psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
 	psoDesc.rootSignature = binder.GetRootSignature();
 	psoDesc.vs = shader.vs;
 	psoDesc.ps = shader.ps;
@@ -270,14 +276,10 @@ void OverlayRender::InitColoredPso(SetupContext& context, gxapi::eFormat renderT
 
 		m_coloredShader = context.CreateShader("OverlayColored", shaderParts, "");
 	}
-	
-	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0)
-	};
 
-	if (m_coloredPipeline.pso == nullptr || m_renderTargetFormat != renderTargetFormat) {
-		gxapi::GraphicsPipelineStateDesc psoDesc = GetPsoDesc(inputElementDesc, m_coloredShader, m_coloredPipeline.binder.value(), renderTargetFormat);
-		m_coloredPipeline.pso.reset(context.CreatePSO(psoDesc));
+	if (!m_coloredPipeline.psos.IsValid() || m_renderTargetFormat != renderTargetFormat) {
+		gxapi::GraphicsPipelineStateDesc psoDesc = GetPsoDesc(m_coloredShader, m_coloredPipeline.binder.value(), renderTargetFormat);
+		m_coloredPipeline.psos.Reset(psoDesc, { eVertexElementSemantic::POSITION });
 	}
 }
 
@@ -291,14 +293,9 @@ void OverlayRender::InitTexturedPso(SetupContext& context, gxapi::eFormat render
 		m_texturedShader = context.CreateShader("OverlayTextured", shaderParts, "");
 	}
 
-	std::vector<gxapi::InputElementDesc> inputElementDesc = {
-		gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-		gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 12),
-	};
-
-	if (m_texturedPipeline.pso == nullptr || m_renderTargetFormat != renderTargetFormat) {
-		gxapi::GraphicsPipelineStateDesc psoDesc = GetPsoDesc(inputElementDesc, m_texturedShader, m_texturedPipeline.binder.value(), renderTargetFormat);
-		m_texturedPipeline.pso.reset(context.CreatePSO(psoDesc));
+	if (!m_texturedPipeline.psos.IsValid() || m_renderTargetFormat != renderTargetFormat) {
+		gxapi::GraphicsPipelineStateDesc psoDesc = GetPsoDesc(m_texturedShader, m_texturedPipeline.binder.value(), renderTargetFormat);
+		m_texturedPipeline.psos.Reset(psoDesc, { eVertexElementSemantic::POSITION, eVertexElementSemantic::TEX_COORD });
 	}
 }
 
@@ -309,7 +306,6 @@ bool OverlayRender::CheckMeshFormat(Mesh * mesh) {
 		if (elements.size() > 2) return false;
 		if (elements[0].semantic != eVertexElementSemantic::POSITION) return false;
 		if (elements[1].semantic != eVertexElementSemantic::TEX_COORD) return false;
-		if (elements[1].offset != 12) return false;
 	}
 
 	return true;
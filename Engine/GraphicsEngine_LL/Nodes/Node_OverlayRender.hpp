@@ -7,6 +7,7 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "NodeUtility.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -38,7 +39,7 @@ protected:
 	struct BasePipelineObjects {
 		std::optional<Binder> binder;
 		BindParameter transformParam;
-		std::unique_ptr<gxapi::IPipelineState> pso;
+		MeshPipelineStates psos;
 	};
 	struct TexturedPipelineObjects : public BasePipelineObjects {
 		BindParameter textureParam;
@@ -61,7 +62,6 @@ protected:
 	void InitTexturedBindings(SetupContext& context);
 
 	gxapi::GraphicsPipelineStateDesc GetPsoDesc(
-		std::vector<gxapi::InputElementDesc>& inputElementDesc,
 		gxeng::ShaderProgram& shader,
 		const Binder& binder,
 		gxapi::eFormat renderTargetFormat) const;
@@ -145,9 +145,10 @@ void ScreenSpaceAmbientOcclusion::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Screen space ambient occlusion full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// The intermediate targets are transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -287,6 +288,7 @@ void ScreenSpaceAmbientOcclusion::Execute(RenderContext& context) {
 
 	{ //SSAO pass
 		commandList.SetResourceState(m_ssao_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+		commandList.ClearRenderTarget(m_ssao_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 		commandList.SetResourceState(m_depthTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
 		RenderTargetView2D* pRTV = &m_ssao_rtv;
@@ -320,6 +322,7 @@ void ScreenSpaceAmbientOcclusion::Execute(RenderContext& context) {
 
 	{ //Bilateral horizontal blur pass
 		commandList.SetResourceState(m_blur_horizontal_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+		commandList.ClearRenderTarget(m_blur_horizontal_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 		commandList.SetResourceState(m_ssao_srv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 		commandList.SetResourceState(m_depthTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
@@ -397,37 +400,43 @@ void ScreenSpaceAmbientOcclusion::Execute(RenderContext& context) {
 
 
 void ScreenSpaceAmbientOcclusion::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
+	using gxapi::eFormat;
 
-		using gxapi::eFormat;
+	auto formatSSAO = eFormat::R8G8B8A8_UNORM;
 
-		auto formatSSAO = eFormat::R8G8B8A8_UNORM;
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
+
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
 
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
+	Texture2DDesc desc{
+		m_depthTexSrv.GetResource().GetWidth(),
+		m_depthTexSrv.GetResource().GetHeight(),
+		formatSSAO
+	};
 
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
+	Texture2D ssao_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	ssao_tex.SetName("Screen space ambient occlusion tex");
+	m_ssao_rtv = context.CreateRtv(ssao_tex, formatSSAO, rtvDesc);
+	m_ssao_srv = context.CreateSrv(ssao_tex, formatSSAO, srvDesc);
 
-		Texture2DDesc desc{
-			m_depthTexSrv.GetResource().GetWidth(),
-			m_depthTexSrv.GetResource().GetHeight(),
-			formatSSAO
-		};
+	Texture2D blur_horizontal_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	blur_horizontal_tex.SetName("Screen space ambient occlusion horizontal blur tex");
+	m_blur_horizontal_rtv = context.CreateRtv(blur_horizontal_tex, formatSSAO, rtvDesc);
+	m_blur_horizontal_srv = context.CreateSrv(blur_horizontal_tex, formatSSAO, srvDesc);
 
-		Texture2D ssao_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		ssao_tex.SetName("Screen space ambient occlusion tex");
-		m_ssao_rtv = context.CreateRtv(ssao_tex, formatSSAO, rtvDesc);
-		m_ssao_srv = context.CreateSrv(ssao_tex, formatSSAO, srvDesc);
+	// The vertical blur reads the result of the previous frame, these two persist.
+	if (!m_outputTexturesInited) {
+		m_outputTexturesInited = true;
 
 		Texture2D blur_vertical1_tex = context.CreateTexture2D(desc, { true, true, false, false });
 		blur_vertical1_tex.SetName("Screen space ambient occlusion vertical blur tex");
@@ -438,11 +447,6 @@ void ScreenSpaceAmbientOcclusion::InitRenderTarget(SetupContext& context) {
 		blur_vertical0_tex.SetName("Screen space ambient occlusion vertical blur tex");
 		m_blur_vertical0_rtv = context.CreateRtv(blur_vertical0_tex, formatSSAO, rtvDesc);
 		m_blur_vertical0_srv = context.CreateSrv(blur_vertical0_tex, formatSSAO, srvDesc);
-
-		Texture2D blur_horizontal_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		blur_horizontal_tex.SetName("Screen space ambient occlusion horizontal blur tex");
-		m_blur_horizontal_rtv = context.CreateRtv(blur_horizontal_tex, formatSSAO, rtvDesc);
-		m_blur_horizontal_srv = context.CreateSrv(blur_horizontal_tex, formatSSAO, srvDesc);
 	}
 }
 
@@ -141,9 +141,10 @@ void ScreenSpaceReflection::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Screen space reflection full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -250,6 +251,10 @@ void ScreenSpaceReflection::Execute(RenderContext& context) {
 
 	Uniforms uniformsCBData;
 
+	// Transient, content is undefined. Cleared before the early out so that the output is black.
+	commandList.SetResourceState(m_ssr_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_ssr_rtv, gxapi::ColorRGBA(0, 0, 0, 0));
+
 	bool peti = true;
 	if (peti)
 	{
@@ -401,68 +406,69 @@ void ScreenSpaceReflection::Execute(RenderContext& context) {
 
 
 void ScreenSpaceReflection::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
-
-		auto formatSSR = eFormat::R16G16B16A16_FLOAT;
-
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
-
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
-
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth(),
-			m_inputTexSrv.GetResource().GetHeight(),
-			formatSSR
-		};
+	using gxapi::eFormat;
 
-		Texture2D ssr_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		ssr_tex.SetName("Screen space reflection tex");
-		m_ssr_rtv = context.CreateRtv(ssr_tex, formatSSR, rtvDesc);
+	auto formatSSR = eFormat::R16G16B16A16_FLOAT;
 
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
 
-		unsigned numMips = m_ssr_rtv.GetResource().GetNumMiplevels();
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
 
-		Texture2DDesc mipDesc;
-		mipDesc.arraySize = 1;
-		mipDesc.format = formatSSR;
-		mipDesc.width = m_inputTexSrv.GetResource().GetWidth();
-		mipDesc.height = m_inputTexSrv.GetResource().GetHeight();
-		mipDesc.mipLevels = numMips;
-		Texture2D blur_tex = context.CreateTexture2D(mipDesc, { true, true, false, false });
-		blur_tex.SetName("Screen space reflection blur tex");
-
-		for (unsigned c = 0; c < numMips; ++c) {
-			gxapi::RtvTexture2DArray rtvMipDesc;
-			rtvMipDesc.activeArraySize = 1;
-			rtvMipDesc.firstArrayElement = 0;
-			rtvMipDesc.firstMipLevel = c;
-			rtvMipDesc.planeIndex = 0;
-			m_input_rtv.push_back(context.CreateRtv(m_inputTexSrv.GetResource(), m_inputTexSrv.GetFormat(), rtvMipDesc));
-			m_blur_rtv.push_back(context.CreateRtv(blur_tex, blur_tex.GetFormat(), rtvMipDesc));
-
-			gxapi::SrvTexture2DArray srvMipDesc;
-			srvMipDesc.activeArraySize = 1;
-			srvMipDesc.firstArrayElement = 0;
-			srvMipDesc.numMipLevels = 1;
-			srvMipDesc.mipLevelClamping = 0;
-			srvMipDesc.mostDetailedMip = c;
-			srvMipDesc.planeIndex = 0;
-			m_input_srv.push_back(context.CreateSrv(m_inputTexSrv.GetResource(), m_inputTexSrv.GetFormat(), srvMipDesc));
-			m_blur_srv.push_back(context.CreateSrv(blur_tex, blur_tex.GetFormat(), srvMipDesc));
-		}
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth(),
+		m_inputTexSrv.GetResource().GetHeight(),
+		formatSSR
+	};
+
+	Texture2D ssr_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	ssr_tex.SetName("Screen space reflection tex");
+	m_ssr_rtv = context.CreateRtv(ssr_tex, formatSSR, rtvDesc);
+
+
+	unsigned numMips = m_ssr_rtv.GetResource().GetNumMiplevels();
+
+	Texture2DDesc mipDesc;
+	mipDesc.arraySize = 1;
+	mipDesc.format = formatSSR;
+	mipDesc.width = m_inputTexSrv.GetResource().GetWidth();
+	mipDesc.height = m_inputTexSrv.GetResource().GetHeight();
+	mipDesc.mipLevels = numMips;
+	Texture2D blur_tex = context.CreateTransientTexture2D(mipDesc, { true, true, false, false });
+	blur_tex.SetName("Screen space reflection blur tex");
+
+	// The input may be a different texture every frame, its views are made again too.
+	m_input_rtv.clear();
+	m_blur_rtv.clear();
+	m_input_srv.clear();
+	m_blur_srv.clear();
+	for (unsigned c = 0; c < numMips; ++c) {
+		gxapi::RtvTexture2DArray rtvMipDesc;
+		rtvMipDesc.activeArraySize = 1;
+		rtvMipDesc.firstArrayElement = 0;
+		rtvMipDesc.firstMipLevel = c;
+		rtvMipDesc.planeIndex = 0;
+		m_input_rtv.push_back(context.CreateRtv(m_inputTexSrv.GetResource(), m_inputTexSrv.GetFormat(), rtvMipDesc));
+		m_blur_rtv.push_back(context.CreateRtv(blur_tex, blur_tex.GetFormat(), rtvMipDesc));
+
+		gxapi::SrvTexture2DArray srvMipDesc;
+		srvMipDesc.activeArraySize = 1;
+		srvMipDesc.firstArrayElement = 0;
+		srvMipDesc.numMipLevels = 1;
+		srvMipDesc.mipLevelClamping = 0;
+		srvMipDesc.mostDetailedMip = c;
+		srvMipDesc.planeIndex = 0;
+		m_input_srv.push_back(context.CreateSrv(m_inputTexSrv.GetResource(), m_inputTexSrv.GetFormat(), srvMipDesc));
+		m_blur_srv.push_back(context.CreateSrv(blur_tex, blur_tex.GetFormat(), srvMipDesc));
 	}
 }
 
@@ -47,7 +47,6 @@ protected:
 	std::vector<std::unique_ptr<gxapi::IPipelineState> > m_blurVerticalPSO;
 
 protected: // outputs
-	bool m_outputTexturesInited = false;
 	RenderTargetView2D m_ssr_rtv;
 
 	VertexBuffer m_fsq;
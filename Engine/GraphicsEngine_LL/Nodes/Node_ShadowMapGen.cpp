@@ -15,6 +15,8 @@ namespace inl::gxeng::nodes {
 struct Uniforms
 {
 	Mat44_Packed mvp;
+	alignas(16) Vec3_Packed positionOffset;
+	alignas(16) Vec3_Packed positionScale;
 };
 
 static bool CheckMeshFormat(const Mesh& mesh) {
@@ -116,7 +118,7 @@ void ShadowMapGen::Setup(SetupContext & context) {
 		m_binder = context.CreateBinder({ uniformsBindParamDesc, sampBindParamDesc },{ samplerDesc });
 	}
 
-	if (!m_shadowGenPSO || pointLightDepthStencilFormat != m_depthStencilFormat) {
+	if (!m_shadowGenPSOs.IsValid() || pointLightDepthStencilFormat != m_depthStencilFormat) {
 		m_depthStencilFormat = pointLightDepthStencilFormat;
 
 		//TODO
@@ -127,18 +129,10 @@ void ShadowMapGen::Setup(SetupContext & context) {
 		shaderParts.vs = true;
 		shaderParts.ps = true;
 
-		std::vector<gxapi::InputElementDesc> inputElementDesc = {
-			gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-			gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-			gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
-		};
-
 		{
 			m_shadowGenShader = context.CreateShader("ShadowGen", shaderParts, "");
 
 			gxapi::GraphicsPipelineStateDesc psoDesc;
-			psoDesc.inputLayout.elements = inputElementDesc.data();
-			psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
 			psoDesc.rootSignature = m_binder->GetRootSignature();
 			psoDesc.vs = m_shadowGenShader.vs;
 			psoDesc.ps = m_shadowGenShader.ps;
@@ -150,7 +144,7 @@ void ShadowMapGen::Setup(SetupContext & context) {
 
 			psoDesc.numRenderTargets = 0;
 
-			m_shadowGenPSO.reset(context.CreatePSO(psoDesc));
+			m_shadowGenPSOs.Reset(psoDesc, { eVertexElementSemantic::POSITION });
 		}
 	}
 }
@@ -219,7 +213,6 @@ void ShadowMapGen::Execute(RenderContext & context) {
 		gxapi::Rectangle rect{ 0, (int)pointLightShadowMaps.GetHeight(), 0, (int)pointLightShadowMaps.GetWidth() };
 		commandList.SetScissorRects(1, &rect);
 
-		commandList.SetPipelineState(m_shadowGenPSO.get());
 		commandList.SetGraphicsBinder(&m_binder.value());
 		commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
 
@@ -247,7 +240,7 @@ void ShadowMapGen::Execute(RenderContext & context) {
 				Mesh* mesh = entity->GetMesh();
 				auto position = entity->GetPosition();
 
-				if (mesh->GetIndexBuffer().GetIndexCount() == 3600)
+				if (mesh->GetLod(0).numIndices == 3600)
 				{
 					continue; //skip quadcopter for visualization purposes (obscures camera...)
 				}
@@ -258,12 +251,15 @@ void ShadowMapGen::Execute(RenderContext & context) {
 					continue;
 				}
 
+				commandList.SetPipelineState(m_shadowGenPSOs.Get(context, mesh->GetLayout()));
 				ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
 
 				Mat44 model = entity->GetTransform();
 
 				Uniforms uniformsCBData;
 				uniformsCBData.mvp = model * pointLightMVPs[shadowMapIdx % 6];
+				uniformsCBData.positionOffset = mesh->GetPositionOffset();
+				uniformsCBData.positionScale = mesh->GetPositionScale();
 
 				commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(uniformsCBData));
 
@@ -274,7 +270,7 @@ void ShadowMapGen::Execute(RenderContext & context) {
 
 				commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 				commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-				commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+				commandList.DrawIndexedInstanced(mesh->GetLod(0).numIndices, mesh->GetLod(0).firstIndex);
 			}
 		}
 	}
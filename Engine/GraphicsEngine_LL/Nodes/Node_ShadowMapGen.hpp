@@ -7,6 +7,7 @@
 #include "../Mesh.hpp"
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
+#include "NodeUtility.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -40,7 +41,7 @@ protected:
 	std::optional<Binder> m_binder;
 	BindParameter m_uniformsBindParam;
 	ShaderProgram m_shadowGenShader;
-	std::unique_ptr<gxapi::IPipelineState> m_shadowGenPSO;
+	MeshPipelineStates m_shadowGenPSOs;
 	gxapi::eFormat m_depthStencilFormat;
 
 private: // render context
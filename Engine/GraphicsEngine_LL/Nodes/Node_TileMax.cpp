@@ -105,9 +105,10 @@ void TileMax::Setup(SetupContext& context) {
 		m_fsqIndices.SetName("Motion blur tilemax full screen quad index buffer");
 	}
 
-	if (!m_PSO) {
-		InitRenderTarget(context);
+	// Transient, requested again every frame.
+	InitRenderTarget(context);
 
+	if (!m_PSO) {
 		ShaderParts shaderParts;
 		shaderParts.vs = true;
 		shaderParts.ps = true;
@@ -159,6 +160,7 @@ void TileMax::Execute(RenderContext& context) {
 	uniformsCBData.maxMotionBlurRadius = 20.0;
 
 	commandList.SetResourceState(m_tilemax_rtv.GetResource(), gxapi::eResourceState::RENDER_TARGET);
+	commandList.ClearRenderTarget(m_tilemax_rtv, gxapi::ColorRGBA(0, 0, 0, 1)); // transient, content is undefined
 	commandList.SetResourceState(m_inputTexSrv.GetResource(), { gxapi::eResourceState::PIXEL_SHADER_RESOURCE, gxapi::eResourceState::NON_PIXEL_SHADER_RESOURCE });
 
 	RenderTargetView2D* pRTV = &m_tilemax_rtv;
@@ -197,40 +199,35 @@ void TileMax::Execute(RenderContext& context) {
 
 
 void TileMax::InitRenderTarget(SetupContext& context) {
-	if (!m_outputTexturesInited) {
-		m_outputTexturesInited = true;
-
-		using gxapi::eFormat;
+	using gxapi::eFormat;
 
-		auto formatTileMax = eFormat::R8G8_UNORM;
+	auto formatTileMax = eFormat::R8G8_UNORM;
 
-		const uint64_t maxMotionBlurRadius = 20;
+	const uint64_t maxMotionBlurRadius = 20;
 
-		gxapi::RtvTexture2DArray rtvDesc;
-		rtvDesc.activeArraySize = 1;
-		rtvDesc.firstArrayElement = 0;
-		rtvDesc.firstMipLevel = 0;
-		rtvDesc.planeIndex = 0;
+	gxapi::RtvTexture2DArray rtvDesc;
+	rtvDesc.activeArraySize = 1;
+	rtvDesc.firstArrayElement = 0;
+	rtvDesc.firstMipLevel = 0;
+	rtvDesc.planeIndex = 0;
 
-		gxapi::SrvTexture2DArray srvDesc;
-		srvDesc.activeArraySize = 1;
-		srvDesc.firstArrayElement = 0;
-		srvDesc.numMipLevels = -1;
-		srvDesc.mipLevelClamping = 0;
-		srvDesc.mostDetailedMip = 0;
-		srvDesc.planeIndex = 0;
+	gxapi::SrvTexture2DArray srvDesc;
+	srvDesc.activeArraySize = 1;
+	srvDesc.firstArrayElement = 0;
+	srvDesc.numMipLevels = -1;
+	srvDesc.mipLevelClamping = 0;
+	srvDesc.mostDetailedMip = 0;
+	srvDesc.planeIndex = 0;
 
-		Texture2DDesc desc{
-			m_inputTexSrv.GetResource().GetWidth() / maxMotionBlurRadius,
-			uint32_t(m_inputTexSrv.GetResource().GetHeight() / maxMotionBlurRadius),
-			formatTileMax
-		};
+	Texture2DDesc desc{
+		m_inputTexSrv.GetResource().GetWidth() / maxMotionBlurRadius,
+		uint32_t(m_inputTexSrv.GetResource().GetHeight() / maxMotionBlurRadius),
+		formatTileMax
+	};
 
-		Texture2D tilemax_tex = context.CreateTexture2D(desc, { true, true, false, false });
-		tilemax_tex.SetName("Motion blur tilemax tex");
-		m_tilemax_rtv = context.CreateRtv(tilemax_tex, formatTileMax, rtvDesc);
-		
-	}
+	Texture2D tilemax_tex = context.CreateTransientTexture2D(desc, { true, true, false, false });
+	tilemax_tex.SetName("Motion blur tilemax tex");
+	m_tilemax_rtv = context.CreateRtv(tilemax_tex, formatTileMax, rtvDesc);
 }
 
 
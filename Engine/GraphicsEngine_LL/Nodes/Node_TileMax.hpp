@@ -41,7 +41,6 @@ protected:
 	std::unique_ptr<gxapi::IPipelineState> m_PSO;
 
 protected: // outputs
-	bool m_outputTexturesInited = false;
 	RenderTargetView2D m_tilemax_rtv;
 
 	VertexBuffer m_fsq;
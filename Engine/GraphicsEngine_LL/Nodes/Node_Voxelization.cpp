@@ -22,6 +22,7 @@ struct Uniforms
 	Mat44_Packed model, viewProj;
 	Vec3_Packed voxelCenter; float voxelSize;
 	int voxelDimension; int inputMipLevel; int outputMipLevel;
+	alignas(16) Vec3_Packed positionOffset; alignas(16) Vec3_Packed positionScale;
 };
 
 static void SetWorkgroupSize(unsigned w, unsigned h, unsigned d, unsigned groupSizeW, unsigned groupSizeH, unsigned groupSizeD, unsigned& dispatchW, unsigned& dispatchH, unsigned& dispatchD)
@@ -280,19 +281,11 @@ void Voxelization::Setup(SetupContext & context) {
 		m_fsqIndices.SetName("Voxelization full screen quad index buffer");
 	}
 
-	if (m_PSO == nullptr) {
+	if (!m_PSOs.IsValid()) {
 		InitRenderTarget(context);
 
 		{
-			std::vector<gxapi::InputElementDesc> inputElementDesc = {
-				gxapi::InputElementDesc("POSITION", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 0),
-				gxapi::InputElementDesc("NORMAL", 0, gxapi::eFormat::R32G32B32_FLOAT, 0, 12),
-				gxapi::InputElementDesc("TEX_COORD", 0, gxapi::eFormat::R32G32_FLOAT, 0, 24),
-			};
-
 			gxapi::GraphicsPipelineStateDesc psoDesc;
-			psoDesc.inputLayout.elements = inputElementDesc.data();
-			psoDesc.inputLayout.numElements = (unsigned)inputElementDesc.size();
 			psoDesc.rootSignature = m_binder->GetRootSignature();
 			psoDesc.vs = m_shader.vs;
 			psoDesc.gs = m_shader.gs;
@@ -311,7 +304,7 @@ void Voxelization::Setup(SetupContext & context) {
 
 			psoDesc.numRenderTargets = 0;
 
-			m_PSO.reset(context.CreatePSO(psoDesc));
+			m_PSOs.Reset(psoDesc, { eVertexElementSemantic::POSITION, eVertexElementSemantic::TEX_COORD });
 		}
 
 		{ //light injection from a cascaded shadow map
@@ -405,7 +398,6 @@ void Voxelization::Execute(RenderContext & context) {
 	commandList.SetScissorRects(1, &rect);
 	commandList.SetViewports(1, &viewport);
 
-	commandList.SetPipelineState(m_PSO.get());
 	commandList.SetGraphicsBinder(&m_binder.value());
 	commandList.SetPrimitiveTopology(gxapi::ePrimitiveTopology::TRIANGLELIST);
 
@@ -433,7 +425,7 @@ void Voxelization::Execute(RenderContext & context) {
 				Material* material = entity->GetMaterial();
 				auto position = entity->GetPosition();
 
-				if (mesh->GetIndexBuffer().GetIndexCount() == 3600)
+				if (mesh->GetLod(0).numIndices == 3600)
 				{
 					continue; //skip quadcopter for visualization purposes (obscures camera...)
 				}
@@ -444,9 +436,12 @@ void Voxelization::Execute(RenderContext & context) {
 					continue;
 				}
 
+				commandList.SetPipelineState(m_PSOs.Get(context, mesh->GetLayout()));
 				ConvertToSubmittable(mesh, vertexBuffers, sizes, strides);
 
 				uniformsCBData.model = entity->GetTransform();
+				uniformsCBData.positionOffset = mesh->GetPositionOffset();
+				uniformsCBData.positionScale = mesh->GetPositionScale();
 
 				commandList.BindGraphics(m_uniformsBindParam, &uniformsCBData, sizeof(Uniforms));
 
@@ -468,7 +463,7 @@ void Voxelization::Execute(RenderContext & context) {
 				commandList.SetResourceState(mesh->GetIndexBuffer(), gxapi::eResourceState::INDEX_BUFFER);
 				commandList.SetVertexBuffers(0, (unsigned)vertexBuffers.size(), vertexBuffers.data(), sizes.data(), strides.data());
 				commandList.SetIndexBuffer(&mesh->GetIndexBuffer(), mesh->IsIndexBuffer32Bit());
-				commandList.DrawIndexedInstanced((unsigned)mesh->GetIndexBuffer().GetIndexCount());
+				commandList.DrawIndexedInstanced(mesh->GetLod(0).numIndices, mesh->GetLod(0).firstIndex);
 			}
 
 			commandList.UAVBarrier(m_voxelTexUAV[0].GetResource());
@@ -8,6 +8,7 @@
 #include "../ConstBufferHeap.hpp"
 #include "../PipelineTypes.hpp"
 #include "../Material.hpp"
+#include "NodeUtility.hpp"
 #include "GraphicsApi_LL/IPipelineState.hpp"
 #include "GraphicsApi_LL/IGxapiManager.hpp"
 
@@ -49,7 +50,7 @@ protected:
 	ShaderProgram m_visualizerShader;
 	ShaderProgram m_lightInjectionCSMShader;
 	ShaderProgram m_mipmapShader;
-	std::unique_ptr<gxapi::IPipelineState> m_PSO;
+	MeshPipelineStates m_PSOs;
 	std::unique_ptr<gxapi::IPipelineState> m_visualizerPSO;
 	std::unique_ptr<gxapi::IPipelineState> m_lightInjectionCSMPSO;
 	std::unique_ptr<gxapi::IPipelineState> m_mipmapCSO;
@@ -4,12 +4,18 @@
 * Output: shadow map for the specific cascade
 */
 
+#include "VertexDecode"
+
 Texture2D inputTex : register(t0); //lightMVP texture
 
+#define MAX_INSTANCES_PER_DRAW 256 // must match the node
+
 struct Uniforms
 {
-	float4x4 model;
 	uint cascadeIDX;
+	float3 positionOffset;
+	float3 positionScale;
+	float4x4 models[MAX_INSTANCES_PER_DRAW];
 };
 
 ConstantBuffer<Uniforms> uniforms : register(b0);
@@ -20,7 +26,7 @@ struct PS_Input
 };
 
 
-PS_Input VSMain(float4 position : POSITION)
+PS_Input VSMain(float4 position : POSITION, uint instanceId : SV_InstanceID)
 {
 	PS_Input result;
 
@@ -30,7 +36,8 @@ PS_Input VSMain(float4 position : POSITION)
 		light_mvp[d] = inputTex.Load(int3(uniforms.cascadeIDX * 4 + d, 0, 0));
 	}
 
-    result.position = mul(position, mul(uniforms.model, light_mvp));
+	position = DecodePosition(position, uniforms.positionOffset, uniforms.positionScale);
+	result.position = mul(position, mul(uniforms.models[instanceId], light_mvp));
 
 	return result;
 }
@@ -1,7 +1,11 @@
 
+#include "VertexDecode"
+
 struct Transform
 {
 	float4x4 MVP;
+	float3 positionOffset;
+	float3 positionScale;
 };
 
 ConstantBuffer<Transform> transform : register(b0);
@@ -17,10 +21,11 @@ struct PS_Input
 };
 
 
-PS_Input VSMain(float2 position : POSITION, float2 texCoord : TEX_COORD)
+PS_Input VSMain(float4 position : POSITION, float2 texCoord : TEX_COORD)
 {
 	PS_Input result;
 
+	position = DecodePosition(position, transform.positionOffset, transform.positionScale);
 	float4 pos = {position.x, position.y, 0, 1};
     result.position = mul(pos, transform.MVP);
 	result.texCoord = texCoord;
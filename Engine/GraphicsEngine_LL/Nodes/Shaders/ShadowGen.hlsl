@@ -4,9 +4,13 @@
 * Output: shadow map
 */
 
+#include "VertexDecode"
+
 struct Uniforms
 {
 	float4x4 mvp;
+	float3 positionOffset;
+	float3 positionScale;
 };
 
 ConstantBuffer<Uniforms> uniforms : register(b0);
@@ -21,7 +25,7 @@ PS_Input VSMain(float4 position : POSITION)
 {
 	PS_Input result;
 
-    result.position = mul(position, uniforms.mvp);
+	result.position = mul(DecodePosition(position, uniforms.positionOffset, uniforms.positionScale), uniforms.mvp);
 
 	return result;
 }
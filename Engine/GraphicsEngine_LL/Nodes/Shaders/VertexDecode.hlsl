@@ -0,0 +1,30 @@
+/*
+* Decodes the vertex elements compressed by the mesh, see VertexCompression.
+* The input assembler already converts the stored formats to float,
+* what's left here is undoing the encodings.
+*/
+
+// Positions are stored relative to the mesh's bounding box.
+// Uncompressed positions have zero offset and unit scale, the result is the same.
+float4 DecodePosition(float4 stored, float3 offset, float3 scale)
+{
+	return float4(offset + scale * stored.xyz, 1.0);
+}
+
+// Octahedral unit vectors: the lower half of the octahedron is folded over the upper one.
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 v = float3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (v.z < 0.0)
+	{
+		v.xy = (1.0 - abs(v.yx)) * float2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(v);
+}
+
+// Compressed tangents are octahedral too, their third component is the sign of the bitangent.
+void DecodeTangentFrame(float3 normal, float4 storedTangent, out float3 tangent, out float3 bitangent)
+{
+	tangent = DecodeOctahedral(storedTangent.xy);
+	bitangent = (storedTangent.z < 0.0 ? -1.0 : 1.0) * cross(normal, tangent);
+}
@@ -9,6 +9,7 @@ struct Uniforms
 	float4x4 model, viewProj;
 	float3 voxelCenter; float voxelSize;
 	int voxelDimension; int inputMipLevel; int outputMipLevel;
+	float3 positionOffset; float3 positionScale;
 };
 
 
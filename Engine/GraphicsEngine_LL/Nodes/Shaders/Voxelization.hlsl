@@ -4,11 +4,14 @@
 * Output: voxels inserted into R32U 3D voxel texture UAV
 */
 
+#include "VertexDecode"
+
 struct Uniforms
 {
 	float4x4 model, viewProj;
 	float3 voxelCenter; float voxelSize;
 	int voxelDimension; int inputMipLevel; int outputMipLevel;
+	float3 positionOffset; float3 positionScale;
 };
 
 
@@ -49,11 +52,12 @@ float4 decodeColor(uint color)
 		);
 }
 
-GS_Input VSMain(float4 position : POSITION, float4 normal : NORMAL, float4 texCoord : TEX_COORD)
+GS_Input VSMain(float4 position : POSITION, float4 texCoord : TEX_COORD)
 {
 	GS_Input result;
 
-    result.position = mul(position, uniforms.model);
+	position = DecodePosition(position, uniforms.positionOffset, uniforms.positionScale);
+	result.position = mul(position, uniforms.model);
 	result.texcoord = texCoord.xy;
 
 	return result;
@@ -1,7 +1,10 @@
+#include "VertexDecode"
 
 struct Transform
 {
 	float4x4 MVP;
+	float3 positionOffset;
+	float3 positionScale;
 };
 
 
@@ -17,7 +20,8 @@ PS_Input VSMain(float4 position : POSITION)
 {
 	PS_Input result;
 
-    result.position = mul(position, transform.MVP);
+	// Must match the forward render, it tests for equal depth.
+	result.position = mul(DecodePosition(position, transform.positionOffset, transform.positionScale), transform.MVP);
 
 	return result;
 }
@@ -11,8 +11,10 @@
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/prettywriter.h>
 #include <cassert>
+#include <algorithm>
 #include <optional>
 #include <typeinfo>
+#include <unordered_map>
 
 
 namespace inl {
@@ -48,6 +50,8 @@ static void AssertThrow(bool condition, const std::string& message);
 static NodeCreationInfo ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& jsonObj);
 static LinkCreationInfo ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& jsonObj);
 static StringErrorPosition GetStringErrorPosition(const std::string& str, size_t errorCharacter);
+static std::vector<std::pair<size_t, size_t>> GetNodeLinks(const std::vector<NodeBase*>& nodes);
+static std::string GetNodeDescription(const NodeBase& node);
 
 static std::string SerializeNodesAndLinks(std::vector<NodeCreationInfo> nodes, std::vector<LinkCreationInfo> links);
 
@@ -120,9 +124,19 @@ Pipeline::Pipeline(Pipeline&& rhs) : Pipeline() {
 	taskCopy.nodeMap(rhs.m_taskParentMap, this->m_taskParentMap);
 	taskCopy.run();
 
+	// the task function map points into the wrappers, they must move along
+	m_taskWrappers = std::move(rhs.m_taskWrappers);
+	m_schedule = std::move(rhs.m_schedule);
+	m_constantNodes = std::move(rhs.m_constantNodes);
+	m_compilationReport = std::move(rhs.m_compilationReport);
+
 	// clear rhs's stuff
 	rhs.m_dependencyGraph.clear();
 	rhs.m_taskGraph.clear();
+	rhs.m_taskWrappers.clear();
+	rhs.m_schedule = {};
+	rhs.m_constantNodes.clear();
+	rhs.m_compilationReport = {};
 }
 
 
@@ -262,6 +276,9 @@ void Pipeline::CreateFromDescription(const std::string& jsonDescription, Graphic
 	}
 
 
+	// Drop what doesn't contribute to the frame, only the rest is initialized.
+	CompileNodes(nodeObjects);
+
 	// Finish by creating the actual pipeline.
 	EngineContext engineContext(1, 1);
 	for (auto& node : nodeObjects) {
@@ -297,6 +314,9 @@ void Pipeline::CreateFromNodesList(const std::vector<std::shared_ptr<NodeBase>>
 	if (!isTaskGraphDAG) {
 		throw InvalidArgumentException("Supplied nodes do not make a directed acyclic graph.");
 	}
+
+	CalculateSchedule();
+	m_compilationReport.numTasks = m_schedule.tasks.size();
 }
 
 
@@ -308,8 +328,16 @@ std::string Pipeline::SerializeToJSON(const NodeFactory& factory) const {
 	std::vector<LinkCreationInfo> linkCreation;
 	int nodeId = 0;
 
+	// Folded nodes are still linked to the pipeline's nodes.
+	std::vector<NodeBase*> nodes;
 	for (lemon::ListDigraph::NodeIt it(m_dependencyGraph); it != lemon::INVALID; ++it) {
-		NodeBase* node = m_nodeMap[it].get();
+		nodes.push_back(m_nodeMap[it].get());
+	}
+	for (auto& node : m_constantNodes) {
+		nodes.push_back(node.get());
+	}
+
+	for (NodeBase* node : nodes) {
 		for (int i = 0; i < node->GetNumOutputs(); ++i) {
 			outputLookup[node->GetOutput(i)] = { node, i };
 		}
@@ -324,8 +352,7 @@ std::string Pipeline::SerializeToJSON(const NodeFactory& factory) const {
 		nodeCreation.insert({ node, info });
 	}
 
-	for (lemon::ListDigraph::NodeIt it(m_dependencyGraph); it != lemon::INVALID; ++it) {
-		NodeBase* dst = m_nodeMap[it].get();
+	for (NodeBase* dst : nodes) {
 		for (int i = 0; i < dst->GetNumInputs(); ++i) {
 			InputPortBase* input = dst->GetInput(i);
 			OutputPortBase* output = input->GetLink();
@@ -386,6 +413,18 @@ void Pipeline::Clear() {
 	}
 	m_dependencyGraph.clear();
 	m_taskGraph.clear();
+	m_taskWrappers.clear();
+	m_schedule = {};
+	m_constantNodes.clear();
+	m_compilationReport = {};
+}
+
+
+void Pipeline::ApplyConstants() {
+	// Outputs are forwarded to the linked inputs, including those of following folded nodes.
+	for (auto& node : m_constantNodes) {
+		node->Update();
+	}
 }
 
 
@@ -545,42 +584,163 @@ void Pipeline::CalculateDependencyGraph() {
 		m_dependencyGraph.erase(deleteMe);
 	}
 
+	std::vector<lemon::ListDigraph::Node> graphNodes;
+	std::vector<NodeBase*> nodes;
+	for (lemon::ListDigraph::NodeIt it(m_dependencyGraph); it != lemon::INVALID; ++it) {
+		graphNodes.push_back(it);
+		nodes.push_back(m_nodeMap[it].get());
+	}
+
 	// Add all arcs to the graph accoring to inputPort->outputPort linkage
-	// sidenote: the algorithm will not create duplicate arcs in the graph
-	for (lemon::ListDigraph::NodeIt outerIt(m_dependencyGraph); outerIt != lemon::INVALID; ++outerIt) {
-		for (auto innerIt = ++lemon::ListDigraph::NodeIt(outerIt); innerIt != lemon::INVALID; ++innerIt) {
-			NodeBase* srcNode = m_nodeMap[outerIt].get();
-			NodeBase* dstNode = m_nodeMap[innerIt].get();
-
-			// Check if there's ANY link going in ANY direction b/w above nodes
-			// FIRST direction
-			if (IsLinked(srcNode, dstNode)) {
-				// a link from srcNode to dstNode was found, add an arc
-				m_dependencyGraph.addArc(outerIt, innerIt);
+	// sidenote: the links come without duplicates
+	for (auto [src, dst] : GetNodeLinks(nodes)) {
+		m_dependencyGraph.addArc(graphNodes[src], graphNodes[dst]);
+	}
+}
+
+
+void Pipeline::CompileNodes(std::vector<std::shared_ptr<NodeBase>>& nodes) {
+	m_constantNodes.clear();
+	m_compilationReport = {};
+	m_compilationReport.numNodes = nodes.size();
+
+	std::vector<NodeBase*> nodePtrs;
+	for (auto& node : nodes) {
+		nodePtrs.push_back(node.get());
+	}
+
+	std::vector<std::vector<size_t>> predecessors(nodes.size());
+	std::vector<std::vector<size_t>> successors(nodes.size());
+	for (auto [src, dst] : GetNodeLinks(nodePtrs)) {
+		successors[src].push_back(dst);
+		predecessors[dst].push_back(src);
+	}
+
+	// Graphics nodes with no linked outputs are the sinks, everything that leads to them is alive.
+	std::vector<bool> isAlive(nodes.size(), false);
+	std::vector<size_t> stack;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (successors[i].empty() && dynamic_cast<GraphicsNode*>(nodePtrs[i]) != nullptr) {
+			isAlive[i] = true;
+			stack.push_back(i);
+		}
+	}
+	while (!stack.empty()) {
+		size_t node = stack.back();
+		stack.pop_back();
+		for (size_t predecessor : predecessors[node]) {
+			if (!isAlive[predecessor]) {
+				isAlive[predecessor] = true;
+				stack.push_back(predecessor);
 			}
+		}
+	}
 
-			// REVERSE direction; FLIP nodes
-			if (IsLinked(dstNode, srcNode)) {
-				// a link from dstNode to srcNode was found, add an arc
-				m_dependencyGraph.addArc(innerIt, outerIt);
+	// Visit the nodes in topological order. Nodes on a cycle are never visited,
+	// those are left for the DAG check of the task graph to report.
+	std::vector<size_t> numPendingPredecessors(nodes.size());
+	std::vector<size_t> order;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		numPendingPredecessors[i] = predecessors[i].size();
+		if (isAlive[i] && numPendingPredecessors[i] == 0) {
+			order.push_back(i);
+		}
+	}
+	for (size_t visited = 0; visited < order.size(); ++visited) {
+		for (size_t successor : successors[order[visited]]) {
+			if (--numPendingPredecessors[successor] == 0 && isAlive[successor]) {
+				order.push_back(successor);
 			}
 		}
 	}
+
+	// CPU nodes are pure functions of their inputs: if those are all static, so are the outputs.
+	// Evaluating them now sets the outputs on the linked inputs for good.
+	std::vector<bool> isConstant(nodes.size(), false);
+	for (size_t node : order) {
+		isConstant[node] = dynamic_cast<GraphicsNode*>(nodePtrs[node]) == nullptr
+			&& std::all_of(predecessors[node].begin(), predecessors[node].end(), [&isConstant](size_t predecessor) {
+				return isConstant[predecessor];
+			});
+		if (isConstant[node]) {
+			nodePtrs[node]->Update();
+			m_constantNodes.push_back(nodes[node]);
+			m_compilationReport.foldedNodes.push_back(GetNodeDescription(*nodePtrs[node]));
+		}
+	}
+
+	// Dropped nodes unlink themselves when destroyed.
+	std::vector<std::shared_ptr<NodeBase>> compiledNodes;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		if (!isAlive[i]) {
+			m_compilationReport.prunedNodes.push_back(GetNodeDescription(*nodePtrs[i]));
+		}
+		else if (!isConstant[i]) {
+			compiledNodes.push_back(std::move(nodes[i]));
+		}
+	}
+	nodes = std::move(compiledNodes);
 }
 
 
-bool Pipeline::IsLinked(NodeBase* srcNode, NodeBase* dstNode) {
-	for (size_t dstIn = 0; dstIn < dstNode->GetNumInputs(); dstIn++) {
-		OutputPortBase* linked = dstNode->GetInput(dstIn)->GetLink();
-		for (size_t srcOut = 0; srcOut < srcNode->GetNumOutputs(); srcOut++) {
-			if (linked == srcNode->GetOutput(srcOut)) {
-				// a link from srcNode to dstNode was found!
-				return true;
+void Pipeline::CalculateSchedule() {
+	m_schedule = {};
+
+	// Topologically sort the tasks.
+	lemon::ListDigraph::NodeMap<int> taskOrderMap(m_taskGraph);
+	bool isSortable = lemon::checkedTopologicalSort(m_taskGraph, taskOrderMap);
+	assert(isSortable);
+
+	std::vector<lemon::ListDigraph::Node> taskNodes(lemon::countNodes(m_taskGraph));
+	for (lemon::ListDigraph::NodeIt taskNode(m_taskGraph); taskNode != lemon::INVALID; ++taskNode) {
+		taskNodes[taskOrderMap[taskNode]] = taskNode;
+	}
+
+	// Assign each task the length of the longest dependency chain leading to it.
+	lemon::ListDigraph::NodeMap<unsigned> levelMap(m_taskGraph, 0);
+	unsigned numLevels = 0;
+	for (auto node : taskNodes) {
+		for (lemon::ListDigraph::InArcIt arc(m_taskGraph, node); arc != lemon::INVALID; ++arc) {
+			unsigned predecessorLevel = levelMap[m_taskGraph.source(arc)];
+			if (predecessorLevel + 1 > levelMap[node]) {
+				levelMap[node] = predecessorLevel + 1;
 			}
 		}
+		if (levelMap[node] + 1 > numLevels) {
+			numLevels = levelMap[node] + 1;
+		}
+	}
+
+	// Ordering by level is also a valid topological order, and keeps independent tasks together.
+	std::stable_sort(taskNodes.begin(), taskNodes.end(), [&](auto n1, auto n2) {
+		return levelMap[n1] < levelMap[n2];
+	});
+
+	lemon::ListDigraph::NodeMap<unsigned> scheduleIndexMap(m_taskGraph);
+	for (size_t i = 0; i < taskNodes.size(); ++i) {
+		scheduleIndexMap[taskNodes[i]] = (unsigned)i;
+	}
+
+	// Flatten tasks and their successors into arrays.
+	m_schedule.tasks.reserve(taskNodes.size());
+	m_schedule.successors.reserve(lemon::countArcs(m_taskGraph));
+	m_schedule.levelOffsets.assign(numLevels + 1, 0);
+	for (auto node : taskNodes) {
+		ScheduledTask scheduled;
+		scheduled.task = m_taskFunctionMap[node];
+		scheduled.level = levelMap[node];
+		scheduled.numPredecessors = (unsigned)lemon::countInArcs(m_taskGraph, node);
+		scheduled.firstSuccessor = (unsigned)m_schedule.successors.size();
+		for (lemon::ListDigraph::OutArcIt arc(m_taskGraph, node); arc != lemon::INVALID; ++arc) {
+			m_schedule.successors.push_back(scheduleIndexMap[m_taskGraph.target(arc)]);
+		}
+		scheduled.numSuccessors = (unsigned)m_schedule.successors.size() - scheduled.firstSuccessor;
+		m_schedule.tasks.push_back(scheduled);
+		++m_schedule.levelOffsets[scheduled.level + 1];
+	}
+	for (size_t i = 1; i < m_schedule.levelOffsets.size(); ++i) {
+		m_schedule.levelOffsets[i] += m_schedule.levelOffsets[i - 1];
 	}
-	// no link found
-	return false;
 }
 
 
@@ -602,6 +762,14 @@ const lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt>& Pipeline::GetTask
 	return m_taskParentMap;
 }
 
+const Pipeline::Schedule& Pipeline::GetSchedule() const {
+	return m_schedule;
+}
+
+const Pipeline::CompilationReport& Pipeline::GetCompilationReport() const {
+	return m_compilationReport;
+}
+
 
 
 
@@ -740,6 +908,41 @@ static StringErrorPosition GetStringErrorPosition(const std::string& str, size_t
 }
 
 
+static std::vector<std::pair<size_t, size_t>> GetNodeLinks(const std::vector<NodeBase*>& nodes) {
+	// Look up the owner of each linked output instead of comparing all pairs of nodes.
+	std::unordered_map<const OutputPortBase*, size_t> outputOwners;
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		for (size_t port = 0; port < nodes[i]->GetNumOutputs(); ++port) {
+			outputOwners.insert({ nodes[i]->GetOutput(port), i });
+		}
+	}
+
+	// {source, target} indices, one for each pair of linked nodes
+	std::vector<std::pair<size_t, size_t>> links;
+	for (size_t dst = 0; dst < nodes.size(); ++dst) {
+		size_t firstLinkOfNode = links.size();
+		for (size_t port = 0; port < nodes[dst]->GetNumInputs(); ++port) {
+			auto it = outputOwners.find(nodes[dst]->GetInput(port)->GetLink());
+			if (it == outputOwners.end() || it->second == dst) {
+				continue;
+			}
+			// A node has only a few inputs, duplicates are searched among its own links.
+			std::pair<size_t, size_t> link{ it->second, dst };
+			if (std::find(links.begin() + firstLinkOfNode, links.end(), link) == links.end()) {
+				links.push_back(link);
+			}
+		}
+	}
+
+	return links;
+}
+
+
+static std::string GetNodeDescription(const NodeBase& node) {
+	return node.GetDisplayName().empty() ? node.GetClassName(true) : node.GetDisplayName();
+}
+
+
 static std::string SerializeNodesAndLinks(std::vector<NodeCreationInfo> nodes, std::vector<LinkCreationInfo> links) {
 	std::stable_sort(nodes.begin(), nodes.end(), [](const NodeCreationInfo& lhs, const NodeCreationInfo& rhs) {
 		return lhs.cl < rhs.cl;
@@ -73,6 +73,34 @@ public:
 		NodeBase* m_subject;
 	};
 
+	/// <summary> A task of the flattened task graph. </summary>
+	struct ScheduledTask {
+		GraphicsTask* task; /// <summary> Null for auxiliary tasks that do nothing. </summary>
+		unsigned level; /// <summary> Length of the longest dependency chain leading to this task. </summary>
+		unsigned numPredecessors;
+		unsigned firstSuccessor; /// <summary> Index of the first successor in <see cref="Schedule::successors"/>. </summary>
+		unsigned numSuccessors;
+	};
+
+	/// <summary>
+	/// The task graph compiled into a flat array, ordered by dependency level.
+	/// Tasks on the same level never depend on each other.
+	/// </summary>
+	/// <remarks> Only recomputed when the pipeline's graphs change. </remarks>
+	struct Schedule {
+		std::vector<ScheduledTask> tasks;
+		std::vector<unsigned> successors; /// <summary> Schedule indices of successors, grouped by task. </summary>
+		std::vector<unsigned> levelOffsets; /// <summary> Index of the first task on each level, plus the number of tasks. </summary>
+	};
+
+	/// <summary> What the compilation of a JSON description did to its nodes. </summary>
+	struct CompilationReport {
+		size_t numNodes = 0; /// <summary> Nodes in the description. </summary>
+		std::vector<std::string> prunedNodes; /// <summary> Nodes whose outputs reach no sink, dropped from the pipeline. </summary>
+		std::vector<std::string> foldedNodes; /// <summary> CPU nodes with static inputs, evaluated once instead of every frame. </summary>
+		size_t numTasks = 0; /// <summary> Tasks in the schedule. </summary>
+	};
+
 public:
 	Pipeline();
 	Pipeline(const Pipeline&) = delete;
@@ -81,11 +109,21 @@ public:
 	Pipeline& operator=(Pipeline&&);
 	~Pipeline();
 
+	/// <summary> Creates the nodes of the description, and compiles them into a pipeline. </summary>
+	/// <remarks>
+	/// Graphics nodes whose outputs are not linked are the sinks of the pipeline, they are there for their
+	/// side effects, like drawing to the back buffer. Nodes that don't feed a sink are dropped.
+	/// CPU nodes whose inputs are all static are evaluated once and removed from the task graph.
+	/// </remarks>
 	void CreateFromDescription(const std::string& jsonDescription, GraphicsNodeFactory& factory);
 	void CreateFromNodesList(const std::vector<std::shared_ptr<NodeBase>> nodes);
 	std::string SerializeToJSON(const NodeFactory& factory) const;
 	void Clear();
 
+	/// <summary> Sets the outputs of the folded CPU nodes again. Call it after the nodes' inputs were cleared. </summary>
+	void ApplyConstants();
+	const CompilationReport& GetCompilationReport() const;
+
 	NodeIterator begin();
 	NodeIterator end();
 	ConstNodeIterator begin() const;
@@ -98,6 +136,7 @@ public:
 	const lemon::ListDigraph& GetTaskGraph() const;
 	const lemon::ListDigraph::NodeMap<GraphicsTask*>& GetTaskFunctionMap() const;
 	const lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt>& GetTaskParentMap() const;
+	const Schedule& GetSchedule() const;
 
 	template <class T>
 	void AddNodeMetaData() = delete;
@@ -107,7 +146,10 @@ public:
 private:
 	void CalculateTaskGraph();
 	void CalculateDependencyGraph();
-	bool IsLinked(NodeBase* srcNode, NodeBase* dstNode);
+	void CalculateSchedule();
+
+	/// <summary> Drops the dead nodes from <paramref name="nodes"/>, and folds the constant ones. </summary>
+	void CompileNodes(std::vector<std::shared_ptr<NodeBase>>& nodes);
 
 
 	lemon::ListDigraph m_dependencyGraph;
@@ -117,6 +159,10 @@ private:
 	lemon::ListDigraph::NodeMap<lemon::ListDigraph::NodeIt> m_taskParentMap;
 
 	std::vector<std::unique_ptr<SimpleNodeTask>> m_taskWrappers;
+	Schedule m_schedule;
+
+	std::vector<std::shared_ptr<NodeBase>> m_constantNodes; // folded, not part of the graphs, in evaluation order
+	CompilationReport m_compilationReport;
 };
 
 
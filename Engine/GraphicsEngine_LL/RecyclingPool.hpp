@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Usage counters of an object pool, to see how large it grows and why. </summary>
+struct PoolStatistics {
+	size_t numObjects = 0; /// <summary> Objects created so far, free or in use. </summary>
+	size_t numInUse = 0;
+	size_t highWatermark = 0; /// <summary> The most objects that were in use at once. </summary>
+	size_t numRequests = 0;
+};
+
+
+namespace impl {
+
+/// <summary>
+/// Owns objects that are expensive to create and hands them out again once they are recycled.
+/// <para/>
+/// Each thread keeps a few free objects of its own, so that requesting and recycling normally
+/// don't lock. Free objects move between a thread and the shared list in batches.
+/// Free lists store the objects' addresses, recycling needs no lookup.
+/// </summary>
+/// <remarks> Objects are destroyed with the pool, all of them must have been recycled by then. </remarks>
+template <class T>
+class RecyclingPool {
+public:
+	RecyclingPool() : m_id(++idCounter) {}
+	RecyclingPool(const RecyclingPool&) = delete;
+	RecyclingPool& operator=(const RecyclingPool&) = delete;
+
+	/// <summary> Returns a free object, or one made by <paramref name="create"/> if there is none. </summary>
+	template <class CreateFunc>
+	T* Request(CreateFunc&& create);
+
+	void Recycle(T* object);
+
+	/// <summary> Destroys all objects. </summary>
+	/// <remarks> Objects still cached by threads are forgotten, not handed out again. </remarks>
+	void Clear();
+
+	PoolStatistics GetStatistics() const;
+private:
+	struct ThreadCache {
+		uint64_t poolId;
+		std::vector<T*> objects;
+	};
+
+	std::vector<T*>& GetThreadCache();
+
+	static constexpr size_t THREAD_CACHE_SIZE = 16;
+	static inline std::atomic_uint64_t idCounter = 0;
+private:
+	std::atomic_uint64_t m_id; // threads' cached objects belong to the pool of this id
+	std::vector<std::unique_ptr<T>> m_objects;
+	std::vector<T*> m_freeObjects; // shared by threads
+	mutable std::mutex m_mutex;
+
+	std::atomic_size_t m_numInUse = 0;
+	std::atomic_size_t m_highWatermark = 0;
+	std::atomic_size_t m_numRequests = 0;
+};
+
+
+
+template <class T>
+template <class CreateFunc>
+T* RecyclingPool<T>::Request(CreateFunc&& create) {
+	std::vector<T*>& cache = GetThreadCache();
+
+	if (cache.empty()) {
+		std::lock_guard<std::mutex> lkg(m_mutex);
+
+		size_t count = std::min(m_freeObjects.size(), THREAD_CACHE_SIZE / 2);
+		cache.insert(cache.end(), m_freeObjects.end() - count, m_freeObjects.end());
+		m_freeObjects.resize(m_freeObjects.size() - count);
+
+		if (cache.empty()) {
+			std::unique_ptr<T> object(create());
+			cache.push_back(object.get());
+			m_objects.push_back(std::move(object));
+		}
+	}
+
+	T* object = cache.back();
+	cache.pop_back();
+
+	++m_numRequests;
+	size_t numInUse = ++m_numInUse;
+	size_t highWatermark = m_highWatermark.load(std::memory_order_relaxed);
+	while (numInUse > highWatermark && !m_highWatermark.compare_exchange_weak(highWatermark, numInUse, std::memory_order_relaxed)) {}
+
+	return object;
+}
+
+
+template <class T>
+void RecyclingPool<T>::Recycle(T* object) {
+	std::vector<T*>& cache = GetThreadCache();
+
+	cache.push_back(object);
+	--m_numInUse;
+
+	// Threads that only recycle hand the objects over to the requesting ones.
+	// Half is kept so that alternating requests and recycles don't lock each time.
+	if (cache.size() > THREAD_CACHE_SIZE) {
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		m_freeObjects.insert(m_freeObjects.end(), cache.begin() + THREAD_CACHE_SIZE / 2, cache.end());
+		cache.resize(THREAD_CACHE_SIZE / 2);
+	}
+}
+
+
+template <class T>
+void RecyclingPool<T>::Clear() {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_id = ++idCounter;
+	m_freeObjects.clear();
+	m_objects.clear();
+	m_numInUse = 0;
+}
+
+
+template <class T>
+PoolStatistics RecyclingPool<T>::GetStatistics() const {
+	PoolStatistics statistics;
+	{
+		std::lock_guard<std::mutex> lkg(m_mutex);
+		statistics.numObjects = m_objects.size();
+	}
+	statistics.numInUse = m_numInUse;
+	statistics.highWatermark = m_highWatermark;
+	statistics.numRequests = m_numRequests;
+	return statistics;
+}
+
+
+template <class T>
+auto RecyclingPool<T>::GetThreadCache() -> std::vector<T*>& {
+	// A thread works with only a handful of pools, a linear search is fine.
+	thread_local std::vector<ThreadCache> caches;
+
+	uint64_t id = m_id.load(std::memory_order_relaxed);
+	for (auto& cache : caches) {
+		if (cache.poolId == id) {
+			return cache.objects;
+		}
+	}
+	caches.push_back({ id, {} });
+	caches.back().objects.reserve(THREAD_CACHE_SIZE + 1);
+	return caches.back().objects;
+}
+
+} // namespace impl
+
+
+} // namespace inl::gxeng
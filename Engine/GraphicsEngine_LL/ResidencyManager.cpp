@@ -0,0 +1,264 @@
+#include "ResidencyManager.hpp"
+
+#include <BaseLibrary/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+
+namespace inl::gxeng {
+
+
+
+ResidencyManager::ResidencyManager(gxapi::IGraphicsApi* graphicsApi)
+	: m_graphicsApi(graphicsApi)
+{
+	RefreshBudget();
+}
+
+
+void ResidencyManager::SetBudget(uint64_t bytes) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_budgetOverride = bytes;
+	RefreshBudget();
+	MakeRoom(0);
+}
+
+
+uint64_t ResidencyManager::GetBudget() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_budget;
+}
+
+
+void ResidencyManager::Register(gxapi::IResource* resource, uint64_t sizeInBytes, bool pinned) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	// The resource is already resident, but the space still has to come from somewhere.
+	MakeRoom(sizeInBytes);
+
+	ResourceInfo info;
+	info.size = sizeInBytes;
+	info.pinned = pinned;
+	if (!pinned) {
+		info.lruPosition = m_lru.insert(m_lru.begin(), resource); // never used, first to go
+	}
+	bool inserted = m_resources.insert({ resource, info }).second;
+	assert(inserted);
+
+	m_residentBytes += sizeInBytes;
+	if (pinned) {
+		m_pinnedBytes += sizeInBytes;
+	}
+}
+
+
+void ResidencyManager::Unregister(gxapi::IResource* resource) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	auto it = m_resources.find(resource);
+	if (it == m_resources.end()) {
+		return;
+	}
+	if (it->second.resident) {
+		if (!it->second.pinned) {
+			m_lru.erase(it->second.lruPosition);
+		}
+		else {
+			m_pinnedBytes -= it->second.size;
+		}
+		m_residentBytes -= it->second.size;
+	}
+	m_resources.erase(it);
+}
+
+
+void ResidencyManager::Prefetch(const std::vector<gxapi::IResource*>& resources) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	std::vector<gxapi::IResource*> missing;
+	uint64_t missingSize = 0;
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_resources.find(resource);
+		if (it != m_resources.end() && !it->second.resident && FitsBudget(missingSize + it->second.size)) {
+			missing.push_back(resource);
+			missingSize += it->second.size;
+		}
+	}
+	if (missing.empty()) {
+		return;
+	}
+
+	try {
+		MakeResident(missing, missingSize);
+		m_statistics.prefetched += missing.size();
+	}
+	catch (OutOfMemoryException&) {
+		// The budget is larger than the memory, the resources will be paged in when actually used.
+	}
+}
+
+
+void ResidencyManager::Lock(const std::vector<gxapi::IResource*>& resources) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	// Lock first, so that making room for the missing ones doesn't evict the rest of the same request.
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_resources.find(resource);
+		if (it != m_resources.end()) {
+			++it->second.lockCount;
+		}
+	}
+
+	std::vector<gxapi::IResource*> missing;
+	uint64_t missingSize = 0;
+	Touch(resources, missing, missingSize);
+	if (!missing.empty()) {
+		try {
+			MakeRoom(missingSize);
+			MakeResident(missing, missingSize);
+		}
+		catch (...) {
+			for (gxapi::IResource* resource : resources) {
+				auto it = m_resources.find(resource);
+				if (it != m_resources.end()) {
+					--it->second.lockCount;
+				}
+			}
+			throw;
+		}
+		m_statistics.madeResident += missing.size();
+	}
+}
+
+
+void ResidencyManager::Unlock(const std::vector<gxapi::IResource*>& resources) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_resources.find(resource);
+		if (it != m_resources.end() && it->second.lockCount > 0) {
+			--it->second.lockCount;
+		}
+	}
+}
+
+
+ResidencyStatistics ResidencyManager::GetStatistics() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	ResidencyStatistics statistics = m_statistics;
+	statistics.residentBytes = m_residentBytes;
+	statistics.pinnedBytes = m_pinnedBytes;
+	statistics.budget = m_budget;
+	return statistics;
+}
+
+
+void ResidencyManager::OnFrameBeginHost(uint64_t frameId) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_currentFrame = frameId + 1; // 0 is reserved for resources never used
+
+	if (m_graphicsApi->PollVideoMemoryBudgetChange() && m_budgetOverride == 0) {
+		RefreshBudget();
+		MakeRoom(0);
+	}
+}
+
+
+void ResidencyManager::Touch(const std::vector<gxapi::IResource*>& resources, std::vector<gxapi::IResource*>& missing, uint64_t& missingSize) {
+	for (gxapi::IResource* resource : resources) {
+		auto it = m_resources.find(resource);
+		if (it == m_resources.end()) {
+			continue;
+		}
+
+		ResourceInfo& info = it->second;
+		if (info.resident) {
+			if (!info.pinned && info.lastUsedFrame != m_currentFrame) {
+				m_lru.splice(m_lru.end(), m_lru, info.lruPosition);
+			}
+		}
+		else if (std::find(missing.begin(), missing.end(), resource) == missing.end()) {
+			missing.push_back(resource);
+			missingSize += info.size;
+		}
+		info.lastUsedFrame = m_currentFrame;
+	}
+}
+
+
+void ResidencyManager::MakeRoom(uint64_t size) {
+	const bool evictAll = size == EVICT_ALL;
+	if (!evictAll && FitsBudget(size)) {
+		return;
+	}
+
+	m_evictList.clear();
+	auto it = m_lru.begin();
+	while (it != m_lru.end() && (evictAll || !FitsBudget(size))) {
+		gxapi::IResource* resource = *it;
+		ResourceInfo& info = m_resources.at(resource);
+		++it;
+
+		if (info.lockCount == 0) {
+			EvictResource(resource, info);
+		}
+	}
+
+	if (!m_evictList.empty()) {
+		m_graphicsApi->Evict(m_evictList);
+	}
+}
+
+
+void ResidencyManager::EvictResource(gxapi::IResource* resource, ResourceInfo& info) {
+	m_lru.erase(info.lruPosition);
+	info.resident = false;
+	m_residentBytes -= info.size;
+	m_evictList.push_back(resource);
+
+	++m_statistics.evicted;
+	m_statistics.bytesEvicted += info.size;
+}
+
+
+void ResidencyManager::MakeResident(const std::vector<gxapi::IResource*>& resources, uint64_t size) {
+	try {
+		m_graphicsApi->MakeResident(resources);
+	}
+	catch (OutOfMemoryException&) {
+		// The budget is too large for the actual memory, free whatever is possible and try once more.
+		MakeRoom(EVICT_ALL);
+		m_graphicsApi->MakeResident(resources);
+	}
+
+	for (gxapi::IResource* resource : resources) {
+		ResourceInfo& info = m_resources.at(resource);
+		info.resident = true;
+		info.lastUsedFrame = m_currentFrame; // keeps the list ordered by last use
+		info.lruPosition = m_lru.insert(m_lru.end(), resource);
+	}
+	m_residentBytes += size;
+	m_statistics.bytesMadeResident += size;
+}
+
+
+bool ResidencyManager::FitsBudget(uint64_t size) const {
+	return m_budget == 0 || (size <= m_budget && m_residentBytes <= m_budget - size);
+}
+
+
+void ResidencyManager::RefreshBudget() {
+	if (m_budgetOverride != 0) {
+		m_budget = m_budgetOverride;
+		return;
+	}
+
+	uint64_t deviceBudget = m_graphicsApi->GetVideoMemoryInfo().budget;
+	m_budget = deviceBudget - deviceBudget / BUDGET_MARGIN_DIVISOR;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "PipelineEventListener.hpp"
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IResource.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl::gxeng {
+
+
+/// <summary> Counts of resources moved in and out of video memory, cumulative since the start. </summary>
+/// <remarks> Take the difference of two snapshots to get the churn of a frame. </remarks>
+struct ResidencyStatistics {
+	size_t madeResident = 0; /// <summary> Evicted resources made resident again because they were used. </summary>
+	size_t prefetched = 0; /// <summary> Evicted resources made resident again ahead of use. </summary>
+	size_t evicted = 0;
+	uint64_t bytesMadeResident = 0; /// <summary> Includes prefetched bytes. </summary>
+	uint64_t bytesEvicted = 0;
+	uint64_t residentBytes = 0; /// <summary> Size of the tracked resources currently resident. </summary>
+	uint64_t pinnedBytes = 0; /// <summary> Part of the resident bytes that can't be evicted. </summary>
+	uint64_t budget = 0;
+};
+
+
+/// <summary>
+/// Keeps the resident resources within a memory budget.
+/// <para/>
+/// Each resource remembers the last frame it was used in. When a resource has to be made resident
+/// and the budget is exceeded, the least recently used resources are evicted, but only as many as
+/// needed to fit. Resources of command lists in flight are locked, those are never evicted.
+/// </summary>
+/// <remarks>
+/// Resources are referred to by their low level pointer, the manager does not own them.
+/// They must be registered when created and unregistered before destroyed, the MemoryManager
+/// does this for the resources it allocates.
+/// <para/>
+/// Placed resources share their heap's residency, evicting one would page out all others in the heap.
+/// They are registered as pinned: they count against the budget, but are never evicted. New resources,
+/// pinned or not, make room for themselves by evicting the least recently used ones.
+/// <para/>
+/// The budget follows what the OS gives the process from the device's local memory, less a margin
+/// for the allocations not tracked here, such as the swap chain and descriptor heaps.
+/// </remarks>
+class ResidencyManager : public PipelineEventListener {
+public:
+	ResidencyManager(gxapi::IGraphicsApi* graphicsApi);
+
+	/// <summary> Overrides the number of bytes the resident resources may occupy.
+	///		Zero goes back to following the budget of the device. </summary>
+	/// <remarks> Lowering the budget evicts resources right away. </remarks>
+	void SetBudget(uint64_t bytes);
+	uint64_t GetBudget() const;
+
+	/// <summary> Starts tracking a newly created, resident resource. </summary>
+	/// <param name="pinned"> The resource stays resident, only its size is accounted for. </param>
+	void Register(gxapi::IResource* resource, uint64_t sizeInBytes, bool pinned = false);
+	void Unregister(gxapi::IResource* resource);
+
+	/// <summary> Marks the resources used in the current frame, makes those resident that were evicted,
+	///		and excludes them from eviction until unlocked. Locks nest. </summary>
+	/// <remarks> Untracked resources are ignored. </remarks>
+	/// <exception cref="OutOfMemoryException"> If the resources don't fit even after evicting all others. </exception>
+	void Lock(const std::vector<gxapi::IResource*>& resources);
+	void Unlock(const std::vector<gxapi::IResource*>& resources);
+
+	/// <summary> Makes the resources resident if they fit into the budget without evicting anything. </summary>
+	/// <remarks> Call with the resources expected in the next frame, so that they are not paged in while it is being submitted. </remarks>
+	void Prefetch(const std::vector<gxapi::IResource*>& resources);
+
+	ResidencyStatistics GetStatistics() const;
+
+	void OnFrameBeginDevice(uint64_t frameId) override {}
+	void OnFrameBeginHost(uint64_t frameId) override;
+	void OnFrameBeginAwait(uint64_t frameId) override {}
+	void OnFrameCompleteDevice(uint64_t frameId) override {}
+	void OnFrameCompleteHost(uint64_t frameId) override {}
+private:
+	struct ResourceInfo {
+		uint64_t size;
+		uint64_t lastUsedFrame = 0; // 0 if not used since created
+		unsigned lockCount = 0;
+		bool resident = true;
+		bool pinned = false;
+		std::list<gxapi::IResource*>::iterator lruPosition; // valid if resident and not pinned
+	};
+
+	/// <summary> Marks the resources used and collects the ones not resident. </summary>
+	void Touch(const std::vector<gxapi::IResource*>& resources, std::vector<gxapi::IResource*>& missing, uint64_t& missingSize);
+
+	/// <summary> Evicts least recently used resources until <paramref name="size"/> more bytes fit,
+	///		or all unlocked ones if size is EVICT_ALL. </summary>
+	/// <remarks> May fall short of the budget if the rest of the resources are locked. </remarks>
+	void MakeRoom(uint64_t size);
+	void EvictResource(gxapi::IResource* resource, ResourceInfo& info);
+	void MakeResident(const std::vector<gxapi::IResource*>& resources, uint64_t size);
+	bool FitsBudget(uint64_t size) const;
+	/// <summary> Sets the budget from the device's, unless overridden. Zero if the device doesn't report one. </summary>
+	void RefreshBudget();
+
+	static constexpr uint64_t EVICT_ALL = std::numeric_limits<uint64_t>::max();
+	static constexpr uint64_t BUDGET_MARGIN_DIVISOR = 8; // this fraction of the device's budget is left for untracked allocations
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<const gxapi::IResource*, ResourceInfo> m_resources;
+	std::list<gxapi::IResource*> m_lru; // resident resources except pinned ones, least recently used first
+
+	uint64_t m_budget = 0; // zero means no limit
+	uint64_t m_budgetOverride = 0;
+	uint64_t m_residentBytes = 0;
+	uint64_t m_pinnedBytes = 0;
+	uint64_t m_currentFrame = 0;
+	ResidencyStatistics m_statistics;
+
+	std::vector<gxapi::IResource*> m_evictList; // reused by MakeRoom
+};
+
+
+} // namespace inl::gxeng
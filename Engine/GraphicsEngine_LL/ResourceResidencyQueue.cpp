@@ -1,12 +1,56 @@
 #include "ResourceResidencyQueue.hpp"
 #include <BaseLibrary/ThreadName.hpp>
 
+#include <algorithm>
+
 namespace inl {
 namespace gxeng {
 
 
-ResourceResidencyQueue::ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence) 
-	: m_fence(std::move(fence)),
+ResourceResidencyQueue::TaskList::~TaskList() {
+	Task* task = m_head.exchange(nullptr);
+	while (task != nullptr) {
+		Task* next = task->next;
+		delete task;
+		task = next;
+	}
+}
+
+
+bool ResourceResidencyQueue::TaskList::Push(std::unique_ptr<Task> task) {
+	Task* newHead = task.release();
+	Task* head = m_head.load(std::memory_order_relaxed);
+	do {
+		newHead->next = head;
+	} while (!m_head.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+
+	return head == nullptr;
+}
+
+
+void ResourceResidencyQueue::TaskList::PopAll(std::vector<std::unique_ptr<Task>>& tasks) {
+	Task* task = m_head.exchange(nullptr, std::memory_order_acquire);
+
+	size_t first = tasks.size();
+	while (task != nullptr) {
+		Task* next = task->next;
+		task->next = nullptr;
+		tasks.emplace_back(task);
+		task = next;
+	}
+	std::reverse(tasks.begin() + first, tasks.end());
+}
+
+
+bool ResourceResidencyQueue::TaskList::IsEmpty() const {
+	return m_head.load(std::memory_order_acquire) == nullptr;
+}
+
+
+
+ResourceResidencyQueue::ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence, ResidencyManager* residencyManager)
+	: m_residencyManager(residencyManager),
+	m_fence(std::move(fence)),
 	m_fenceValue(0)
 {
 	m_fence->Signal(0);
@@ -18,10 +62,15 @@ ResourceResidencyQueue::ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fe
 
 ResourceResidencyQueue::~ResourceResidencyQueue() {
 	m_runThreads = false;
-	m_initCv.notify_all();
-	m_cleanCv.notify_all();
+	Notify(m_initMutex, m_initCv);
+	Notify(m_cleanMutex, m_cleanCv);
 	m_initThread.join();
 	m_cleanThread.join();
+
+	if (m_failed) {
+		// Release the GPU, or the command queues would wait forever when destroyed.
+		m_fence->Signal(m_fenceValue);
+	}
 }
 
 
@@ -35,41 +84,91 @@ const std::function<void()>& ResourceResidencyQueue::GetFailureHandler() const {
 }
 
 
-SyncPoint ResourceResidencyQueue::EnqueueInit(std::vector<MemoryObject> resources) {
-	++m_fenceValue;
-	SyncPoint syncPoint(m_fence, m_fenceValue);
+SyncPoint ResourceResidencyQueue::EnqueueInit(const std::vector<MemoryObject>& resources) {
+	ThrowIfFailed();
+
+	SyncPoint syncPoint(m_fence, ++m_fenceValue);
 
-	std::lock_guard<std::mutex> lkg(m_initMutex);
-	m_initQueue.push(std::make_unique<Task>(std::move(resources), syncPoint));
-	m_initCv.notify_one();
+	std::vector<MemoryObject> taskResources = AcquireResourceList();
+	taskResources.assign(resources.begin(), resources.end());
+
+	if (m_initTasks.Push(std::make_unique<Task>(std::move(taskResources), syncPoint))) {
+		Notify(m_initMutex, m_initCv);
+	}
 
 	return syncPoint;
 }
 
 
+void ResourceResidencyQueue::ThrowIfFailed() const {
+	if (m_failed) {
+		std::lock_guard<std::mutex> lkg(m_failureMutex);
+		std::rethrow_exception(m_failure);
+	}
+}
+
+
+void ResourceResidencyQueue::Wait(const SyncPoint& syncPoint) const {
+	assert((bool)syncPoint.m_fence);
+
+	// Fences can't be waited on together with a flag, poll the flag every now and then.
+	constexpr uint64_t pollIntervalMillis = 50;
+	while (syncPoint.m_fence->Fetch() < syncPoint.m_value) {
+		ThrowIfFailed();
+		syncPoint.m_fence->Wait(syncPoint.m_value, pollIntervalMillis);
+	}
+}
+
+
+std::vector<MemoryObject> ResourceResidencyQueue::AcquireResourceList() {
+	std::lock_guard<std::mutex> lkg(m_recycleMutex);
+	if (m_recycledLists.empty()) {
+		return {};
+	}
+	std::vector<MemoryObject> resources = std::move(m_recycledLists.back());
+	m_recycledLists.pop_back();
+	return resources;
+}
+
+
 void ResourceResidencyQueue::InitThreadFunc() {
 	SetCurrentThreadName("CommandList Init Thread");
 
 	std::vector<std::unique_ptr<Task>> workingSet;
+	std::vector<gxapi::IResource*> resourcePtrs;
 	while (m_runThreads) {
-		std::unique_lock<std::mutex> lk(m_initMutex);
-		m_initCv.wait(lk, [this] {return !m_runThreads || !m_initQueue.empty(); });
-
-		while (!m_initQueue.empty()) {
-			std::unique_ptr<Task> task = std::move(m_initQueue.front());
-			workingSet.push_back(std::move(task));
-			m_initQueue.pop();
+		{
+			std::unique_lock<std::mutex> lk(m_initMutex);
+			m_initCv.wait(lk, [this] {return !m_runThreads || !m_initTasks.IsEmpty(); });
 		}
-		lk.unlock();
+
+		m_initTasks.PopAll(workingSet);
 
 		for (auto& task : workingSet) {
-			for (const MemoryObject& res : task->resources) {
-				// TODO...
+			// The fence is signaled in order, nothing after a failed init could run anyway.
+			if (!m_failed) {
+				GetResourcePtrs(task->resources, resourcePtrs);
+				try {
+					m_residencyManager->Lock(resourcePtrs);
+					m_initDoneValues.push_back(task->syncPoint.m_value);
+				}
+				catch (...) {
+					{
+						std::lock_guard<std::mutex> lkg(m_failureMutex);
+						m_failure = std::current_exception();
+					}
+					m_failed = true;
+					if (m_failureHandler) {
+						m_failureHandler();
+					}
+				}
 			}
-			task->syncPoint.m_fence->Signal(task->syncPoint.m_value);
+			RecycleResourceList(std::move(task->resources));
 		}
-
 		workingSet.clear();
+
+		// A single signal releases the GPU for the whole batch.
+		SignalInitDone();
 	}
 }
 
@@ -77,29 +176,103 @@ void ResourceResidencyQueue::InitThreadFunc() {
 void ResourceResidencyQueue::CleanThreadFunc() {
 	SetCurrentThreadName("CommandList Clean Thread");
 
-	std::vector<std::unique_ptr<Task>> workingSet;
+	std::vector<std::unique_ptr<Task>> pending;
 	while (m_runThreads) {
-		std::unique_lock<std::mutex> lk(m_cleanMutex);
-		m_cleanCv.wait(lk, [this] {return !m_runThreads || !m_cleanQueue.empty(); });
+		if (pending.empty()) {
+			std::unique_lock<std::mutex> lk(m_cleanMutex);
+			m_cleanCv.wait(lk, [this] {return !m_runThreads || !m_cleanTasks.IsEmpty(); });
+		}
 
-		while (!m_cleanQueue.empty()) {
-			std::unique_ptr<Task> task = std::move(m_cleanQueue.front());
-			workingSet.push_back(std::move(task));
-			m_cleanQueue.pop();
+		m_cleanTasks.PopAll(pending);
+		if (pending.empty()) {
+			continue;
 		}
-		lk.unlock();
 
-		for (auto& task : workingSet) {
-			task->syncPoint.m_fence->Wait(task->syncPoint.m_value);
-			for (const MemoryObject& res : task->resources) {
-				// TODO...
-			}
+		if (!RetireCompleted(pending)) {
+			// Sleep until the oldest task finishes, the ones after it are likely done by then as well.
+			const SyncPoint& oldest = pending.front()->syncPoint;
+			oldest.m_fence->Wait(oldest.m_value);
 		}
+	}
+}
 
-		workingSet.clear();
+
+void ResourceResidencyQueue::SignalInitDone() {
+	std::sort(m_initDoneValues.begin(), m_initDoneValues.end());
+
+	size_t numSignaled = 0;
+	while (numSignaled < m_initDoneValues.size() && m_initDoneValues[numSignaled] == m_initSignaledValue + 1) {
+		++m_initSignaledValue;
+		++numSignaled;
+	}
+	m_initDoneValues.erase(m_initDoneValues.begin(), m_initDoneValues.begin() + numSignaled);
+
+	if (numSignaled > 0) {
+		m_fence->Signal(m_initSignaledValue);
+	}
+}
+
+
+bool ResourceResidencyQueue::RetireCompleted(std::vector<std::unique_ptr<Task>>& pending) {
+	// Tasks are usually signaled by the same command queue, so this reads the fence only once.
+	const gxapi::IFence* fence = nullptr;
+	uint64_t completedValue = 0;
+
+	size_t numKept = 0;
+	for (auto& task : pending) {
+		if (task->syncPoint.m_fence.get() != fence) {
+			fence = task->syncPoint.m_fence.get();
+			completedValue = fence->Fetch();
+		}
+
+		if (task->syncPoint.m_value <= completedValue) {
+			GetResourcePtrs(task->resources, m_cleanResourcePtrs);
+			m_residencyManager->Unlock(m_cleanResourcePtrs);
+			RecycleResourceList(std::move(task->resources));
+			task.reset(); // clean objects are destroyed here
+		}
+		else {
+			pending[numKept++] = std::move(task);
+		}
+	}
+
+	bool anyRetired = numKept < pending.size();
+	pending.resize(numKept);
+	return anyRetired;
+}
+
+
+void ResourceResidencyQueue::RecycleResourceList(std::vector<MemoryObject> resources) {
+	resources.clear(); // may release the last reference, don't hold the lock meanwhile
+	if (resources.capacity() == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lkg(m_recycleMutex);
+	if (m_recycledLists.size() < MAX_RECYCLED_LISTS) {
+		m_recycledLists.push_back(std::move(resources));
+	}
+}
+
+
+void ResourceResidencyQueue::Notify(std::mutex& mutex, std::condition_variable& cv) {
+	// Taking the mutex makes sure the sleeper is either before checking its condition or already waiting.
+	{
+		std::lock_guard<std::mutex> lkg(mutex);
+	}
+	cv.notify_one();
+}
+
+
+void ResourceResidencyQueue::GetResourcePtrs(const std::vector<MemoryObject>& resources, std::vector<gxapi::IResource*>& resourcePtrs) {
+	resourcePtrs.clear();
+	for (const MemoryObject& resource : resources) {
+		if (resource.HasObject()) {
+			resourcePtrs.push_back(resource._GetResourcePtr());
+		}
 	}
 }
 
 
 } // namespace gxeng
-} // namespace inl
\ No newline at end of file
+} // namespace inl
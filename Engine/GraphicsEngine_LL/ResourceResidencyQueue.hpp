@@ -1,19 +1,25 @@
 #pragma once
 
 #include <mutex>
-#include <queue>
+#include <thread>
+#include <condition_variable>
 #include <functional>
+#include <vector>
 
 #include "SyncPoint.hpp"
 #include "CriticalBufferHeap.hpp"
 #include "CommandAllocatorPool.hpp"
+#include "ResidencyManager.hpp"
 #include <atomic>
+#include <exception>
 
 
 namespace inl {
 namespace gxeng {
 
 /// <summary> Manages initializing and cleanup of command lists. </summary>
+/// <remarks> Every submitted command list passes through here, so enqueueing never takes a lock:
+///			  tasks are pushed onto lock-free lists, and the worker threads take all of them at once. </remarks>
 class ResourceResidencyQueue {
 	struct Task {
 		Task() = default;
@@ -22,13 +28,33 @@ class ResourceResidencyQueue {
 		virtual ~Task() {};
 		std::vector<MemoryObject> resources;
 		SyncPoint syncPoint;
+		Task* next = nullptr; // link in a TaskList
+	};
+
+	/// <summary> Multiple producer, single consumer list of tasks. </summary>
+	class TaskList {
+	public:
+		TaskList() = default;
+		TaskList(const TaskList&) = delete;
+		TaskList& operator=(const TaskList&) = delete;
+		~TaskList();
+
+		/// <returns> True if the list was empty, the consumer may be sleeping then. </returns>
+		bool Push(std::unique_ptr<Task> task);
+		/// <summary> Appends all tasks to <paramref name="tasks"/> in the order they were pushed. </summary>
+		void PopAll(std::vector<std::unique_ptr<Task>>& tasks);
+		bool IsEmpty() const;
+	private:
+		std::atomic<Task*> m_head = nullptr; // most recently pushed first
 	};
 public:
-	ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence);
+	/// <param name="residencyManager"> Resources are locked resident in it while the command lists using them are in flight. </param>
+	ResourceResidencyQueue(std::unique_ptr<gxapi::IFence> fence, ResidencyManager* residencyManager);
 	~ResourceResidencyQueue();
 
 
 	/// <summary> The failure handler will be called if resources cannot be made resident, no matter how hard it tries. </summary>
+	/// <remarks> The failed init's sync point is never signaled, see <see cref="ThrowIfFailed"/>. </remarks>
 	/// <remarks> Note that the handler may be called from any thread. Be safe kids, use protection. </summary>
 	void SetFailureHandler(std::function<void()> handler);
 
@@ -41,7 +67,19 @@ public:
 	///			  returned sync point is signaled. </summary>
 	/// <param name="resources"> The resources to be made available resident on GPU memory. </param>
 	/// <returns> The SyncPoint returned will be signaled when the requested resources are all resident. </returns>
-	SyncPoint EnqueueInit(std::vector<MemoryObject> resources);
+	/// <remarks> The resources are copied into a recycled list. </remarks>
+	/// <exception> Rethrows the error of a previous init that failed, see <see cref="ThrowIfFailed"/>. </exception>
+	SyncPoint EnqueueInit(const std::vector<MemoryObject>& resources);
+
+	/// <summary> Rethrows the error of the first init that failed to make its resources resident. </summary>
+	/// <remarks> Neither that init's sync point nor any later one is signaled,
+	///			  the GPU work waiting on them and everything queued after it never runs. </remarks>
+	void ThrowIfFailed() const;
+
+	/// <summary> Blocks the calling thread until <paramref name="syncPoint"/> is signaled. </summary>
+	/// <remarks> Use instead of SyncPoint::Wait for points that come after GPU work waiting on an init. </remarks>
+	/// <exception> Rethrows the error of a failed init instead of waiting forever. </exception>
+	void Wait(const SyncPoint& syncPoint) const;
 
 	/// <summary> Enqueue a list of resources which should be marked as evictable. 
 	///			  Their memory may be made unresident if more space is needed on the GPU. </summary>
@@ -54,22 +92,46 @@ public:
 	template <class... CleanObjectT>
 	void EnqueueClean(SyncPoint waitFor, std::vector<MemoryObject> resources, CleanObjectT&&... cleanObjects);
 
+	/// <summary> Returns an empty list, reusing the memory of lists already cleaned up. </summary>
+	/// <remarks> Fill it with resources and pass it to EnqueueClean to avoid allocating each frame. </remarks>
+	std::vector<MemoryObject> AcquireResourceList();
+
 private:
 	void InitThreadFunc();
 	void CleanThreadFunc();
+
+	/// <summary> Signals the init fence up to the highest value whose preceding values are all done. </summary>
+	/// <remarks> Producers may push in a different order than they got their fence values. </remarks>
+	void SignalInitDone();
+	/// <summary> Unlocks and destroys the tasks whose sync point has passed, reading each fence once. </summary>
+	/// <returns> True if any task was retired. </returns>
+	bool RetireCompleted(std::vector<std::unique_ptr<Task>>& pending);
+	void RecycleResourceList(std::vector<MemoryObject> resources);
+
+	static void Notify(std::mutex& mutex, std::condition_variable& cv);
+	static void GetResourcePtrs(const std::vector<MemoryObject>& resources, std::vector<gxapi::IResource*>& resourcePtrs);
+
+	static constexpr size_t MAX_RECYCLED_LISTS = 64;
 	
 private:
 	// Init
-	std::mutex m_initMutex;
+	std::mutex m_initMutex; // only for sleeping
 	std::thread m_initThread;
 	std::condition_variable m_initCv;
-	std::queue<std::unique_ptr<Task>> m_initQueue;
+	TaskList m_initTasks;
+	std::vector<uint64_t> m_initDoneValues; // done out of order, waiting to be signaled
+	uint64_t m_initSignaledValue = 0;
 
 	// Clean
-	std::mutex m_cleanMutex;
+	std::mutex m_cleanMutex; // only for sleeping
 	std::thread m_cleanThread;
 	std::condition_variable m_cleanCv;
-	std::queue<std::unique_ptr<Task>> m_cleanQueue;
+	TaskList m_cleanTasks;
+	std::vector<gxapi::IResource*> m_cleanResourcePtrs;
+
+	// Recycled resource lists
+	std::mutex m_recycleMutex;
+	std::vector<std::vector<MemoryObject>> m_recycledLists;
 
 	// Thread run flag
 	std::atomic_bool m_runThreads;
@@ -77,10 +139,15 @@ private:
 	// Failure avoidance and handling
 	std::condition_variable m_retryCv;
 	std::function<void()> m_failureHandler;
+	mutable std::mutex m_failureMutex;
+	std::exception_ptr m_failure; // of the first init that failed
+	std::atomic_bool m_failed = false;
+
+	ResidencyManager* m_residencyManager;
 
 	// Event tracking
 	std::shared_ptr<gxapi::IFence> m_fence;
-	uint64_t m_fenceValue;
+	std::atomic_uint64_t m_fenceValue;
 };
 
 
@@ -93,9 +160,9 @@ inline void ResourceResidencyQueue::EnqueueClean(SyncPoint waitFor, std::vector<
 		std::tuple<CleanObjectT...> data;
  	};
 
-	std::lock_guard<std::mutex> lkg(m_cleanMutex);
-	m_cleanQueue.push(std::make_unique<SpecialTask>(std::move(resources), std::move(waitFor), std::forward<CleanObjectT>(cleanObjects)...));
-	m_cleanCv.notify_one();
+	if (m_cleanTasks.Push(std::make_unique<SpecialTask>(std::move(resources), std::move(waitFor), std::forward<CleanObjectT>(cleanObjects)...))) {
+		Notify(m_cleanMutex, m_cleanCv);
+	}
 }
 
 } // namespace gxeng
@@ -0,0 +1,185 @@
+#include "ResourceTransitionTracker.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+
+namespace inl::gxeng {
+
+
+namespace {
+
+// Buffers of destroyed trackers, waiting for the next command list recorded on any thread.
+struct RecycledBuffers {
+	std::mutex mutex;
+	std::vector<std::vector<ResourceUsage>> usages;
+	std::vector<std::vector<uint32_t>> tables;
+};
+
+RecycledBuffers& GetRecycledBuffers() {
+	static RecycledBuffers recycledBuffers;
+	return recycledBuffers;
+}
+
+constexpr size_t MAX_RECYCLED_BUFFERS = 64;
+constexpr size_t INITIAL_TABLE_SIZE = 64;
+
+} // namespace
+
+
+
+ResourceTransitionTracker::ResourceTransitionTracker() {
+	RecycledBuffers& recycledBuffers = GetRecycledBuffers();
+	std::lock_guard<std::mutex> lkg(recycledBuffers.mutex);
+
+	if (!recycledBuffers.usages.empty()) {
+		m_usages = std::move(recycledBuffers.usages.back());
+		recycledBuffers.usages.pop_back();
+	}
+	if (!recycledBuffers.tables.empty()) {
+		m_table = std::move(recycledBuffers.tables.back());
+		recycledBuffers.tables.pop_back();
+	}
+	assert(m_usages.empty());
+	assert(std::all_of(m_table.begin(), m_table.end(), [](uint32_t index) { return index == EMPTY; }));
+}
+
+
+ResourceTransitionTracker::ResourceTransitionTracker(ResourceTransitionTracker&& rhs) noexcept
+	: m_usages(std::move(rhs.m_usages)),
+	m_table(std::move(rhs.m_table))
+{
+	rhs.m_usages.clear();
+	rhs.m_table.clear();
+}
+
+
+ResourceTransitionTracker& ResourceTransitionTracker::operator=(ResourceTransitionTracker&& rhs) noexcept {
+	if (this != &rhs) {
+		Recycle();
+		m_usages = std::move(rhs.m_usages);
+		m_table = std::move(rhs.m_table);
+		rhs.m_usages.clear();
+		rhs.m_table.clear();
+	}
+	return *this;
+}
+
+
+ResourceTransitionTracker::~ResourceTransitionTracker() {
+	Recycle();
+}
+
+
+ResourceUsage* ResourceTransitionTracker::Find(const MemoryObject& resource, unsigned subresource) {
+	return const_cast<ResourceUsage*>(static_cast<const ResourceTransitionTracker*>(this)->Find(resource, subresource));
+}
+
+
+const ResourceUsage* ResourceTransitionTracker::Find(const MemoryObject& resource, unsigned subresource) const {
+	if (m_table.empty()) {
+		return nullptr;
+	}
+	uint32_t index = m_table[FindSlot(resource._GetResourcePtr(), subresource)];
+	return index != EMPTY ? &m_usages[index] : nullptr;
+}
+
+
+ResourceUsage& ResourceTransitionTracker::Insert(const MemoryObject& resource, unsigned subresource, gxapi::eResourceState state) {
+	// Keep the load factor under one half, probe sequences stay short.
+	if (m_table.empty()) {
+		Rehash(INITIAL_TABLE_SIZE);
+	}
+	else if ((m_usages.size() + 1) * 2 > m_table.size()) {
+		Rehash(m_table.size() * 2);
+	}
+
+	size_t slot = FindSlot(resource._GetResourcePtr(), subresource);
+	assert(m_table[slot] == EMPTY);
+
+	m_table[slot] = (uint32_t)m_usages.size();
+	m_usages.push_back(ResourceUsage{ resource, subresource, state, state, false });
+	return m_usages.back();
+}
+
+
+void ResourceTransitionTracker::Extract(std::vector<ResourceUsage>& usages) {
+	size_t first = usages.size();
+	usages.reserve(first + m_usages.size());
+	for (auto& usage : m_usages) {
+		usages.push_back(std::move(usage));
+	}
+
+	std::sort(usages.begin() + first, usages.end(), [](const ResourceUsage& lhs, const ResourceUsage& rhs) {
+		auto lhsPtr = lhs.resource._GetResourcePtr();
+		auto rhsPtr = rhs.resource._GetResourcePtr();
+		return lhsPtr < rhsPtr || (lhsPtr == rhsPtr && lhs.subresource < rhs.subresource);
+	});
+
+	Clear();
+}
+
+
+void ResourceTransitionTracker::Clear() {
+	m_usages.clear();
+	std::fill(m_table.begin(), m_table.end(), EMPTY);
+}
+
+
+size_t ResourceTransitionTracker::Hash(const gxapi::IResource* resource, unsigned subresource) {
+	uint64_t hash = (reinterpret_cast<uintptr_t>(resource) >> 4) * 0x9E3779B97F4A7C15ull + subresource;
+	return size_t(hash ^ (hash >> 29));
+}
+
+
+size_t ResourceTransitionTracker::FindSlot(const gxapi::IResource* resource, unsigned subresource) const {
+	assert(!m_table.empty());
+
+	// Linear probing, returns the slot of the subresource or the empty slot it would go into.
+	const size_t mask = m_table.size() - 1;
+	size_t slot = Hash(resource, subresource) & mask;
+	while (true) {
+		uint32_t index = m_table[slot];
+		if (index == EMPTY
+			|| (m_usages[index].subresource == subresource && m_usages[index].resource._GetResourcePtr() == resource))
+		{
+			return slot;
+		}
+		slot = (slot + 1) & mask;
+	}
+}
+
+
+void ResourceTransitionTracker::Rehash(size_t tableSize) {
+	assert((tableSize & (tableSize - 1)) == 0);
+
+	m_table.assign(tableSize, EMPTY);
+	for (size_t index = 0; index < m_usages.size(); ++index) {
+		const ResourceUsage& usage = m_usages[index];
+		m_table[FindSlot(usage.resource._GetResourcePtr(), usage.subresource)] = (uint32_t)index;
+	}
+}
+
+
+void ResourceTransitionTracker::Recycle() {
+	Clear();
+	if (m_usages.capacity() == 0 && m_table.capacity() == 0) {
+		return; // moved from
+	}
+
+	RecycledBuffers& recycledBuffers = GetRecycledBuffers();
+	std::lock_guard<std::mutex> lkg(recycledBuffers.mutex);
+
+	if (m_usages.capacity() > 0 && recycledBuffers.usages.size() < MAX_RECYCLED_BUFFERS) {
+		recycledBuffers.usages.push_back(std::move(m_usages));
+	}
+	if (m_table.capacity() > 0 && recycledBuffers.tables.size() < MAX_RECYCLED_BUFFERS) {
+		recycledBuffers.tables.push_back(std::move(m_table));
+	}
+	m_usages.clear();
+	m_table.clear();
+}
+
+
+} // namespace inl::gxeng
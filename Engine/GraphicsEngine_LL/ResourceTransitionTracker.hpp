@@ -0,0 +1,71 @@
+#pragma once
+
+#include "MemoryObject.hpp"
+
+#include "../GraphicsApi_LL/Common.hpp"
+
+#include <vector>
+#include <cstdint>
+
+
+namespace inl::gxeng {
+
+
+struct ResourceUsage {
+	MemoryObject resource;
+	unsigned subresource;
+	gxapi::eResourceState firstState; /// <summary> Holds the target state of the first transition. </summary>
+	gxapi::eResourceState lastState; /// <summary> Holds the target state of the last transition. </summary>
+	bool multipleStates; /// <summary> True if resource was used in more than one state. </summary>
+};
+
+
+/// <summary>
+/// Records the states a command list puts each subresource into.
+/// <para/>
+/// Usages are stored contiguously and found through an open addressing hash table of indices.
+/// The memory of both is kept when the tracker is emptied, and destroyed trackers hand it over
+/// to the next tracker created, so recording command lists doesn't allocate once the first few
+/// frames have warmed up the buffers. The buffers are pooled for all threads, command lists are
+/// recorded on worker threads but destroyed on the thread that submits them.
+/// </summary>
+class ResourceTransitionTracker {
+public:
+	ResourceTransitionTracker();
+	ResourceTransitionTracker(const ResourceTransitionTracker&) = delete;
+	ResourceTransitionTracker(ResourceTransitionTracker&& rhs) noexcept;
+	ResourceTransitionTracker& operator=(const ResourceTransitionTracker&) = delete;
+	ResourceTransitionTracker& operator=(ResourceTransitionTracker&& rhs) noexcept;
+	~ResourceTransitionTracker();
+
+	/// <summary> Returns the usage of the subresource, or null if the command list hasn't used it yet. </summary>
+	ResourceUsage* Find(const MemoryObject& resource, unsigned subresource);
+	const ResourceUsage* Find(const MemoryObject& resource, unsigned subresource) const;
+
+	/// <summary> Records the first use of a subresource. </summary>
+	/// <remarks> The subresource must not be in the tracker yet. </remarks>
+	ResourceUsage& Insert(const MemoryObject& resource, unsigned subresource, gxapi::eResourceState state);
+
+	size_t Size() const { return m_usages.size(); }
+
+	/// <summary> Moves the usages to the end of <paramref name="usages"/>, sorted by resource address and subresource,
+	///		and empties the tracker. </summary>
+	/// <remarks> The table is ordered by hash, the usages by first use, so they are sorted here. </remarks>
+	void Extract(std::vector<ResourceUsage>& usages);
+
+	/// <summary> Empties the tracker but keeps its memory. </summary>
+	void Clear();
+private:
+	static size_t Hash(const gxapi::IResource* resource, unsigned subresource);
+	size_t FindSlot(const gxapi::IResource* resource, unsigned subresource) const;
+	void Rehash(size_t tableSize);
+	void Recycle();
+private:
+	static constexpr uint32_t EMPTY = UINT32_MAX;
+
+	std::vector<ResourceUsage> m_usages;
+	std::vector<uint32_t> m_table; // indices into m_usages, size is a power of two
+};
+
+
+} // namespace inl::gxeng
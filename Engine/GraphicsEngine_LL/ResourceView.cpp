@@ -19,6 +19,7 @@ static std::vector<uint32_t> CalcSubresourceList(const Texture2D&, const gxapi::
 static std::vector<uint32_t> CalcSubresourceList(const Texture1D&, const gxapi::UavTexture1DArray&);
 static std::vector<uint32_t> CalcSubresourceList(const Texture2D&, const gxapi::UavTexture2DArray&);
 static std::vector<uint32_t> CalcSubresourceList(const Texture3D&, const gxapi::UavTexture3D&);
+static size_t CalcFirstElementInResource(const LinearBuffer&, size_t firstElement, unsigned stride, bool raw, gxapi::eFormat format);
 
 
 
@@ -188,6 +189,7 @@ BufferView::BufferView(
 	fullSrvDesc.format = format;
 	fullSrvDesc.dimension = gxapi::eSrvDimension::BUFFER;
 	fullSrvDesc.buffer = desc;
+	fullSrvDesc.buffer.firstElement = CalcFirstElementInResource(resource, desc.firstElement, desc.structureStrideInBytes, desc.isRaw, format);
 
 	heap.CreateSRV(GetResource(), fullSrvDesc, GetHandle());
 
@@ -209,6 +211,7 @@ BufferView::BufferView(
 	fullSrvDesc.format = format;
 	fullSrvDesc.dimension = gxapi::eSrvDimension::BUFFER;
 	fullSrvDesc.buffer = desc;
+	fullSrvDesc.buffer.firstElement = CalcFirstElementInResource(resource, desc.firstElement, desc.structureStrideInBytes, desc.isRaw, format);
 
 	gxapi->CreateShaderResourceView(GetResource()._GetResourcePtr(), fullSrvDesc, GetHandle());
 
@@ -461,6 +464,7 @@ RWBufferView::RWBufferView(const LinearBuffer& resource,
 	fullUavDesc.format = format;
 	fullUavDesc.dimension = gxapi::eUavDimension::BUFFER;
 	fullUavDesc.buffer = desc;
+	fullUavDesc.buffer.firstElement = (unsigned)CalcFirstElementInResource(resource, desc.firstElement, desc.elementStride, desc.raw, format);
 
 	heap.CreateUAV(GetResource(), fullUavDesc, GetHandle());
 }
@@ -478,6 +482,7 @@ RWBufferView::RWBufferView(const LinearBuffer& resource,
 	fullUavDesc.format = format;
 	fullUavDesc.dimension = gxapi::eUavDimension::BUFFER;
 	fullUavDesc.buffer = desc;
+	fullUavDesc.buffer.firstElement = (unsigned)CalcFirstElementInResource(resource, desc.firstElement, desc.elementStride, desc.raw, format);
 
 	gxapi->CreateUnorderedAccessView(GetResource()._GetResourcePtr(), fullUavDesc, GetHandle());
 
@@ -755,6 +760,13 @@ static std::vector<uint32_t> CalcSubresourceList(const Texture3D& obj, const gxa
 	return ret;
 }
 
+static size_t CalcFirstElementInResource(const LinearBuffer& buffer, size_t firstElement, unsigned stride, bool raw, gxapi::eFormat format) {
+	// Suballocated buffers start inside their resource, but views address the whole resource.
+	size_t elementSize = stride != 0 ? stride : (raw ? 4 : gxapi::GetFormatSizeInBytes(format));
+	assert(buffer.GetOffset() % elementSize == 0);
+	return firstElement + size_t(buffer.GetOffset() / elementSize);
+}
+
 
 } // namespace gxeng
 } // namespace inl
@@ -1,12 +1,16 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
 #include <utility>
 #include <cassert>
 #include <type_traits>
 #include <GraphicsApi_LL/ICommandList.hpp>
 #include "StackDescHeap.hpp"
 #include "Binder.hpp"
+#include "CommandListStatistics.hpp"
 
 
 namespace inl::gxeng {
@@ -20,7 +24,7 @@ struct DescriptorTableState {
 
 	DescriptorArrayRef reference; // current place in scratch space
 	int slot; // which root signature slot it belongs to
-	bool committed; // true if modifying descriptor in sratch space would break previous draw calls
+	bool committed; // true if modifying descriptor in sratch space would break previous draw calls, or the range is shared from the cache
 	std::vector<gxapi::DescriptorHandle> bindings; // currently bound descriptor handle, staging heap sources
 };
 
@@ -40,6 +44,9 @@ public:
 	void SetDescriptorHeap(StackDescHeap* heap);
 	void CommitDrawCall();
 	void UpdateBinding(gxapi::DescriptorHandle handle, int rootSignatureSlot, int indexInTable);
+
+	const StateFilterCounter& GetDescriptorStatistics() const { return m_descriptorStatistics; }
+	const StateFilterCounter& GetDescriptorTableStatistics() const { return m_descriptorTableStatistics; }
 private:
 	/// <summary> Updates a binding which is managed on the scratch space. </summary>
 	void UpdateRootTable(gxapi::DescriptorHandle, int rootSignatureSlot, int indexInTable);
@@ -59,6 +66,15 @@ private:
 	/// <summary> Copies ALL scratch space tables to a fresh range. Used after a new scratch space is bound. </summary>
 	void RenewRootTables();
 
+	/// <summary> Remembers the scratch space range of a table that will not be modified anymore. </summary>
+	void CacheRootTable(const DescriptorTableState& table);
+
+	/// <summary> Finds a range in scratch space that already holds exactly these descriptors. </summary>
+	/// <returns> Null if no such range is cached. </returns>
+	const DescriptorArrayRef* FindCachedRootTable(const std::vector<gxapi::DescriptorHandle>& bindings) const;
+
+	static size_t HashBindings(const std::vector<gxapi::DescriptorHandle>& bindings);
+
 	void SetRootDescriptorTable(gxapi::IGraphicsCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 	void SetRootDescriptorTable(gxapi::IComputeCommandList* list, unsigned parameterIndex, gxapi::DescriptorHandle baseHandle);
 	void SetRootSignature(gxapi::IGraphicsCommandList* list, gxapi::IRootSignature* sig);
@@ -70,6 +86,23 @@ protected:
 	StackDescHeap* m_heap;
 private:
 	std::vector<DescriptorTableState> m_rootTableStates;
+	StateFilterCounter m_descriptorStatistics;
+	StateFilterCounter m_descriptorTableStatistics;
+
+	// Committed tables in the current scratch space, keyed by the hash of their bindings.
+	// Draws that bind the same descriptors point to the same range instead of copying them again.
+	struct CachedRootTable {
+		size_t firstBinding; // in m_cachedBindings
+		DescriptorArrayRef reference;
+	};
+	std::unordered_multimap<size_t, CachedRootTable> m_rootTableCache;
+	std::vector<gxapi::DescriptorHandle> m_cachedBindings;
+
+	// Reused by DuplicateRootTable so that copying doesn't allocate.
+	std::vector<gxapi::DescriptorHandle> m_copySources;
+	std::vector<uint32_t> m_copySourceSizes;
+	std::vector<gxapi::DescriptorHandle> m_copyDestStarts;
+	std::vector<uint32_t> m_copyDestSizes;
 };
 
 
@@ -78,6 +111,7 @@ template <gxapi::eCommandListType Type>
 RootTableManager<Type>::RootTableManager() {
 	m_graphicsApi = nullptr;
 	m_commandList = nullptr;
+	m_binder = nullptr;
 }
 
 
@@ -85,6 +119,7 @@ template <gxapi::eCommandListType Type>
 RootTableManager<Type>::RootTableManager(gxapi::IGraphicsApi* graphicsApi, CommandListT* commandList) {
 	m_graphicsApi = graphicsApi;
 	m_commandList = commandList;
+	m_binder = nullptr;
 }
 
 
@@ -100,6 +135,11 @@ template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::SetDescriptorHeap(StackDescHeap* heap) {
 	assert(heap != nullptr);
 	m_heap = heap;
+
+	// cached ranges are in the previous scratch space
+	m_rootTableCache.clear();
+	m_cachedBindings.clear();
+
 	RenewRootTables();
 }
 
@@ -120,11 +160,28 @@ template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::UpdateRootTable(gxapi::DescriptorHandle handle, int rootSignatureSlot, int indexInTable) {
 	DescriptorTableState& table = FindRootTable(rootSignatureSlot);
 
+	// the descriptor is already in the table, rebinding it would only cost a copy or a whole new table
+	if (table.bindings[indexInTable].cpuAddress == handle.cpuAddress) {
+		++m_descriptorStatistics.filtered;
+		return;
+	}
+	++m_descriptorStatistics.forwarded;
+
 	// if table is committed, duplicate it so that recent drawcalls won't be broken
 	if (table.committed) {
 		// update handle in advance so that duplicate will copy it instead and we save time
 		table.bindings[indexInTable] = handle;
-		DuplicateRootTable(table);
+
+		// an earlier draw may have used the very same descriptors, its range can be shared
+		if (const DescriptorArrayRef* cached = FindCachedRootTable(table.bindings)) {
+			++m_descriptorTableStatistics.filtered;
+			table.reference = *cached;
+			table.committed = true; // must not be modified in place, it belongs to other draws as well
+		}
+		else {
+			++m_descriptorTableStatistics.forwarded;
+			DuplicateRootTable(table);
+		}
 
 		// update table root parameters
 		SetRootDescriptorTable(m_commandList, rootSignatureSlot, table.reference.Get(0));
@@ -144,15 +201,15 @@ void RootTableManager<Type>::DuplicateRootTable(DescriptorTableState& table) {
 	DescriptorArrayRef space = m_heap->Allocate(numDescriptors);
 
 	// copy old descriptors to new space
-	std::vector<gxapi::DescriptorHandle> sourceDescHandles;
-	std::vector<uint32_t> sourceRangeSizes(numDescriptors, 1);
-
-	std::vector<gxapi::DescriptorHandle> destDescHandleStarts;
-	std::vector<uint32_t> destRangeSizes;
+	std::vector<gxapi::DescriptorHandle>& sourceDescHandles = m_copySources;
+	std::vector<uint32_t>& sourceRangeSizes = m_copySourceSizes;
+	std::vector<gxapi::DescriptorHandle>& destDescHandleStarts = m_copyDestStarts;
+	std::vector<uint32_t>& destRangeSizes = m_copyDestSizes;
 
-	sourceDescHandles.reserve(numDescriptors);
-	destDescHandleStarts.reserve(10); // 99% only needs 1, 10 is negligible overhead but less allocation
-	destRangeSizes.reserve(10);
+	sourceDescHandles.clear();
+	sourceRangeSizes.assign(numDescriptors, 1);
+	destDescHandleStarts.clear();
+	destRangeSizes.clear();
 
 	bool makeFreshRange = true;
 	for (size_t i = 0; i < numDescriptors; ++i) {
@@ -247,10 +304,51 @@ void RootTableManager<Type>::InitRootTables() {
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::CommitRootTables() {
 	for (auto& table : m_rootTableStates) {
+		// tables that were not committed were written since the last draw, their final contents are known now
+		if (!table.committed) {
+			CacheRootTable(table);
+		}
 		table.committed = true;
 	}
 }
 
+template <gxapi::eCommandListType Type>
+void RootTableManager<Type>::CacheRootTable(const DescriptorTableState& table) {
+	if (FindCachedRootTable(table.bindings) != nullptr) {
+		return;
+	}
+
+	size_t firstBinding = m_cachedBindings.size();
+	m_cachedBindings.insert(m_cachedBindings.end(), table.bindings.begin(), table.bindings.end());
+	m_rootTableCache.insert({ HashBindings(table.bindings), CachedRootTable{ firstBinding, table.reference } });
+}
+
+template <gxapi::eCommandListType Type>
+const DescriptorArrayRef* RootTableManager<Type>::FindCachedRootTable(const std::vector<gxapi::DescriptorHandle>& bindings) const {
+	auto range = m_rootTableCache.equal_range(HashBindings(bindings));
+	for (auto it = range.first; it != range.second; ++it) {
+		const CachedRootTable& cached = it->second;
+		if (cached.reference.Count() != bindings.size()) {
+			continue;
+		}
+		bool equal = std::equal(bindings.begin(), bindings.end(), m_cachedBindings.begin() + cached.firstBinding,
+			[](const gxapi::DescriptorHandle& lhs, const gxapi::DescriptorHandle& rhs) { return lhs.cpuAddress == rhs.cpuAddress; });
+		if (equal) {
+			return &cached.reference;
+		}
+	}
+	return nullptr;
+}
+
+template <gxapi::eCommandListType Type>
+size_t RootTableManager<Type>::HashBindings(const std::vector<gxapi::DescriptorHandle>& bindings) {
+	size_t hash = bindings.size();
+	for (const auto& binding : bindings) {
+		hash ^= std::hash<const void*>{}(binding.cpuAddress) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+	return hash;
+}
+
 template <gxapi::eCommandListType Type>
 void RootTableManager<Type>::RenewRootTables() {
 	for (auto& table : m_rootTableStates) {
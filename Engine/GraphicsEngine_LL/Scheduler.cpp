@@ -4,6 +4,7 @@
 
 #include "GraphicsCommandList.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream> // only for debugging
 
@@ -16,6 +17,8 @@ Scheduler::Scheduler()
 
 void Scheduler::SetPipeline(Pipeline&& pipeline) {
 	m_pipeline = std::move(pipeline);
+	m_transientPool.Reset();
+	BuildTaskRecords();
 }
 
 const Pipeline& Scheduler::GetPipeline() const {
@@ -23,132 +26,101 @@ const Pipeline& Scheduler::GetPipeline() const {
 }
 
 Pipeline Scheduler::ReleasePipeline() {
+	m_records.clear();
+	m_successors.clear();
+	m_transientPool.Reset();
 	return std::move(m_pipeline);
 }
 
 void Scheduler::Execute(FrameContext context) {
-	const auto& taskGraph = m_pipeline.GetTaskGraph();
-	const auto& taskFunctionMap = m_pipeline.GetTaskFunctionMap();
-
-	auto tasks = MakeSchedule(taskGraph, taskFunctionMap);
+	// The copy task is always the first record.
+	m_uploadTask.SetUploads(context.uploadRequests);
+	if (m_records.empty()) {
+		BuildTaskRecords();
+	}
 
-	// Inject copy task to the start.
-	UploadTask uploadTask(context.uploadRequests);
-	tasks.insert(tasks.begin(), &uploadTask);
+	// Bring back resources evicted since the last frame while the tasks are being set up and recorded,
+	// the resource lists of a frame barely change.
+	context.memoryManager->GetResidencyManager().Prefetch(m_prefetchList);
 
 	// Setup and execute the tasks.
+	SubmissionBatch batch;
+	batch.usedResources = context.residencyQueue->AcquireResourceList();
+	std::vector<gxapi::IResource*> frameResources;
 	try {
 		// PHASE I.: Setup() tasks in correct order
-		for (auto& task : tasks) {
-			if (task != nullptr) {
-				SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi);
-				task->Setup(setupContext);
+		auto SetupTasks = [this, &context](bool dedicatedTextures) {
+			m_transientPool.BeginFrame(context.memoryManager, context.gxApi, dedicatedTextures);
+			for (size_t i = 0; i < m_records.size(); ++i) {
+				if (m_records[i].task != nullptr) {
+					SetupContext setupContext(context.memoryManager, context.textureSpace, context.rtvHeap, context.dsvHeap, context.shaderManager, context.gxApi, &m_transientPool, (unsigned)i);
+					m_records[i].task->Setup(setupContext);
+				}
 			}
+			return m_transientPool.EndFrame();
+		};
+		if (!SetupTasks(false)) {
+			// Aliased textures of the frame overlap, it can't be recorded like this. Setting up is repeatable,
+			// the inputs come from the preceding tasks, and from constants that stay set.
+			context.log->Event("Transient textures were used outside their planned lifetime, memory is planned again.");
+			SetupTasks(true);
 		}
 
 
-		// PHASE II.: Execute() tasks in correct
-		for (auto& task : tasks) {
-			VolatileViewHeap volatileHeap(context.gxApi);
-			RenderContext renderContext(context.memoryManager,
-										context.textureSpace,
-										&volatileHeap,
-										context.shaderManager,
-										context.gxApi,
-										context.commandListPool,
-										context.commandAllocatorPool,
-										context.scratchSpacePool);
-
-			// Execute the task on the CPU.
-			if (task != nullptr) {
-				task->Execute(renderContext);
-
-				// Enqueue all command lists on the GPU.
-				if (renderContext.IsListInitialized()) {
-					BasicCommandList* commandList = nullptr;
-					switch (renderContext.GetType()) {
-						case gxapi::eCommandListType::GRAPHICS: commandList = &renderContext.AsGraphics(); break;
-						case gxapi::eCommandListType::COMPUTE: commandList = &renderContext.AsCompute(); break;
-						case gxapi::eCommandListType::COPY: commandList = &renderContext.AsCopy(); break;
-						default: assert(false);
-					}
-					BasicCommandList::Decomposition decomposition = commandList->Decompose();
-
-					std::sort(decomposition.usedResources.begin(), decomposition.usedResources.end(), [](const ResourceUsage& lhs, const ResourceUsage& rhs) {
-						auto lhsPtr = lhs.resource._GetResourcePtr();
-						auto rhsPtr = rhs.resource._GetResourcePtr();
-						return lhsPtr < rhsPtr || (lhs.resource._GetResourcePtr() == rhs.resource._GetResourcePtr() && lhs.subresource < rhs.subresource);
-					});
-
-					// Inject a transition barrier command list.
-					auto barriers = InjectBarriers(decomposition.usedResources.begin(), decomposition.usedResources.end());
-					if (barriers.size() > 0) {
-						CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
-						GraphicsCmdListPtr injectList = context.commandListPool->RequestGraphicsList(injectAlloc.get());
-
-						injectList->ResourceBarrier((unsigned)barriers.size(), barriers.data());
-						injectList->Close();
-
-						EnqueueCommandList(*context.commandQueue,
-										   std::move(injectList),
-										   std::move(injectAlloc),
-										   {},
-										   {},
-										   {},
-										   context);
-					}
-
-					// Update resource states.
-					UpdateResourceStates(decomposition.usedResources.begin(), decomposition.usedResources.end());
-
-					// Enqueue actual command list.
-					std::vector<MemoryObject> usedResourceList;
-					usedResourceList.reserve(decomposition.usedResources.size());
-					for (auto& v : decomposition.usedResources) {
-						usedResourceList.push_back(std::move(v.resource));
-					}
-					for (auto& v : decomposition.additionalResources) {
-						usedResourceList.push_back(std::move(v));
-					}
-
-					dynamic_cast<gxapi::ICopyCommandList*>(decomposition.commandList.get())->Close();
-
-					EnqueueCommandList(*context.commandQueue,
-									   std::move(decomposition.commandList),
-									   std::move(decomposition.commandAllocator),
-									   std::move(decomposition.scratchSpaces),
-									   std::move(usedResourceList),
-									   std::unique_ptr<VolatileViewHeap>(new VolatileViewHeap(std::move(volatileHeap))),
-									   context);
+		// PHASE II.: Execute() tasks in parallel, submit them in correct order
+		FrameRecording recording(context, m_records);
+
+		// Launch tasks without dependencies, the rest is launched by the workers as their predecessors finish.
+		for (size_t i = 0; i < m_records.size(); ++i) {
+			if (m_records[i].numPredecessors == 0) {
+				LaunchTask(recording, i);
+			}
+		}
 
+		// Submit command lists in topological order as soon as they are recorded.
+		// Lists of a dependency level are batched, the batch is flushed when the next level begins.
+		unsigned currentLevel = 0;
+		std::vector<gxapi::IResource*> pendingAliasing; // of tasks without a list, carried to the next one
+		for (size_t i = 0; i < recording.records.size(); ++i) {
+			TaskRecord& record = recording.records[i];
+			const auto& activations = m_transientPool.GetActivations((unsigned)i);
+			pendingAliasing.insert(pendingAliasing.end(), activations.begin(), activations.end());
+
+			{
+				std::unique_lock<std::mutex> lk(recording.mutex);
+				recording.cv.wait(lk, [&record] { return record.isRecorded; });
+			}
 
+			if (record.exception) {
+				std::rethrow_exception(record.exception);
+			}
 
-				}
+			if (record.renderContext && record.renderContext->IsListInitialized()) {
+				bool flushBefore = record.level != currentLevel;
+				SubmitTask(*record.renderContext, std::move(record.volatileHeap), flushBefore, pendingAliasing, batch, frameResources, context);
+				pendingAliasing.clear();
+				currentLevel = record.level;
 			}
+			record.renderContext.reset();
 		}
 
 		// Set backBuffer to PRESENT state.
 		gxapi::eResourceState bbState = context.backBuffer->GetResource().ReadState(0);
 
 		if (bbState != gxapi::eResourceState::PRESENT) {
-			CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
-			GraphicsCmdListPtr injectList = context.commandListPool->RequestGraphicsList(injectAlloc.get());
-
-			injectList->ResourceBarrier(gxapi::TransitionBarrier{
+			gxapi::ICopyCommandList* barrierList = GetBarrierList(batch, context);
+			barrierList->ResourceBarrier(gxapi::TransitionBarrier{
 				context.backBuffer->GetResource()._GetResourcePtr(),
 				context.backBuffer->GetResource().ReadState(0),
 				gxapi::eResourceState::PRESENT });
-			injectList->Close();
 			context.backBuffer->GetResource().RecordState(gxapi::eResourceState::PRESENT);
-
-			EnqueueCommandList(*context.commandQueue,
-				std::move(injectList),
-				std::move(injectAlloc),
-				{},
-				{},
-				{},
-				context);
 		}
+
+		FlushBatch(batch, context);
+
+		std::sort(frameResources.begin(), frameResources.end());
+		frameResources.erase(std::unique(frameResources.begin(), frameResources.end()), frameResources.end());
+		m_prefetchList = std::move(frameResources);
 	}
 	catch (std::exception& ex) {
 		// One of the pipeline Nodes (Tasks) threw an exception.
@@ -159,6 +131,7 @@ void Scheduler::Execute(FrameContext context) {
 
 		// Draw a red blinking background to signal error.
 		try {
+			FlushBatch(batch, context); // resource states are already recorded for these lists
 			RenderFailureScreen(context);
 		}
 		catch (std::exception& ex) {
@@ -174,45 +147,228 @@ void Scheduler::ReleaseResources() {
 			ptr->Reset();
 		}
 	}
+	m_pipeline.ApplyConstants(); // the inputs they set were cleared too
 }
 
 
-void Scheduler::MakeResident(std::vector<MemoryObject*> usedResources) {
+void Scheduler::BuildTaskRecords() {
+	const Pipeline::Schedule& schedule = m_pipeline.GetSchedule();
+
+	// Offset the pipeline's indices by one to make room for the copy task.
+	m_successors.resize(schedule.successors.size());
+	for (size_t i = 0; i < schedule.successors.size(); ++i) {
+		m_successors[i] = schedule.successors[i] + 1;
+	}
+
+	m_records = std::vector<TaskRecord>(schedule.tasks.size() + 1);
+	m_records[0].task = &m_uploadTask;
+	for (size_t i = 0; i < schedule.tasks.size(); ++i) {
+		const Pipeline::ScheduledTask& scheduled = schedule.tasks[i];
+		TaskRecord& record = m_records[i + 1];
+		record.task = scheduled.task;
+		record.successors = m_successors.data() + scheduled.firstSuccessor;
+		record.numSuccessors = scheduled.numSuccessors;
+		record.numPredecessors = scheduled.numPredecessors;
+		record.level = scheduled.level;
+	}
+}
+
 
+void Scheduler::LaunchTask(FrameRecording& recording, size_t index) {
+	{
+		std::lock_guard<std::mutex> lkg(recording.mutex);
+		++recording.numOutstanding;
+	}
+	m_executor.Push([this, &recording, index] {
+		RecordTask(recording, index);
+	});
 }
 
 
-void Scheduler::Evict(std::vector<MemoryObject*> usedResources) {
+void Scheduler::RecordTask(FrameRecording& recording, size_t index) {
+	TaskRecord& record = recording.records[index];
+	const FrameContext& context = recording.context;
+
+	// Execute the task on the CPU, unless a previous failure already ruined the frame.
+	if (record.task != nullptr && !recording.cancelled) {
+		try {
+			record.volatileHeap = std::make_unique<VolatileViewHeap>(context.volatileViewHeapPool);
+			record.renderContext = std::make_unique<RenderContext>(context.memoryManager,
+																   context.textureSpace,
+																   record.volatileHeap.get(),
+																   context.shaderManager,
+																   context.gxApi,
+																   context.commandListPool,
+																   context.commandAllocatorPool,
+																   context.scratchSpacePool);
+			record.task->Execute(*record.renderContext);
+		}
+		catch (...) {
+			record.exception = std::current_exception();
+			recording.cancelled = true;
+		}
+	}
 
+	// Successors are launched even after a failure so that the frame always drains.
+	for (unsigned i = 0; i < record.numSuccessors; ++i) {
+		unsigned successor = record.successors[i];
+		if (--recording.records[successor].numPendingPredecessors == 0) {
+			LaunchTask(recording, successor);
+		}
+	}
+
+	// Notify while holding the lock: the recording may be destroyed as soon as it's released.
+	std::lock_guard<std::mutex> lkg(recording.mutex);
+	record.isRecorded = true;
+	--recording.numOutstanding;
+	recording.cv.notify_all();
 }
 
-std::vector<GraphicsTask*> Scheduler::MakeSchedule(const lemon::ListDigraph& taskGraph,
-													const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap
-/*std::vector<CommandQueue*> queues*/)
+
+Scheduler::FrameRecording::FrameRecording(const FrameContext& context, std::vector<TaskRecord>& records)
+	: context(context), records(records)
 {
-	// Topologically sort the tasks.
-	lemon::ListDigraph::NodeMap<int> taskOrderMap(taskGraph);
-	bool isSortable = lemon::checkedTopologicalSort(taskGraph, taskOrderMap);
-	assert(isSortable);
-
-	std::vector<lemon::ListDigraph::NodeIt> taskNodes;
-	for (lemon::ListDigraph::NodeIt taskNode(taskGraph); taskNode != lemon::INVALID; ++taskNode) {
-		taskNodes.push_back(taskNode);
+	for (auto& record : records) {
+		record.numPendingPredecessors = record.numPredecessors;
+		record.volatileHeap.reset();
+		record.renderContext.reset();
+		record.exception = nullptr;
+		record.isRecorded = false;
 	}
+}
 
-	std::sort(taskNodes.begin(), taskNodes.end(), [&](auto n1, auto n2)
-	{
-		return taskOrderMap[n1] < taskOrderMap[n2];
-	});
 
-	// Make a list of them.
-	std::vector<GraphicsTask*> tasks;
-	for (auto node : taskNodes) {
-		auto& task = taskFunctionMap[node];
-		tasks.push_back(task);
+Scheduler::FrameRecording::~FrameRecording() {
+	cancelled = true;
+	std::unique_lock<std::mutex> lk(mutex);
+	cv.wait(lk, [this] { return numOutstanding == 0; });
+}
+
+
+void Scheduler::SubmitTask(RenderContext& renderContext, std::unique_ptr<VolatileViewHeap> volatileHeap, bool flushBefore, const std::vector<gxapi::IResource*>& aliasedResources, SubmissionBatch& batch, std::vector<gxapi::IResource*>& frameResources, const FrameContext& context) {
+	BasicCommandList* commandList = nullptr;
+	switch (renderContext.GetType()) {
+		case gxapi::eCommandListType::GRAPHICS: commandList = &renderContext.AsGraphics(); break;
+		case gxapi::eCommandListType::COMPUTE: commandList = &renderContext.AsCompute(); break;
+		case gxapi::eCommandListType::COPY: commandList = &renderContext.AsCopy(); break;
+		default: assert(false);
 	}
+	BasicCommandList::Decomposition decomposition = commandList->Decompose(); // used resources come sorted
+
+	// Append the transition barriers to the tail of the batch, which is usually the previous task's list.
+	auto barriers = InjectBarriers(decomposition.usedResources.begin(), decomposition.usedResources.end(), batch);
+	if (!aliasedResources.empty()) {
+		// Transient textures taking over memory must be activated before they are transitioned.
+		std::vector<gxapi::ResourceBarrier> aliasingBarriers;
+		aliasingBarriers.reserve(aliasedResources.size() + barriers.size());
+		for (gxapi::IResource* resource : aliasedResources) {
+			aliasingBarriers.push_back(gxapi::AliasingBarrier{ nullptr, resource });
+		}
+		aliasingBarriers.insert(aliasingBarriers.end(), barriers.begin(), barriers.end());
+		barriers = std::move(aliasingBarriers);
+	}
+	if (barriers.size() > 0) {
+		gxapi::ICopyCommandList* barrierList = GetBarrierList(batch, context);
+		barrierList->ResourceBarrier((unsigned)barriers.size(), barriers.data());
+	}
+
+	// The barriers are in place, the previous dependency level can go.
+	if (flushBefore) {
+		FlushBatch(batch, context);
+	}
+
+	// Update resource states.
+	UpdateResourceStates(decomposition.usedResources.begin(), decomposition.usedResources.end());
+
+	// Add actual command list to the batch.
+	size_t listIndex = batch.commandLists.size();
+	for (auto& v : decomposition.usedResources) {
+		if (v.subresource != gxapi::ALL_SUBRESOURCES) {
+			batch.lastUsers[SubresourceId(v.resource, v.subresource)] = listIndex;
+		}
+		else {
+			for (unsigned s = 0; s < v.resource.GetNumSubresources(); ++s) {
+				batch.lastUsers[SubresourceId(v.resource, s)] = listIndex;
+			}
+		}
+		if (frameResources.empty() || frameResources.back() != v.resource._GetResourcePtr()) {
+			frameResources.push_back(v.resource._GetResourcePtr()); // subresources of a resource are adjacent
+		}
+		batch.usedResources.push_back(std::move(v.resource));
+	}
+	for (auto& v : decomposition.additionalResources) {
+		if (v.HasObject()) {
+			frameResources.push_back(v._GetResourcePtr());
+		}
+		batch.usedResources.push_back(std::move(v));
+	}
+	for (auto& v : decomposition.scratchSpaces) {
+		batch.scratchSpaces.push_back(std::move(v));
+	}
+
+	batch.commandLists.push_back(std::move(decomposition.commandList));
+	batch.commandAllocators.push_back(std::move(decomposition.commandAllocator));
+	batch.volatileHeaps.push_back(std::move(volatileHeap));
+}
+
+
+gxapi::ICopyCommandList* Scheduler::GetBarrierList(SubmissionBatch& batch, const FrameContext& context) {
+	if (!batch.commandLists.empty() && batch.commandLists.back()->GetType() == gxapi::eCommandListType::GRAPHICS) {
+		return dynamic_cast<gxapi::ICopyCommandList*>(batch.commandLists.back().get());
+	}
+
+	CmdAllocPtr injectAlloc = context.commandAllocatorPool->RequestAllocator(gxapi::eCommandListType::GRAPHICS);
+	GraphicsCmdListPtr injectList = context.commandListPool->RequestGraphicsList(injectAlloc.get());
+	gxapi::ICopyCommandList* barrierList = injectList.get();
+
+	batch.commandLists.push_back(std::move(injectList));
+	batch.commandAllocators.push_back(std::move(injectAlloc));
+	return barrierList;
+}
+
+
+void Scheduler::FlushBatch(SubmissionBatch& batch, const FrameContext& context) {
+	if (batch.commandLists.empty()) {
+		return;
+	}
+
+	std::vector<gxapi::ICommandList*> execLists;
+	execLists.reserve(batch.commandLists.size());
+	for (auto& commandList : batch.commandLists) {
+		dynamic_cast<gxapi::ICopyCommandList*>(commandList.get())->Close();
+		execLists.push_back(commandList.get());
+	}
+
+	// Enqueue CPU task to make resources resident before the command lists run.
+	SyncPoint residentPoint = context.residencyQueue->EnqueueInit(batch.usedResources);
+
+	// Enqueue the command lists on the GPU.
+	context.commandQueue->Wait(residentPoint);
+	context.commandQueue->ExecuteCommandLists((uint32_t)execLists.size(), execLists.data());
+	SyncPoint completionPoint = context.commandQueue->Signal();
+
+	// Enqueue CPU task to clean up resources after the command lists finished.
+	context.residencyQueue->EnqueueClean(completionPoint,
+										 std::move(batch.usedResources),
+										 std::move(batch.commandAllocators),
+										 std::move(batch.scratchSpaces),
+										 std::move(batch.volatileHeaps));
+
+	batch = SubmissionBatch{};
+	batch.usedResources = context.residencyQueue->AcquireResourceList();
+}
+
+
+bool Scheduler::IsCoveredReadState(gxapi::eResourceState currentState, gxapi::eResourceState requestedState) {
+	const gxapi::eResourceState readStates = {
+		gxapi::eResourceState::GENERIC_READ,
+		gxapi::eResourceState::DEPTH_READ,
+		gxapi::eResourceState::RESOLVE_SOURCE
+	};
 
-	return tasks;
+	return requestedState != gxapi::eResourceState::COMMON
+		&& currentState - readStates == gxapi::eResourceState::COMMON
+		&& (currentState & requestedState) == requestedState;
 }
 
 
@@ -326,7 +482,7 @@ void Scheduler::UploadTask::Execute(RenderContext& context) {
 
 		if (destType == UploadManager::DestType::BUFFER) {
 			auto& dstBuffer = static_cast<LinearBuffer&>(destination);
-			commandList.CopyBuffer(dstBuffer, request.dstOffsetX, source, 0, dstBuffer.GetSize());
+			commandList.CopyBuffer(dstBuffer, request.dstOffsetX, source, request.srcOffset, request.size);
 		}
 		else if (destType == UploadManager::DestType::TEXTURE_2D) {
 			auto& dstTexture = static_cast<Texture2D&>(destination);
@@ -6,6 +6,9 @@
 #include "ScratchSpacePool.hpp"
 #include "CommandListPool.hpp"
 #include "MemoryObject.hpp"
+#include "BasicCommandList.hpp"
+#include "TaskExecutor.hpp"
+#include "TransientResourcePool.hpp"
 
 #include <BaseLibrary/optional.hpp>
 #include <GraphicsApi_LL/IFence.hpp>
@@ -13,6 +16,11 @@
 #include <memory>
 #include <cstdint>
 #include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 
 namespace inl {
 namespace gxeng {
@@ -38,13 +46,63 @@ protected:
 	};
 
 
-	static void MakeResident(std::vector<MemoryObject*> usedResources);
-	static void Evict(std::vector<MemoryObject*> usedResources);
+	/// <summary> A task of the pipeline's schedule along with its recording state in the current frame. </summary>
+	/// <remarks> Built once per pipeline, the per-frame fields are reset at the start of each frame. </remarks>
+	struct TaskRecord {
+		GraphicsTask* task = nullptr;
+		const unsigned* successors = nullptr;
+		unsigned numSuccessors = 0;
+		unsigned numPredecessors = 0;
+		unsigned level = 0;
 
+		std::atomic_uint numPendingPredecessors = 0;
+		std::unique_ptr<VolatileViewHeap> volatileHeap;
+		std::unique_ptr<RenderContext> renderContext;
+		std::exception_ptr exception;
+		bool isRecorded = false; /// <summary> Guarded by the mutex of the owning <see cref="FrameRecording"/>. </summary>
+	};
+
+	/// <summary> Shared between the submitting thread and the workers recording the tasks of a frame. </summary>
+	/// <remarks> The destructor blocks until no worker references the recording anymore. </remarks>
+	struct FrameRecording {
+		FrameRecording(const FrameContext& context, std::vector<TaskRecord>& records);
+		~FrameRecording();
+
+		const FrameContext& context;
+		std::vector<TaskRecord>& records;
+		std::atomic_bool cancelled = false;
+
+		std::mutex mutex;
+		std::condition_variable cv;
+		size_t numOutstanding = 0;
+	};
+
+	/// <summary> Command lists of consecutive tasks that are sent to the GPU with a single ExecuteCommandLists. </summary>
+	/// <remarks> The lists are kept open until the batch is flushed, so that the barriers of the following
+	///			  tasks can be appended to them instead of being submitted in lists of their own. </remarks>
+	struct SubmissionBatch {
+		std::vector<CmdListPtr> commandLists;
+		std::vector<CmdAllocPtr> commandAllocators;
+		std::vector<ScratchSpacePtr> scratchSpaces;
+		std::vector<MemoryObject> usedResources;
+		std::vector<std::unique_ptr<VolatileViewHeap>> volatileHeaps;
+		std::unordered_map<SubresourceId, size_t> lastUsers; /// <summary> Index of the list that used the subresource last. </summary>
+	};
 
-	static std::vector<GraphicsTask*> MakeSchedule(const lemon::ListDigraph& taskGraph,
-												   const lemon::ListDigraph::NodeMap<GraphicsTask*>& taskFunctionMap
-													/*std::vector<CommandQueue*> queues*/);
+	void BuildTaskRecords();
+	void LaunchTask(FrameRecording& recording, size_t index);
+	void RecordTask(FrameRecording& recording, size_t index);
+
+	/// <summary> Moves the task's command list into the batch and adds the resources it uses to <paramref name="frameResources"/>. </summary>
+	/// <param name="aliasedResources"> Transient textures whose memory is taken over by the task, an aliasing barrier precedes the list for each. </param>
+	static void SubmitTask(RenderContext& renderContext, std::unique_ptr<VolatileViewHeap> volatileHeap, bool flushBefore, const std::vector<gxapi::IResource*>& aliasedResources, SubmissionBatch& batch, std::vector<gxapi::IResource*>& frameResources, const FrameContext& context);
+
+	/// <summary> Returns the list at the tail of the batch if barriers can be recorded into it,
+	///			  otherwise appends a new graphics list to the batch. </summary>
+	static gxapi::ICopyCommandList* GetBarrierList(SubmissionBatch& batch, const FrameContext& context);
+
+	/// <summary> Closes and executes the lists of the batch, then empties it. </summary>
+	static void FlushBatch(SubmissionBatch& batch, const FrameContext& context);
 
 	static void EnqueueCommandList(CommandQueue& commandQueue,
 								   CmdListPtr commandList,
@@ -54,8 +112,15 @@ protected:
 								   std::unique_ptr<VolatileViewHeap> volatileHeap,
 								   const FrameContext& context);
 
+	/// <summary> Collects the barriers needed before the used resources are in the state the task expects. </summary>
+	/// <remarks> Transitions of subresources last used by a list earlier in the batch are split: the begin half is
+	///			  recorded right into that list, the end half is returned along with the normal barriers. </remarks>
 	template <class UsedResourceIter>
-	static std::vector<gxapi::ResourceBarrier> InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource);
+	static std::vector<gxapi::ResourceBarrier> InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource, SubmissionBatch& batch);
+
+	/// <summary> True if the read-only <paramref name="currentState"/> already includes the requested read state. </summary>
+	/// <remarks> Consecutive readers of a subresource need no transition between them this way. </remarks>
+	static bool IsCoveredReadState(gxapi::eResourceState currentState, gxapi::eResourceState requestedState);
 
 	template <class UsedResourceIter1, class UsedResourceIter2>
 	static bool CanExecuteParallel(UsedResourceIter1 first1, UsedResourceIter1 last1, UsedResourceIter2 first2, UsedResourceIter2 last2);
@@ -64,43 +129,70 @@ protected:
 	static void UpdateResourceStates(UsedResourceIter firstResource, UsedResourceIter lastResource);
 
 	static void RenderFailureScreen(FrameContext context);
-private:
-	Pipeline m_pipeline;
 private:
 	class UploadTask : public GraphicsTask {
 	public:
-		UploadTask(const std::vector<UploadManager::UploadDescription>* uploads) : m_uploads(uploads) {}
+		UploadTask() : m_uploads(nullptr) {}
+		void SetUploads(const std::vector<UploadManager::UploadDescription>* uploads) { m_uploads = uploads; }
 		void Setup(SetupContext& context) override;
 		void Execute(RenderContext& context) override;
 	private:
 		const std::vector<UploadManager::UploadDescription>* m_uploads;
 	};
+private:
+	Pipeline m_pipeline;
+	TaskExecutor m_executor;
+
+	UploadTask m_uploadTask;
+	std::vector<TaskRecord> m_records; // upload task first, then the pipeline's schedule
+	std::vector<unsigned> m_successors; // successor indices of m_records
+	std::vector<gxapi::IResource*> m_prefetchList; // resources used in the last frame, likely needed by the next one
+	TransientResourcePool m_transientPool; // task indices are those of m_records
 };
 
 
 
 template <class UsedResourceIter>
-std::vector<gxapi::ResourceBarrier> Scheduler::InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource) {
+std::vector<gxapi::ResourceBarrier> Scheduler::InjectBarriers(UsedResourceIter firstResource, UsedResourceIter lastResource, SubmissionBatch& batch) {
 	std::vector<gxapi::ResourceBarrier> barriers;
 
+	auto AddTransition = [&barriers, &batch](MemoryObject& resource, unsigned subresource, const ResourceUsage& usage) {
+		gxapi::eResourceState sourceState = resource.ReadState(subresource);
+		gxapi::eResourceState targetState = usage.firstState;
+		if (sourceState == targetState) {
+			return;
+		}
+		// Tasks that only read the subresource can keep using the wider read state of previous readers.
+		if (!usage.multipleStates && IsCoveredReadState(sourceState, targetState)) {
+			return;
+		}
+
+		// Begin the transition right after the last use if that's not the list just before the task.
+		auto lastUser = batch.lastUsers.find(SubresourceId(resource, subresource));
+		if (lastUser != batch.lastUsers.end()
+			&& lastUser->second + 1 < batch.commandLists.size()
+			&& batch.commandLists[lastUser->second]->GetType() == gxapi::eCommandListType::GRAPHICS)
+		{
+			auto lastUserList = dynamic_cast<gxapi::ICopyCommandList*>(batch.commandLists[lastUser->second].get());
+			lastUserList->ResourceBarrier(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresource, gxapi::eResourceBarrierSplit::BEGIN });
+			barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresource, gxapi::eResourceBarrierSplit::END });
+		}
+		else {
+			barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresource });
+		}
+	};
+
 	// Collect all necessary barriers.
 	for (UsedResourceIter it = firstResource; it != lastResource; ++it) {
 		MemoryObject& resource = it->resource;
 		unsigned subresource = it->subresource;
-		gxapi::eResourceState targetState = it->firstState;
 
 		if (subresource != gxapi::ALL_SUBRESOURCES) {
-			gxapi::eResourceState sourceState = resource.ReadState(subresource);
-			if (sourceState != targetState) {
-				barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresource });
-			}
+			AddTransition(resource, subresource, *it);
 		}
 		else {
 			for (unsigned subresourceIdx = 0; subresourceIdx < resource.GetNumSubresources(); ++subresourceIdx) {
-				gxapi::eResourceState sourceState = resource.ReadState(subresourceIdx);
-				if (sourceState != targetState) {
-					barriers.push_back(gxapi::TransitionBarrier{ resource._GetResourcePtr(), sourceState, targetState, subresourceIdx });
-				}
+				AddTransition(resource, subresourceIdx, *it);
 			}
 		}
 	}
@@ -141,14 +233,21 @@ bool Scheduler::CanExecuteParallel(UsedResourceIter1 first1, UsedResourceIter1 l
 
 template <class UsedResourceIter>
 void Scheduler::UpdateResourceStates(UsedResourceIter firstResource, UsedResourceIter lastResource) {
+	auto RecordState = [](MemoryObject& resource, unsigned subresource, const ResourceUsage& usage) {
+		// Keep the wider read state if the barriers were skipped for a reader.
+		if (usage.multipleStates || !IsCoveredReadState(resource.ReadState(subresource), usage.lastState)) {
+			resource.RecordState(subresource, usage.lastState);
+		}
+	};
+
 	for (auto it = firstResource; it != lastResource; ++it) {
 		if (it->subresource == gxapi::ALL_SUBRESOURCES) {
 			for (unsigned s = 0; s < it->resource.GetNumSubresources(); ++s) {
-				it->resource.RecordState(s, it->lastState);
+				RecordState(it->resource, s, *it);
 			}
 		}
 		else {
-			it->resource.RecordState(it->subresource, it->lastState);
+			RecordState(it->resource, it->subresource, *it);
 		}
 	}
 }
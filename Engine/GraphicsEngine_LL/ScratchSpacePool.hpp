@@ -1,11 +1,9 @@
 #pragma once
 
-#include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
 #include "../GraphicsApi_LL/IGraphicsApi.hpp"
 #include "StackDescHeap.hpp"
-#include <vector>
-#include <map>
-#include <mutex>
+#include "RecyclingPool.hpp"
+#include <memory>
 
 
 namespace inl {
@@ -30,20 +28,16 @@ public:
 public:
 	ScratchSpacePool(gxapi::IGraphicsApi* gxApi, gxapi::eDescriptorHeapType type);
 	ScratchSpacePool(const ScratchSpacePool&) = delete;
-	ScratchSpacePool(ScratchSpacePool&&) = default;
 	ScratchSpacePool& operator=(const ScratchSpacePool&) = delete;
-	ScratchSpacePool& operator=(ScratchSpacePool&& rhs) = default;;
 
 	UniquePtr RequestScratchSpace();
 	void RecycleScratchSpace(StackDescHeap* scratchSpace);
+
+	PoolStatistics GetStatistics() const;
 private:
-	std::vector<std::unique_ptr<StackDescHeap>> m_pool;
+	impl::RecyclingPool<StackDescHeap> m_pool;
 	gxapi::eDescriptorHeapType m_type;
-	SlabAllocatorEngine m_allocator;
 	gxapi::IGraphicsApi* m_gxApi;
-	std::map<StackDescHeap*, size_t> m_addressToIndex;
-
-	std::mutex m_mutex;
 };
 
 
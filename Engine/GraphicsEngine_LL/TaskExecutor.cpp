@@ -0,0 +1,123 @@
+#include "TaskExecutor.hpp"
+
+#include <BaseLibrary/ThreadName.hpp>
+
+#include <string>
+
+
+namespace inl::gxeng {
+
+
+// Identifies the worker the current thread belongs to, if any.
+static thread_local const TaskExecutor* currentExecutor = nullptr;
+static thread_local size_t currentWorkerIndex = 0;
+
+
+TaskExecutor::TaskExecutor(unsigned numWorkers)
+	: m_nextWorker(0), m_numQueued(0)
+{
+	if (numWorkers == 0) {
+		unsigned numCores = std::thread::hardware_concurrency();
+		numWorkers = numCores > 1 ? numCores - 1 : 1;
+	}
+
+	m_workers.reserve(numWorkers);
+	for (unsigned i = 0; i < numWorkers; ++i) {
+		m_workers.push_back(std::make_unique<Worker>());
+	}
+
+	m_runThreads = true;
+	for (size_t i = 0; i < m_workers.size(); ++i) {
+		m_workers[i]->thread = std::thread(&TaskExecutor::WorkerFunc, this, i);
+	}
+}
+
+
+TaskExecutor::~TaskExecutor() {
+	{
+		std::lock_guard<std::mutex> lkg(m_sleepMutex);
+		m_runThreads = false;
+	}
+	m_sleepCv.notify_all();
+
+	for (auto& worker : m_workers) {
+		worker->thread.join();
+	}
+}
+
+
+void TaskExecutor::Push(Job job) {
+	size_t workerIndex;
+	if (currentExecutor == this) {
+		workerIndex = currentWorkerIndex;
+	}
+	else {
+		workerIndex = m_nextWorker++ % m_workers.size();
+	}
+
+	// Count the job before it becomes visible so that the counter never underflows when
+	// another worker steals it right away. Incremented under the sleep lock so that
+	// no worker can miss the wakeup.
+	{
+		std::lock_guard<std::mutex> lkg(m_sleepMutex);
+		++m_numQueued;
+	}
+	{
+		Worker& worker = *m_workers[workerIndex];
+		std::lock_guard<std::mutex> lkg(worker.mutex);
+		worker.jobs.push_back(std::move(job));
+	}
+	m_sleepCv.notify_one();
+}
+
+
+void TaskExecutor::WorkerFunc(size_t workerIndex) {
+	SetCurrentThreadName(("Graphics Worker " + std::to_string(workerIndex)).c_str());
+	currentExecutor = this;
+	currentWorkerIndex = workerIndex;
+
+	Job job;
+	while (true) {
+		if (TryPop(workerIndex, job) || TrySteal(workerIndex, job)) {
+			--m_numQueued;
+			job();
+			job = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lk(m_sleepMutex);
+		m_sleepCv.wait(lk, [this] { return !m_runThreads || m_numQueued > 0; });
+		if (!m_runThreads) {
+			break;
+		}
+	}
+}
+
+
+bool TaskExecutor::TryPop(size_t workerIndex, Job& job) {
+	Worker& worker = *m_workers[workerIndex];
+	std::lock_guard<std::mutex> lkg(worker.mutex);
+	if (worker.jobs.empty()) {
+		return false;
+	}
+	job = std::move(worker.jobs.back());
+	worker.jobs.pop_back();
+	return true;
+}
+
+
+bool TaskExecutor::TrySteal(size_t thiefIndex, Job& job) {
+	for (size_t offset = 1; offset < m_workers.size(); ++offset) {
+		Worker& victim = *m_workers[(thiefIndex + offset) % m_workers.size()];
+		std::lock_guard<std::mutex> lkg(victim.mutex);
+		if (!victim.jobs.empty()) {
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+
+namespace inl::gxeng {
+
+
+/// <summary>
+/// A small work-stealing thread pool used to record the command lists of
+/// independent graphics tasks in parallel.
+/// </summary>
+/// <remarks>
+/// Each worker owns a job deque. Jobs pushed from a worker thread go to the back of
+/// that worker's own deque and are popped LIFO for cache locality, jobs pushed from
+/// outside are distributed round-robin. Idle workers steal from the front of the other
+/// workers' deques before going to sleep.
+/// </remarks>
+class TaskExecutor {
+public:
+	using Job = std::function<void()>;
+public:
+	/// <param name="numWorkers"> Number of worker threads. 0 means one less than the number of hardware threads. </param>
+	explicit TaskExecutor(unsigned numWorkers = 0);
+	TaskExecutor(const TaskExecutor&) = delete;
+	TaskExecutor& operator=(const TaskExecutor&) = delete;
+	~TaskExecutor();
+
+	/// <summary> Queues a job for execution on any of the worker threads. Thread safe. </summary>
+	void Push(Job job);
+
+	size_t GetNumWorkers() const { return m_workers.size(); }
+private:
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+		std::thread thread;
+	};
+
+	void WorkerFunc(size_t workerIndex);
+	bool TryPop(size_t workerIndex, Job& job);
+	bool TrySteal(size_t thiefIndex, Job& job);
+private:
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::atomic_size_t m_nextWorker;
+	std::atomic_size_t m_numQueued;
+	std::atomic_bool m_runThreads;
+
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCv;
+};
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,237 @@
+#include "TransientResourcePool.hpp"
+
+#include "MemoryManager.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <cassert>
+
+
+namespace inl::gxeng {
+
+
+
+void TransientResourcePool::BeginFrame(MemoryManager* memoryManager, gxapi::IGraphicsApi* graphicsApi, bool dedicated) {
+	m_memoryManager = memoryManager;
+	m_graphicsApi = graphicsApi;
+
+	m_requests.clear();
+	m_requestIndices.clear();
+	m_diverged = dedicated;
+	m_dedicated = dedicated;
+}
+
+
+bool TransientResourcePool::EndFrame() {
+	bool valid = true;
+	bool changed = m_diverged || m_requests.size() != m_plan.size();
+
+	for (auto& activations : m_activations) {
+		activations.clear();
+	}
+
+	// Nothing is aliased, and the plan is already made for the lifetimes of the frame that failed.
+	if (m_dedicated) {
+		m_requests.clear();
+		m_requestIndices.clear();
+		return true;
+	}
+
+	for (size_t i = 0; i < m_requests.size(); ++i) {
+		const Request& request = m_requests[i];
+		if (!request.aliased) {
+			continue;
+		}
+
+		// Shorter lifetimes are still safe, longer ones may overlap other textures in memory.
+		const PlannedTexture& planned = m_plan[i];
+		if (request.firstTask < planned.firstTask || request.lastTask > planned.lastTask) {
+			valid = false;
+			changed = true;
+		}
+
+		if (request.firstTask >= m_activations.size()) {
+			m_activations.resize(request.firstTask + 1);
+		}
+		m_activations[request.firstTask].push_back(request.texture._GetResourcePtr());
+	}
+
+	m_previousPlan.clear();
+	if (changed) {
+		Plan();
+	}
+
+	m_requests.clear();
+	m_requestIndices.clear();
+
+	return valid;
+}
+
+
+void TransientResourcePool::Reset() {
+	m_requests.clear();
+	m_requestIndices.clear();
+	m_plan.clear();
+	m_previousPlan.clear();
+	m_activations.clear();
+	m_statistics = {};
+}
+
+
+Texture2D TransientResourcePool::CreateTexture2D(const Texture2DDesc& desc, gxapi::eResourceFlags flags, unsigned taskIndex) {
+	gxapi::ResourceDesc resourceDesc = gxapi::ResourceDesc::Texture2DArray(desc.width, desc.height, desc.format, desc.arraySize, flags, desc.mipLevels);
+
+	// Setup runs in the same order every frame, so the n-th request gets the n-th planned texture.
+	size_t ordinal = m_requests.size();
+	Request request{ resourceDesc, {}, taskIndex, taskIndex, false };
+	if (!m_diverged && ordinal < m_plan.size() && IsSameDesc(m_plan[ordinal].desc, resourceDesc)) {
+		request.texture = m_plan[ordinal].texture;
+		request.aliased = true;
+	}
+	else {
+		m_diverged = true;
+		request.texture = m_memoryManager->CreateTexture2D(eResourceHeapType::CRITICAL, desc, flags);
+	}
+
+	m_requestIndices[request.texture._GetResourcePtr()] = ordinal;
+	m_requests.push_back(request);
+
+	return request.texture;
+}
+
+
+void TransientResourcePool::Use(const MemoryObject& texture, unsigned taskIndex) {
+	if (!texture.HasObject()) {
+		return;
+	}
+
+	auto it = m_requestIndices.find(texture._GetResourcePtr());
+	if (it != m_requestIndices.end()) {
+		Request& request = m_requests[it->second];
+		request.firstTask = std::min(request.firstTask, taskIndex);
+		request.lastTask = std::max(request.lastTask, taskIndex);
+	}
+}
+
+
+const std::vector<gxapi::IResource*>& TransientResourcePool::GetActivations(unsigned taskIndex) const {
+	static const std::vector<gxapi::IResource*> none;
+	return taskIndex < m_activations.size() ? m_activations[taskIndex] : none;
+}
+
+
+void TransientResourcePool::Plan() {
+	struct Placement {
+		uint64_t size;
+		uint64_t alignment;
+		uint64_t offset;
+		int heap;
+	};
+
+	std::vector<Placement> placements(m_requests.size());
+	for (size_t i = 0; i < m_requests.size(); ++i) {
+		gxapi::ResourceAllocationInfo allocationInfo = m_graphicsApi->GetResourceAllocationInfo(m_requests[i].desc);
+		placements[i].size = allocationInfo.sizeInBytes;
+		placements[i].alignment = std::max(allocationInfo.alignment, uint64_t(1));
+		placements[i].offset = 0;
+		placements[i].heap = IsRenderTargetOrDepth(m_requests[i].desc) ? 0 : 1; // separate heaps for the lowest resource heap tier
+	}
+
+	// Largest first, smaller textures then fill the gaps.
+	std::vector<size_t> order(m_requests.size());
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+		return placements[lhs].size > placements[rhs].size;
+	});
+
+	uint64_t heapSizes[2] = { 0, 0 };
+	uint64_t heapAlignments[2] = { HEAP_ALIGNMENT, HEAP_ALIGNMENT };
+	std::vector<size_t> placed;
+	for (size_t index : order) {
+		Placement& placement = placements[index];
+		const Request& request = m_requests[index];
+
+		// Move past every placed texture that is alive at the same time and overlaps in memory, until none does.
+		bool moved = true;
+		while (moved) {
+			moved = false;
+			for (size_t other : placed) {
+				const Placement& otherPlacement = placements[other];
+				const Request& otherRequest = m_requests[other];
+				bool sameTime = request.firstTask <= otherRequest.lastTask && otherRequest.firstTask <= request.lastTask;
+				bool sameMemory = placement.offset < otherPlacement.offset + otherPlacement.size && otherPlacement.offset < placement.offset + placement.size;
+				if (otherPlacement.heap == placement.heap && sameTime && sameMemory) {
+					uint64_t end = otherPlacement.offset + otherPlacement.size;
+					placement.offset = (end + placement.alignment - 1) / placement.alignment * placement.alignment;
+					moved = true;
+				}
+			}
+		}
+
+		placed.push_back(index);
+		heapSizes[placement.heap] = std::max(heapSizes[placement.heap], placement.offset + placement.size);
+		heapAlignments[placement.heap] = std::max(heapAlignments[placement.heap], placement.alignment);
+	}
+
+	// Create the heaps, placed textures keep them alive.
+	std::shared_ptr<gxapi::IHeap> heaps[2];
+	const gxapi::eHeapFlags heapFlags[2] = { gxapi::eHeapFlags::ALLOW_ONLY_RT_DS_TEXTURES, gxapi::eHeapFlags::ALLOW_ONLY_NON_RT_DS_TEXTURES };
+	m_statistics = {};
+	for (int heap = 0; heap < 2; ++heap) {
+		if (heapSizes[heap] > 0) {
+			uint64_t size = (heapSizes[heap] + heapAlignments[heap] - 1) / heapAlignments[heap] * heapAlignments[heap];
+			gxapi::HeapDesc heapDesc{ size, gxapi::HeapProperties(gxapi::eHeapType::DEFAULT), heapFlags[heap], heapAlignments[heap] };
+			heaps[heap].reset(m_graphicsApi->CreateHeap(heapDesc));
+			m_statistics.heapBytes += size;
+		}
+	}
+
+	m_previousPlan = std::move(m_plan);
+	m_plan.clear();
+	for (size_t i = 0; i < m_requests.size(); ++i) {
+		const Request& request = m_requests[i];
+		const Placement& placement = placements[i];
+
+		std::optional<gxapi::ClearValue> clearValue = MemoryManager::GetDefaultClearValue(request.desc);
+		gxapi::IResource* resource = m_graphicsApi->CreatePlacedResource(
+			heaps[placement.heap].get(),
+			placement.offset,
+			request.desc,
+			gxapi::eResourceState::COMMON,
+			clearValue ? &clearValue.value() : nullptr);
+
+		MemoryObjDesc objectDesc;
+		std::shared_ptr<gxapi::IHeap> heap = heaps[placement.heap];
+		objectDesc.resource = MemoryObjDesc::UniqPtr(resource, [heap](gxapi::IResource* ptr) {
+			delete ptr;
+		});
+		objectDesc.resident = true;
+		objectDesc.heap = eResourceHeap::CRITICAL;
+
+		m_plan.push_back({ request.desc, Texture2D(std::move(objectDesc)), request.firstTask, request.lastTask });
+
+		++m_statistics.numTextures;
+		m_statistics.textureBytes += placement.size;
+	}
+}
+
+
+bool TransientResourcePool::IsSameDesc(const gxapi::ResourceDesc& lhs, const gxapi::ResourceDesc& rhs) {
+	const gxapi::TextureDesc& l = lhs.textureDesc;
+	const gxapi::TextureDesc& r = rhs.textureDesc;
+	return l.width == r.width
+		&& l.height == r.height
+		&& l.depthOrArraySize == r.depthOrArraySize
+		&& l.mipLevels == r.mipLevels
+		&& l.format == r.format
+		&& l.flags == r.flags;
+}
+
+
+bool TransientResourcePool::IsRenderTargetOrDepth(const gxapi::ResourceDesc& desc) {
+	return bool(desc.textureDesc.flags & (gxapi::eResourceFlags::ALLOW_RENDER_TARGET | gxapi::eResourceFlags::ALLOW_DEPTH_STENCIL));
+}
+
+
+} // namespace inl::gxeng
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "MemoryObject.hpp"
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IHeap.hpp"
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+
+namespace inl::gxeng {
+
+
+class MemoryManager;
+struct Texture2DDesc;
+
+
+/// <summary> Memory saved by aliasing the transient textures of the current plan. </summary>
+struct TransientResourceStatistics {
+	size_t numTextures = 0;
+	uint64_t textureBytes = 0; /// <summary> Memory the textures would take without aliasing. </summary>
+	uint64_t heapBytes = 0; /// <summary> Memory actually allocated for them. </summary>
+};
+
+
+/// <summary>
+/// Places the transient textures of a pipeline into shared heaps, textures that are
+/// never alive at the same time overlapping in memory.
+/// <para/>
+/// Tasks request their transient textures in Setup, every frame. A texture is alive from the first
+/// to the last task, in submission order, that requests it or creates a view of it during setup.
+/// The lifetimes of a frame are used to plan the memory of the following frames, so the first frame
+/// after the pipeline or its requests change gets dedicated textures.
+/// </summary>
+/// <remarks>
+/// The content of a transient texture is undefined when its first task begins, that task
+/// must clear it. Not thread safe, the setup phase runs tasks one after another.
+/// </remarks>
+class TransientResourcePool {
+public:
+	TransientResourcePool() = default;
+	TransientResourcePool(const TransientResourcePool&) = delete;
+	TransientResourcePool& operator=(const TransientResourcePool&) = delete;
+
+	/// <summary> Starts collecting the requests of a frame's setup phase. </summary>
+	/// <param name="dedicated"> Every request gets a dedicated texture, and the plan is left as it is. </param>
+	void BeginFrame(MemoryManager* memoryManager, gxapi::IGraphicsApi* graphicsApi, bool dedicated = false);
+
+	/// <summary> Ends the setup phase. Plans the memory again if the requests or their lifetimes changed. </summary>
+	/// <returns> False if an aliased texture was used outside its planned lifetime in this frame.
+	///		The textures of the frame may overlap, set it up again with dedicated textures. </returns>
+	bool EndFrame();
+
+	/// <summary> Forgets the plan, call it when the pipeline changes. </summary>
+	void Reset();
+
+	Texture2D CreateTexture2D(const Texture2DDesc& desc, gxapi::eResourceFlags flags, unsigned taskIndex);
+
+	/// <summary> Extends the lifetime of the texture to the task, if it's a transient one. </summary>
+	void Use(const MemoryObject& texture, unsigned taskIndex);
+
+	/// <summary> Aliased textures whose lifetime begins in the task. </summary>
+	/// <remarks> An aliasing barrier must precede the task's commands. </remarks>
+	const std::vector<gxapi::IResource*>& GetActivations(unsigned taskIndex) const;
+
+	TransientResourceStatistics GetStatistics() const { return m_statistics; }
+private:
+	struct Request {
+		gxapi::ResourceDesc desc;
+		Texture2D texture;
+		unsigned firstTask;
+		unsigned lastTask;
+		bool aliased; /// <summary> The texture is from the plan, not a dedicated one. </summary>
+	};
+
+	struct PlannedTexture {
+		gxapi::ResourceDesc desc;
+		Texture2D texture;
+		unsigned firstTask;
+		unsigned lastTask;
+	};
+
+	/// <summary> Places the textures of the current requests, and creates heaps and textures for them. </summary>
+	void Plan();
+
+	static bool IsSameDesc(const gxapi::ResourceDesc& lhs, const gxapi::ResourceDesc& rhs);
+	static bool IsRenderTargetOrDepth(const gxapi::ResourceDesc& desc);
+
+	static constexpr uint64_t HEAP_ALIGNMENT = 64 * 1024;
+private:
+	MemoryManager* m_memoryManager = nullptr;
+	gxapi::IGraphicsApi* m_graphicsApi = nullptr;
+
+	std::vector<Request> m_requests; // of the current frame, in the order they came
+	std::unordered_map<const gxapi::IResource*, size_t> m_requestIndices;
+	bool m_diverged = false; // a request didn't match the plan, the rest get dedicated textures too
+	bool m_dedicated = false; // no request of the frame is aliased
+
+	std::vector<PlannedTexture> m_plan; // same order as the requests
+	std::vector<PlannedTexture> m_previousPlan; // kept until the frame that used it is recorded
+	std::vector<std::vector<gxapi::IResource*>> m_activations; // indexed by task
+	TransientResourceStatistics m_statistics;
+};
+
+
+} // namespace inl::gxeng
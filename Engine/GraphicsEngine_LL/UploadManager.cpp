@@ -4,15 +4,15 @@
 #include <BaseLibrary/Exception/Exception.hpp>
 
 #include <cassert>
-#include <sstream>
-#include <atomic>
+#include <cstring>
 
 namespace inl {
 namespace gxeng {
 
 
 UploadManager::UploadManager(gxapi::IGraphicsApi* graphicsApi) :
-	m_graphicsApi(graphicsApi)
+	m_graphicsApi(graphicsApi),
+	m_stagingAllocator(STAGING_RING_SIZE / STAGING_CELL_SIZE)
 {
 	std::lock_guard<std::mutex> lock(m_mtx);
 
@@ -21,6 +21,13 @@ UploadManager::UploadManager(gxapi::IGraphicsApi* graphicsApi) :
 	//UploadFrame uploadFrame;
 	//uploadFrame.frameId = 0;
 	//m_uploadFrames.push_back(uploadFrame);
+
+	// The ring stays mapped for the lifetime of the manager, writes are never read back by the CPU.
+	m_stagingRing = CreateUploadBuffer(STAGING_RING_SIZE);
+	m_stagingRing._GetResourcePtr()->SetName("Upload staging ring");
+	m_stagingRing._SetResident(true);
+	gxapi::MemoryRange noReadRange{ 0, 0 };
+	m_stagingRingData = reinterpret_cast<uint8_t*>(m_stagingRing._GetResourcePtr()->Map(0, &noReadRange));
 }
 
 
@@ -29,48 +36,33 @@ void UploadManager::Upload(const LinearBuffer& target, size_t offset, const void
 		throw InvalidArgumentException("Target buffer is not large enough for the uploaded data to fit.", "target");
 	}
 
-	MemoryObjDesc uploadObjDesc(
-		m_graphicsApi->CreateCommittedResource(
-			gxapi::HeapProperties(gxapi::eHeapType::UPLOAD),
-			gxapi::eHeapFlags::NONE,
-			gxapi::ResourceDesc::Buffer(size),
-			//NOTE: GENERIC_READ is the required starting state for upload heap resources according to msdn
-			// (also there is no need for resource state transition)
-			gxapi::eResourceState::GENERIC_READ
-		),
-		eResourceHeap::UPLOAD
-	);
-
-	// DEBUG
-	static std::atomic_uint64_t counter = 0;
-	std::stringstream ss;
-	ss << "Buffer upload source" << counter++;
-	uploadObjDesc.resource->SetName(ss.str().c_str());
-	// DEBUG
-
-	auto uploadResource = uploadObjDesc.resource.get();
-
+	StagingSpace staging;
 	{
 		std::lock_guard<std::mutex> lock(m_mtx);
 
+		staging = AllocateStagingSpace(size);
+
 		//auto& currQueue = m_uploadQueues.back();
 		std::vector<UploadDescription>& currQueue = m_uploadFrames.back().uploads;
 
+		// The target may be a range of a shared buffer, the copy addresses the whole resource.
 		UploadDescription uploadDesc(
-			LinearBuffer(std::move(uploadObjDesc)),
+			LinearBuffer(staging.buffer),
+			staging.offset,
 			target,
-			offset
+			target.GetOffset() + offset,
+			size
 		);
 
 		currQueue.push_back(std::move(uploadDesc));
 	}
 
-	gxapi::MemoryRange noReadRange{ 0, 0 };
-	void* stagePtr = uploadResource->Map(0, &noReadRange);
-	memcpy(stagePtr, data, size);
-	// Theres no need to unmap but leaving a resource mapped has a performance hit while debugging
-	// see https://msdn.microsoft.com/en-us/library/windows/desktop/dn899215(v=vs.85).aspx#mapping_and_unmapping
-	uploadResource->Unmap(0, nullptr);
+	memcpy(staging.data, data, size);
+	if (staging.isDedicated) {
+		// Theres no need to unmap but leaving a resource mapped has a performance hit while debugging
+		// see https://msdn.microsoft.com/en-us/library/windows/desktop/dn899215(v=vs.85).aspx#mapping_and_unmapping
+		staging.buffer._GetResourcePtr()->Unmap(0, nullptr);
+	}
 }
 
 
@@ -94,41 +86,24 @@ void UploadManager::Upload(
 	size_t rowPitch = SnapUpwrads(rowSize, DUP_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
 	auto requiredSize = bytesPerRow > 0 ? bytesPerRow : rowPitch * height;
 
-	MemoryObjDesc uploadObjDesc = MemoryObjDesc(
-		m_graphicsApi->CreateCommittedResource(
-			gxapi::HeapProperties(gxapi::eHeapType::UPLOAD),
-			gxapi::eHeapFlags::NONE,
-			gxapi::ResourceDesc::Buffer(requiredSize),
-			//NOTE: GENERIC_READ is the required starting state for upload heap resources according to msdn
-			// (also there is no need for resource state transition)
-			gxapi::eResourceState::GENERIC_READ
-		),
-		eResourceHeap::UPLOAD
-	);
-
-	// DEBUG
-	static std::atomic_uint64_t counter = 0;
-	std::stringstream ss;
-	ss << "Texture upload source" << counter++;
-	uploadObjDesc.resource->SetName(ss.str().c_str());
-	// DEBUG
-
-	auto uploadResource = uploadObjDesc.resource.get();
-
+	StagingSpace staging;
 	{
 		std::lock_guard<std::mutex> lock(m_mtx);
 
+		staging = AllocateStagingSpace(requiredSize);
+
 		//auto& currQueue = m_uploadQueues.back();
 		std::vector<UploadDescription>& currQueue = m_uploadFrames.back().uploads;
 
 		UploadDescription uploadDesc(
-			LinearBuffer(std::move(uploadObjDesc)),
+			LinearBuffer(staging.buffer),
+			staging.offset,
 			target,
 			subresource,
 			offsetX,
 			offsetY,
 			0,
-			gxapi::TextureCopyDesc::Buffer(format, width, height, 1, 0)
+			gxapi::TextureCopyDesc::Buffer(format, width, height, 1, staging.offset)
 		);
 
 		currQueue.push_back(std::move(uploadDesc));
@@ -136,14 +111,14 @@ void UploadManager::Upload(
 		currQueue.back().source._SetResident(true);
 	}
 
-	gxapi::MemoryRange noReadRange{ 0, 0 };
-	auto stagePtr = reinterpret_cast<uint8_t*>(uploadResource->Map(0, &noReadRange));
 	auto byteData = reinterpret_cast<const uint8_t*>(data);
 	//copy texture row-by-row
 	for (size_t y = 0; y < height; y++) {
-		memcpy(stagePtr + rowPitch*y, byteData + rowSize*y, rowSize);
+		memcpy(staging.data + rowPitch*y, byteData + rowSize*y, rowSize);
+	}
+	if (staging.isDedicated) {
+		staging.buffer._GetResourcePtr()->Unmap(0, nullptr);
 	}
-	uploadResource->Unmap(0, nullptr);
 }
 
 
@@ -161,6 +136,11 @@ void UploadManager::OnFrameCompleteDevice(uint64_t frameId) {
 	// loop may be removed
 	int framesPopped = 0;
 	while (!m_uploadFrames.empty() && m_uploadFrames.front().frameId <= frameId) {
+		UploadFrame& frame = m_uploadFrames.front();
+		for (size_t cell : frame.stagingAllocations) {
+			m_stagingAllocator.Deallocate(cell);
+		}
+		m_lastFrameStats = frame.stats;
 		m_uploadFrames.pop_front();
 		++framesPopped;
 	}
@@ -189,6 +169,58 @@ const std::vector<UploadManager::UploadDescription>& UploadManager::GetQueuedUpl
 }
 
 
+UploadManager::UploadStats UploadManager::GetLastFrameStats() const {
+	std::lock_guard<std::mutex> lock(m_mtx);
+	return m_lastFrameStats;
+}
+
+
+auto UploadManager::AllocateStagingSpace(size_t size) -> StagingSpace {
+	UploadFrame& frame = m_uploadFrames.back();
+	++frame.stats.numUploads;
+
+	if (size < LARGE_UPLOAD_SIZE) {
+		size_t numCells = (size + STAGING_CELL_SIZE - 1) / STAGING_CELL_SIZE;
+		try {
+			size_t cell = m_stagingAllocator.Allocate(numCells > 0 ? numCells : 1);
+			frame.stagingAllocations.push_back(cell);
+			frame.stats.bytesStaged += size;
+
+			size_t offset = cell * STAGING_CELL_SIZE;
+			return { m_stagingRing, offset, m_stagingRingData + offset, false };
+		}
+		catch (std::bad_alloc&) {
+			// The ring is full of data the GPU has not consumed yet, fall back to a dedicated resource.
+		}
+	}
+
+	frame.stats.numDedicatedUploads += 1;
+	frame.stats.bytesDedicated += size;
+
+	LinearBuffer buffer = CreateUploadBuffer(size);
+	buffer._GetResourcePtr()->SetName("Large upload source");
+	gxapi::MemoryRange noReadRange{ 0, 0 };
+	uint8_t* data = reinterpret_cast<uint8_t*>(buffer._GetResourcePtr()->Map(0, &noReadRange));
+	return { std::move(buffer), 0, data, true };
+}
+
+
+LinearBuffer UploadManager::CreateUploadBuffer(size_t size) {
+	MemoryObjDesc uploadObjDesc(
+		m_graphicsApi->CreateCommittedResource(
+			gxapi::HeapProperties(gxapi::eHeapType::UPLOAD),
+			gxapi::eHeapFlags::NONE,
+			gxapi::ResourceDesc::Buffer(size),
+			//NOTE: GENERIC_READ is the required starting state for upload heap resources according to msdn
+			// (also there is no need for resource state transition)
+			gxapi::eResourceState::GENERIC_READ
+		),
+		eResourceHeap::UPLOAD
+	);
+	return LinearBuffer(std::move(uploadObjDesc));
+}
+
+
 
 size_t UploadManager::SnapUpwrads(size_t value, size_t gridSize) {
 	// alignement should be power of two
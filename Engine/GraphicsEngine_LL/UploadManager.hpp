@@ -3,6 +3,8 @@
 #include "PipelineEventListener.hpp"
 #include "MemoryObject.hpp"
 
+#include <BaseLibrary/Memory/RingAllocationEngine.hpp>
+
 #include <utility>
 #include <mutex>
 #include <deque>
@@ -16,19 +18,23 @@ class UploadManager : public PipelineEventListener {
 public:
 	enum class DestType { BUFFER, TEXTURE_2D };
 	struct UploadDescription {
-		UploadDescription(LinearBuffer&& source,
+		UploadDescription(LinearBuffer&& source, size_t srcOffset,
 						  const LinearBuffer& destination,
-						  size_t bufferOffset) :
+						  size_t bufferOffset, size_t size) :
 			source(std::move(source)),
+			srcOffset(srcOffset),
+			size(size),
 			destination(destination),
 			destType(DestType::BUFFER),
 			dstOffsetX(bufferOffset) {}
 
-		UploadDescription(LinearBuffer&& source,
+		UploadDescription(LinearBuffer&& source, size_t srcOffset,
 						  const Texture2D& destination, unsigned dstSubresource,
 						  size_t dstOffsetX, uint32_t dstOffsetY, uint32_t dstOffsetZ,
 						  gxapi::TextureCopyDesc textureBufferDesc) :
 			source(std::move(source)),
+			srcOffset(srcOffset),
+			size(0),
 			destination(destination),
 			dstSubresource(dstSubresource),
 			destType(DestType::TEXTURE_2D),
@@ -36,25 +42,44 @@ public:
 			textureBufferDesc(textureBufferDesc) {}
 		
 		LinearBuffer source;
+		size_t srcOffset; // where the data starts in source
+		size_t size; // number of bytes to copy, only for buffers
 
 		// Destination is a weak pointer because it might get deleted before
 		// the graphics engine starts to process the request.
 		MemoryObject destination;
 		DestType destType;
 
-		size_t dstOffsetX; // also offset in linear buffer
+		size_t dstOffsetX; // also offset in the linear buffer's resource
 		uint32_t dstOffsetY;
 		uint32_t dstOffsetZ;
 		unsigned dstSubresource;
 
 		gxapi::TextureCopyDesc textureBufferDesc;
 	};
+
+	/// <summary> Statistics of the uploads issued during one frame. </summary>
+	struct UploadStats {
+		size_t numUploads = 0;
+		size_t bytesStaged = 0; /// <summary> Bytes placed in the staging ring. </summary>
+		size_t numDedicatedUploads = 0;
+		size_t bytesDedicated = 0; /// <summary> Bytes placed in their own upload resources. </summary>
+	};
 private:
 	struct UploadFrame {
 		std::vector<UploadDescription> uploads;
+		std::vector<size_t> stagingAllocations; // freed when the frame completes on the device
+		UploadStats stats;
 		uint64_t frameId;
 	};
 
+	struct StagingSpace {
+		LinearBuffer buffer;
+		size_t offset;
+		uint8_t* data;
+		bool isDedicated;
+	};
+
 public:
 	UploadManager(gxapi::IGraphicsApi* graphicsApi);
 
@@ -70,16 +95,35 @@ public:
 	void OnFrameCompleteHost(uint64_t frameId) override;
 
 	const std::vector<UploadDescription>& GetQueuedUploads() const;
+
+	/// <summary> Returns the statistics of the last frame the device has finished. </summary>
+	UploadStats GetLastFrameStats() const;
 protected:
 	gxapi::IGraphicsApi* m_graphicsApi;
 	std::list<UploadFrame> m_uploadFrames;
+	UploadStats m_lastFrameStats;
+
+	// Persistently mapped staging buffer shared by all small uploads.
+	LinearBuffer m_stagingRing;
+	uint8_t* m_stagingRingData;
+	RingAllocationEngine m_stagingAllocator;
 
 	mutable std::mutex m_mtx;
 
 protected:
 	static constexpr int DUP_D3D12_TEXTURE_DATA_PITCH_ALIGNMENT = 256;
+	static constexpr int DUP_D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT = 512;
+
+	static constexpr size_t STAGING_RING_SIZE = 64 * 1024 * 1024;
+	static constexpr size_t STAGING_CELL_SIZE = DUP_D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+	static constexpr size_t LARGE_UPLOAD_SIZE = STAGING_RING_SIZE / 4; // uploads at least this large get their own resource
 
 private:
+	/// <summary> Reserves staging memory for the current frame, from the ring if it fits, otherwise in a new resource. </summary>
+	/// <remarks> Must be called with the mutex locked. </remarks>
+	StagingSpace AllocateStagingSpace(size_t size);
+	LinearBuffer CreateUploadBuffer(size_t size);
+
 	static size_t SnapUpwrads(size_t value, size_t gridSize);
 };
 
@@ -3,35 +3,389 @@
 #include <BaseLibrary/ArrayView.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
 
 
 namespace inl::gxeng {
 
 
 
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+namespace {
+
+int16_t ToSnorm16(float value) {
+	return int16_t(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+int8_t ToSnorm8(float value) {
+	return int8_t(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+uint16_t ToUnorm16(float value) {
+	return uint16_t(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+uint8_t ToUnorm8(float value) {
+	return uint8_t(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+
+// Batches are processed 4 vertices at a time, with the components of the 4 vertices in separate registers.
+
+struct Float4x3 {
+	__m128 x, y, z;
+};
+
+Float4x3 Gather3(const uint8_t* input, size_t stride) {
+	const float* v0 = reinterpret_cast<const float*>(input);
+	const float* v1 = reinterpret_cast<const float*>(input + stride);
+	const float* v2 = reinterpret_cast<const float*>(input + 2 * stride);
+	const float* v3 = reinterpret_cast<const float*>(input + 3 * stride);
+	return {
+		_mm_setr_ps(v0[0], v1[0], v2[0], v3[0]),
+		_mm_setr_ps(v0[1], v1[1], v2[1], v3[1]),
+		_mm_setr_ps(v0[2], v1[2], v2[2], v3[2]),
+	};
+}
+
+__m128 Select(__m128 mask, __m128 ifTrue, __m128 ifFalse) {
+	return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+__m128 Clamp(__m128 value, float minimum, float maximum) {
+	return _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(minimum)), _mm_set1_ps(maximum));
+}
+
+// Same rounding as std::round, half away from zero.
+__m128i ToSnorm4(__m128 value, float scale) {
+	__m128 scaled = _mm_mul_ps(Clamp(value, -1.0f, 1.0f), _mm_set1_ps(scale));
+	__m128 half = _mm_or_ps(_mm_set1_ps(0.5f), _mm_and_ps(scaled, _mm_set1_ps(-0.0f)));
+	return _mm_cvttps_epi32(_mm_add_ps(scaled, half));
+}
+
+__m128i ToUnorm4(__m128 value, float scale) {
+	__m128 scaled = _mm_mul_ps(Clamp(value, 0.0f, 1.0f), _mm_set1_ps(scale));
+	return _mm_cvttps_epi32(_mm_add_ps(scaled, _mm_set1_ps(0.5f)));
+}
+
+// Same as NormalCompressor::EncodeOctahedral.
+void EncodeOctahedral4(const Float4x3& normal, __m128& outX, __m128& outY) {
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+
+	__m128 length = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, normal.x), _mm_andnot_ps(signMask, normal.y)), _mm_andnot_ps(signMask, normal.z));
+	__m128 nonZero = _mm_cmpneq_ps(length, zero);
+	__m128 x = _mm_and_ps(nonZero, _mm_div_ps(normal.x, length));
+	__m128 y = _mm_and_ps(nonZero, _mm_div_ps(normal.y, length));
+
+	__m128 foldedX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, y)), Select(_mm_cmpge_ps(x, zero), one, minusOne));
+	__m128 foldedY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), Select(_mm_cmpge_ps(y, zero), one, minusOne));
+	__m128 lowerHalf = _mm_cmplt_ps(normal.z, zero);
+	outX = Select(lowerHalf, foldedX, x);
+	outY = Select(lowerHalf, foldedY, y);
+}
+
+// Writes the 4 lanes of each register as consecutive components of the 4 vertices.
+template <class T, int NumComponents>
+void Scatter(const std::array<__m128i, NumComponents>& components, uint8_t* output, size_t stride) {
+	alignas(16) int32_t lanes[NumComponents][4];
+	for (int c = 0; c < NumComponents; ++c) {
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes[c]), components[c]);
+	}
+	for (int v = 0; v < 4; ++v) {
+		T* out = reinterpret_cast<T*>(output + v * stride);
+		for (int c = 0; c < NumComponents; ++c) {
+			out[c] = T(lanes[c][v]);
+		}
+	}
+}
+
+} // namespace
+
+
+
 //------------------------------------------------------------------------------
 // Semantic compressor implementations
 //------------------------------------------------------------------------------
 
 
+void SemanticCompressor::CompressBatch(const CompressionBatch& batch) const {
+	// Batches without dependencies compress the element alone.
+	const size_t numDependencies = batch.dependencies[0] != nullptr ? GetDependencies().size() : 0;
+	std::array<const void*, 4> dependencies;
+	for (size_t i = 0; i < batch.count; ++i) {
+		const uint8_t* input = batch.input + i * batch.inputStride;
+		uint8_t* output = batch.output + i * batch.outputStride;
+		if (numDependencies == 0) {
+			Compress(input, output);
+		}
+		else {
+			for (size_t d = 0; d < numDependencies; ++d) {
+				dependencies[d] = batch.dependencies[d] + i * batch.inputStride;
+			}
+			Compress(input, dependencies.data(), output);
+		}
+	}
+}
+
+
+
+
+NormalCompressor::NormalCompressor(eNormalCompression compression)
+	: m_compression(compression)
+{
+	assert(compression != eNormalCompression::NONE);
+}
 void NormalCompressor::Compress(const void* input, void* output) const {
 	using InputT = VertexPartReader<eVertexElementSemantic::NORMAL>::DataType;
 
 	const InputT* in = reinterpret_cast<const InputT*>(input);
-	Vec3_Packed* out = reinterpret_cast<Vec3_Packed*>(output);
+	Vec2 encoded = EncodeOctahedral(Vec3(in->x, in->y, in->z));
 
-	out->x = in->x;
-	out->y = in->y;
-	out->z = in->z;
+	if (m_compression == eNormalCompression::OCTAHEDRAL_16) {
+		int16_t* out = reinterpret_cast<int16_t*>(output);
+		out[0] = ToSnorm16(encoded.x);
+		out[1] = ToSnorm16(encoded.y);
+	}
+	else {
+		int8_t* out = reinterpret_cast<int8_t*>(output);
+		out[0] = ToSnorm8(encoded.x);
+		out[1] = ToSnorm8(encoded.y);
+	}
+}
+void NormalCompressor::CompressBatch(const CompressionBatch& batch) const {
+	size_t count = batch.count & ~size_t(3);
+	for (size_t i = 0; i < count; i += 4) {
+		__m128 x, y;
+		EncodeOctahedral4(Gather3(batch.input + i * batch.inputStride, batch.inputStride), x, y);
+
+		uint8_t* output = batch.output + i * batch.outputStride;
+		if (m_compression == eNormalCompression::OCTAHEDRAL_16) {
+			Scatter<int16_t, 2>({ ToSnorm4(x, 32767.0f), ToSnorm4(y, 32767.0f) }, output, batch.outputStride);
+		}
+		else {
+			Scatter<int8_t, 2>({ ToSnorm4(x, 127.0f), ToSnorm4(y, 127.0f) }, output, batch.outputStride);
+		}
+	}
+	SemanticCompressor::CompressBatch(batch.Subrange(count));
 }
 int NormalCompressor::Size() const {
-	return sizeof(Vec3_Packed);
+	return m_compression == eNormalCompression::OCTAHEDRAL_16 ? 2 * sizeof(int16_t) : 2 * sizeof(int8_t);
+}
+gxapi::eFormat NormalCompressor::Format() const {
+	return m_compression == eNormalCompression::OCTAHEDRAL_16 ? gxapi::eFormat::R16G16_SNORM : gxapi::eFormat::R8G8_SNORM;
 }
 bool NormalCompressor::IsSupported(eVertexElementSemantic semantic) const {
 	return semantic == eVertexElementSemantic::NORMAL
 		|| semantic == eVertexElementSemantic::TANGENT
 		|| semantic == eVertexElementSemantic::BITANGENT;
 }
+Vec2 NormalCompressor::EncodeOctahedral(const Vec3& normal) {
+	// Project onto the octahedron |x|+|y|+|z| = 1, then fold the lower half over the upper one.
+	float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if (length == 0.0f) {
+		return { 0.0f, 0.0f };
+	}
+	float x = normal.x / length;
+	float y = normal.y / length;
+	if (normal.z < 0.0f) {
+		float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	return { x, y };
+}
+
+
+
+
+TangentFrameCompressor::TangentFrameCompressor(eNormalCompression compression)
+	: m_compression(compression)
+{
+	assert(compression != eNormalCompression::NONE);
+}
+void TangentFrameCompressor::Compress(const void* input, void* output) const {
+	using InputT = VertexPartReader<eVertexElementSemantic::TANGENT>::DataType;
+
+	const InputT* in = reinterpret_cast<const InputT*>(input);
+	Compress(Vec3(in->x, in->y, in->z), 1.0f, output);
+}
+void TangentFrameCompressor::Compress(const void* input, const void* const* dependencies, void* output) const {
+	using InputT = VertexPartReader<eVertexElementSemantic::TANGENT>::DataType;
+
+	const InputT* t = reinterpret_cast<const InputT*>(input);
+	const InputT* n = reinterpret_cast<const InputT*>(dependencies[0]);
+	const InputT* b = reinterpret_cast<const InputT*>(dependencies[1]);
+
+	// Sign of dot(cross(normal, tangent), bitangent).
+	float cx = n->y * t->z - n->z * t->y;
+	float cy = n->z * t->x - n->x * t->z;
+	float cz = n->x * t->y - n->y * t->x;
+	float handedness = cx * b->x + cy * b->y + cz * b->z < 0.0f ? -1.0f : 1.0f;
+
+	Compress(Vec3(t->x, t->y, t->z), handedness, output);
+}
+void TangentFrameCompressor::Compress(const Vec3& tangent, float handedness, void* output) const {
+	Vec2 encoded = NormalCompressor::EncodeOctahedral(tangent);
+
+	if (m_compression == eNormalCompression::OCTAHEDRAL_16) {
+		int16_t* out = reinterpret_cast<int16_t*>(output);
+		out[0] = ToSnorm16(encoded.x);
+		out[1] = ToSnorm16(encoded.y);
+		out[2] = ToSnorm16(handedness);
+		out[3] = 0;
+	}
+	else {
+		int8_t* out = reinterpret_cast<int8_t*>(output);
+		out[0] = ToSnorm8(encoded.x);
+		out[1] = ToSnorm8(encoded.y);
+		out[2] = ToSnorm8(handedness);
+		out[3] = 0;
+	}
+}
+void TangentFrameCompressor::CompressBatch(const CompressionBatch& batch) const {
+	if (batch.dependencies[0] == nullptr) { // the tangent alone, not called by the vertex compressor
+		SemanticCompressor::CompressBatch(batch);
+		return;
+	}
+
+	size_t count = batch.count & ~size_t(3);
+	for (size_t i = 0; i < count; i += 4) {
+		size_t inputOffset = i * batch.inputStride;
+		Float4x3 t = Gather3(batch.input + inputOffset, batch.inputStride);
+		Float4x3 n = Gather3(batch.dependencies[0] + inputOffset, batch.inputStride);
+		Float4x3 b = Gather3(batch.dependencies[1] + inputOffset, batch.inputStride);
+
+		// Sign of dot(cross(normal, tangent), bitangent).
+		__m128 cx = _mm_sub_ps(_mm_mul_ps(n.y, t.z), _mm_mul_ps(n.z, t.y));
+		__m128 cy = _mm_sub_ps(_mm_mul_ps(n.z, t.x), _mm_mul_ps(n.x, t.z));
+		__m128 cz = _mm_sub_ps(_mm_mul_ps(n.x, t.y), _mm_mul_ps(n.y, t.x));
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(cx, b.x), _mm_mul_ps(cy, b.y)), _mm_mul_ps(cz, b.z));
+		__m128 handedness = Select(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-1.0f), _mm_set1_ps(1.0f));
+
+		__m128 x, y;
+		EncodeOctahedral4(t, x, y);
+
+		uint8_t* output = batch.output + i * batch.outputStride;
+		if (m_compression == eNormalCompression::OCTAHEDRAL_16) {
+			Scatter<int16_t, 4>({ ToSnorm4(x, 32767.0f), ToSnorm4(y, 32767.0f), ToSnorm4(handedness, 32767.0f), _mm_setzero_si128() }, output, batch.outputStride);
+		}
+		else {
+			Scatter<int8_t, 4>({ ToSnorm4(x, 127.0f), ToSnorm4(y, 127.0f), ToSnorm4(handedness, 127.0f), _mm_setzero_si128() }, output, batch.outputStride);
+		}
+	}
+	SemanticCompressor::CompressBatch(batch.Subrange(count));
+}
+int TangentFrameCompressor::Size() const {
+	return m_compression == eNormalCompression::OCTAHEDRAL_16 ? 4 * sizeof(int16_t) : 4 * sizeof(int8_t);
+}
+gxapi::eFormat TangentFrameCompressor::Format() const {
+	return m_compression == eNormalCompression::OCTAHEDRAL_16 ? gxapi::eFormat::R16G16B16A16_SNORM : gxapi::eFormat::R8G8B8A8_SNORM;
+}
+bool TangentFrameCompressor::IsSupported(eVertexElementSemantic semantic) const {
+	return semantic == eVertexElementSemantic::TANGENT;
+}
+const std::vector<eVertexElementSemantic>& TangentFrameCompressor::GetDependencies() const {
+	static const std::vector<eVertexElementSemantic> dependencies = { eVertexElementSemantic::NORMAL, eVertexElementSemantic::BITANGENT };
+	return dependencies;
+}
+
+
+
+
+TexCoordCompressor::TexCoordCompressor(eTexCoordCompression compression)
+	: m_compression(compression)
+{
+	assert(compression != eTexCoordCompression::NONE);
+}
+void TexCoordCompressor::Compress(const void* input, void* output) const {
+	using InputT = VertexPartReader<eVertexElementSemantic::TEX_COORD>::DataType;
+
+	const InputT* in = reinterpret_cast<const InputT*>(input);
+	uint16_t* out = reinterpret_cast<uint16_t*>(output);
+
+	if (m_compression == eTexCoordCompression::HALF) {
+		out[0] = FloatToHalf(in->x);
+		out[1] = FloatToHalf(in->y);
+	}
+	else {
+		out[0] = ToUnorm16(in->x);
+		out[1] = ToUnorm16(in->y);
+	}
+}
+void TexCoordCompressor::CompressBatch(const CompressionBatch& batch) const {
+	if (m_compression == eTexCoordCompression::HALF) {
+		// Conversion to half needs F16C for SIMD, only the dispatch is saved.
+		for (size_t i = 0; i < batch.count; ++i) {
+			const float* in = reinterpret_cast<const float*>(batch.input + i * batch.inputStride);
+			uint16_t* out = reinterpret_cast<uint16_t*>(batch.output + i * batch.outputStride);
+			out[0] = FloatToHalf(in[0]);
+			out[1] = FloatToHalf(in[1]);
+		}
+		return;
+	}
+
+	size_t count = batch.count & ~size_t(3);
+	for (size_t i = 0; i < count; i += 4) {
+		const float* v0 = reinterpret_cast<const float*>(batch.input + i * batch.inputStride);
+		const float* v1 = reinterpret_cast<const float*>(batch.input + (i + 1) * batch.inputStride);
+		const float* v2 = reinterpret_cast<const float*>(batch.input + (i + 2) * batch.inputStride);
+		const float* v3 = reinterpret_cast<const float*>(batch.input + (i + 3) * batch.inputStride);
+		__m128 u = _mm_setr_ps(v0[0], v1[0], v2[0], v3[0]);
+		__m128 v = _mm_setr_ps(v0[1], v1[1], v2[1], v3[1]);
+
+		Scatter<uint16_t, 2>({ ToUnorm4(u, 65535.0f), ToUnorm4(v, 65535.0f) }, batch.output + i * batch.outputStride, batch.outputStride);
+	}
+	SemanticCompressor::CompressBatch(batch.Subrange(count));
+}
+int TexCoordCompressor::Size() const {
+	return 2 * sizeof(uint16_t);
+}
+gxapi::eFormat TexCoordCompressor::Format() const {
+	return m_compression == eTexCoordCompression::HALF ? gxapi::eFormat::R16G16_FLOAT : gxapi::eFormat::R16G16_UNORM;
+}
+bool TexCoordCompressor::IsSupported(eVertexElementSemantic semantic) const {
+	return semantic == eVertexElementSemantic::TEX_COORD;
+}
+uint16_t TexCoordCompressor::FloatToHalf(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t biasedExponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	int exponent = int(biasedExponent) - 127 + 15;
+
+	if (biasedExponent == 0xFF) { // infinity or nan
+		return uint16_t(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+	}
+	if (exponent >= 31) { // too large, infinity
+		return uint16_t(sign | 0x7C00);
+	}
+	if (exponent <= 0) { // denormal or zero
+		if (exponent < -10) {
+			return uint16_t(sign);
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		half += (mantissa >> (shift - 1)) & 1; // round to nearest
+		return uint16_t(sign | half);
+	}
+
+	uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+	half += (mantissa >> 12) & 1; // round to nearest, a carry correctly moves into the exponent
+	return uint16_t(half);
+}
 
 
 
@@ -40,14 +394,28 @@ void ColorCompressor::Compress(const void* input, void* output) const {
 	using InputT = VertexPartReader<eVertexElementSemantic::COLOR>::DataType;
 
 	const InputT* in = reinterpret_cast<const InputT*>(input);
-	Vec3_Packed* out = reinterpret_cast<Vec3_Packed*>(output);
+	uint8_t* out = reinterpret_cast<uint8_t*>(output);
 
-	out->x = in->x;
-	out->y = in->y;
-	out->z = in->z;
+	out[0] = ToUnorm8(in->x);
+	out[1] = ToUnorm8(in->y);
+	out[2] = ToUnorm8(in->z);
+	out[3] = 255;
+}
+void ColorCompressor::CompressBatch(const CompressionBatch& batch) const {
+	const __m128i opaque = _mm_set1_epi32(255);
+
+	size_t count = batch.count & ~size_t(3);
+	for (size_t i = 0; i < count; i += 4) {
+		Float4x3 color = Gather3(batch.input + i * batch.inputStride, batch.inputStride);
+		Scatter<uint8_t, 4>({ ToUnorm4(color.x, 255.0f), ToUnorm4(color.y, 255.0f), ToUnorm4(color.z, 255.0f), opaque }, batch.output + i * batch.outputStride, batch.outputStride);
+	}
+	SemanticCompressor::CompressBatch(batch.Subrange(count));
 }
 int ColorCompressor::Size() const {
-	return sizeof(Vec3_Packed);
+	return 4 * sizeof(uint8_t);
+}
+gxapi::eFormat ColorCompressor::Format() const {
+	return gxapi::eFormat::R8G8B8A8_UNORM;
 }
 bool ColorCompressor::IsSupported(eVertexElementSemantic semantic) const {
 	return semantic == eVertexElementSemantic::COLOR;
@@ -55,15 +423,76 @@ bool ColorCompressor::IsSupported(eVertexElementSemantic semantic) const {
 
 
 
+
+void PositionCompressor::SetRange(const Vec3& offset, const Vec3& scale) {
+	m_offset = offset;
+	m_invScale = {
+		scale.x != 0.0f ? 1.0f / scale.x : 0.0f,
+		scale.y != 0.0f ? 1.0f / scale.y : 0.0f,
+		scale.z != 0.0f ? 1.0f / scale.z : 0.0f,
+	};
+}
+void PositionCompressor::Compress(const void* input, void* output) const {
+	using InputT = VertexPartReader<eVertexElementSemantic::POSITION>::DataType;
+
+	const InputT* in = reinterpret_cast<const InputT*>(input);
+	uint16_t* out = reinterpret_cast<uint16_t*>(output);
+
+	out[0] = ToUnorm16((in->x - m_offset.x) * m_invScale.x);
+	out[1] = ToUnorm16((in->y - m_offset.y) * m_invScale.y);
+	out[2] = ToUnorm16((in->z - m_offset.z) * m_invScale.z);
+	out[3] = 0;
+}
+void PositionCompressor::CompressBatch(const CompressionBatch& batch) const {
+	const __m128 offsetX = _mm_set1_ps(m_offset.x), offsetY = _mm_set1_ps(m_offset.y), offsetZ = _mm_set1_ps(m_offset.z);
+	const __m128 invScaleX = _mm_set1_ps(m_invScale.x), invScaleY = _mm_set1_ps(m_invScale.y), invScaleZ = _mm_set1_ps(m_invScale.z);
+
+	size_t count = batch.count & ~size_t(3);
+	for (size_t i = 0; i < count; i += 4) {
+		Float4x3 position = Gather3(batch.input + i * batch.inputStride, batch.inputStride);
+		__m128 x = _mm_mul_ps(_mm_sub_ps(position.x, offsetX), invScaleX);
+		__m128 y = _mm_mul_ps(_mm_sub_ps(position.y, offsetY), invScaleY);
+		__m128 z = _mm_mul_ps(_mm_sub_ps(position.z, offsetZ), invScaleZ);
+		Scatter<uint16_t, 4>({ ToUnorm4(x, 65535.0f), ToUnorm4(y, 65535.0f), ToUnorm4(z, 65535.0f), _mm_setzero_si128() }, batch.output + i * batch.outputStride, batch.outputStride);
+	}
+	SemanticCompressor::CompressBatch(batch.Subrange(count));
+}
+int PositionCompressor::Size() const {
+	return 4 * sizeof(uint16_t);
+}
+gxapi::eFormat PositionCompressor::Format() const {
+	return gxapi::eFormat::R16G16B16A16_UNORM;
+}
+bool PositionCompressor::IsSupported(eVertexElementSemantic semantic) const {
+	return semantic == eVertexElementSemantic::POSITION;
+}
+
+
+
 void PassthroughCompressor::Setup(eVertexElementSemantic semantic, const IVertexReader* reader) {
 	m_stride = (int)reader->GetSize(semantic);
 }
 void PassthroughCompressor::Compress(const void* input, void* output) const {
 	memcpy(output, input, m_stride);
 }
+void PassthroughCompressor::CompressBatch(const CompressionBatch& batch) const {
+	for (size_t i = 0; i < batch.count; ++i) {
+		memcpy(batch.output + i * batch.outputStride, batch.input + i * batch.inputStride, m_stride);
+	}
+}
 int PassthroughCompressor::Size() const {
 	return m_stride;
 }
+gxapi::eFormat PassthroughCompressor::Format() const {
+	// All vertex parts are made of floats.
+	switch (m_stride) {
+		case 4: return gxapi::eFormat::R32_FLOAT;
+		case 8: return gxapi::eFormat::R32G32_FLOAT;
+		case 12: return gxapi::eFormat::R32G32B32_FLOAT;
+		case 16: return gxapi::eFormat::R32G32B32A32_FLOAT;
+		default: return gxapi::eFormat::UNKNOWN;
+	}
+}
 bool PassthroughCompressor::IsSupported(eVertexElementSemantic semantic) const {
 	return true;
 }
@@ -76,13 +505,14 @@ bool PassthroughCompressor::IsSupported(eVertexElementSemantic semantic) const {
 
 VertexCompressor::VertexCompressor(
 	const IVertexReader* reader, 
-	const std::vector<bool>& elementMap) 
+	const std::vector<bool>& elementMap,
+	const VertexCompression& compression)
 {
 	assert(reader != nullptr);
 	m_reader = reader;
 
 	// Default compressors.
-	CreateDefaultCompressorList();
+	CreateDefaultCompressorList(compression);
 
 	// Create a filtered list that only has those elements that should be written to output.
 	const std::vector<IVertexReader::Element>& elements = reader->GetElements();
@@ -114,7 +544,21 @@ VertexCompressor::VertexCompressor(
 
 	// Fill elements.
 	for (auto& v : chosenElements) {
-		auto* compressor = AssignCompressor(v);
+		// The tangent of the same index carries the bitangent's sign, it's not stored.
+		// Tangents come before bitangents.
+		if (v.semantic == eVertexElementSemantic::BITANGENT) {
+			auto tangentFrame = std::find_if(m_elementsToCompress.begin(), m_elementsToCompress.end(), [&v](const CompressionElement& e) {
+				return e.sourceElement.semantic == eVertexElementSemantic::TANGENT
+					&& e.sourceElement.index == v.index
+					&& !e.assignedCompressor->GetDependencies().empty();
+			});
+			if (tangentFrame != m_elementsToCompress.end()) {
+				m_omitsElements = true;
+				continue;
+			}
+		}
+
+		auto* compressor = AssignCompressor(v, chosenElements);
 
 		if (compressor != nullptr) {
 			m_elementsToCompress.push_back({
@@ -135,6 +579,13 @@ VertexCompressor::VertexCompressor(
 }
 
 
+void VertexCompressor::SetPositionRange(const Vec3& offset, const Vec3& scale) {
+	if (m_positionCompressor) {
+		m_positionCompressor->SetRange(offset, scale);
+	}
+}
+
+
 std::vector<uint8_t> VertexCompressor::GetCompressedStream(const VertexBase* vertices, size_t vertexCount) const {
 	int stride = 0;
 	std::vector<int> sizes;
@@ -146,21 +597,57 @@ std::vector<uint8_t> VertexCompressor::GetCompressedStream(const VertexBase* ver
 
 	std::vector<uint8_t> data;
 	data.resize(vertexCount * stride);
+	if (vertexCount == 0) {
+		return data;
+	}
 
-	size_t offset = 0;
-	size_t numElements = m_elementsToCompress.size();
-	ArrayView<const VertexBase> inputArray{ vertices, vertexCount, (size_t)m_reader->GetStride() };
-	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
-		for (size_t element = 0; element < numElements; ++element) {
-			eVertexElementSemantic semantic = m_elementsToCompress[element].sourceElement.semantic;
-			int index = m_elementsToCompress[element].sourceElement.index;
-			const void* input = m_reader->GetPointer(inputArray[vertex], semantic, index);
-
-			void* output = data.data() + offset;
+	// Elements are at the same place in every vertex, the reader is only asked for the first one.
+	const size_t inputStride = (size_t)m_reader->GetStride();
+	const uint8_t* firstVertex = reinterpret_cast<const uint8_t*>(vertices);
+	auto OffsetInVertex = [&](eVertexElementSemantic semantic, int index) {
+		const uint8_t* element = reinterpret_cast<const uint8_t*>(m_reader->GetPointer(*vertices, semantic, index));
+		return size_t(element - firstVertex);
+	};
+
+	struct Column {
+		const SemanticCompressor* compressor;
+		size_t inputOffset;
+		std::array<size_t, 4> dependencyOffsets;
+		size_t outputOffset;
+	};
+	std::vector<Column> columns;
+	size_t outputOffset = 0;
+	for (size_t element = 0; element < m_elementsToCompress.size(); ++element) {
+		const CompressionElement& v = m_elementsToCompress[element];
+		const auto& dependencySemantics = v.assignedCompressor->GetDependencies();
+		assert(dependencySemantics.size() <= 4); // compressors need a few at most
+
+		Column column{ v.assignedCompressor, OffsetInVertex(v.sourceElement.semantic, v.sourceElement.index), {}, outputOffset };
+		for (size_t i = 0; i < dependencySemantics.size(); ++i) {
+			column.dependencyOffsets[i] = OffsetInVertex(dependencySemantics[i], v.sourceElement.index);
+		}
+		columns.push_back(column);
+		outputOffset += sizes[element];
+	}
 
-			m_elementsToCompress[element].assignedCompressor->Compress(input, output);
+	// Each compressor goes through its element of a whole batch of vertices.
+	for (size_t first = 0; first < vertexCount; first += BATCH_SIZE) {
+		const uint8_t* input = firstVertex + first * inputStride;
+		uint8_t* output = data.data() + first * stride;
+
+		for (const Column& column : columns) {
+			CompressionBatch batch;
+			batch.input = input + column.inputOffset;
+			batch.dependencies = {};
+			for (size_t i = 0; i < column.compressor->GetDependencies().size(); ++i) {
+				batch.dependencies[i] = input + column.dependencyOffsets[i];
+			}
+			batch.inputStride = inputStride;
+			batch.output = output + column.outputOffset;
+			batch.outputStride = stride;
+			batch.count = std::min(BATCH_SIZE, vertexCount - first);
 
-			offset += sizes[element];
+			column.compressor->CompressBatch(batch);
 		}
 	}
 
@@ -197,13 +684,51 @@ std::vector<int> VertexCompressor::GetCompressedOffsets() const {
 	return offsets;
 }
 
+std::vector<gxapi::eFormat> VertexCompressor::GetCompressedFormats() const {
+	auto& elements = m_reader->GetElements();
+	std::vector<gxapi::eFormat> formats(elements.size(), gxapi::eFormat::UNKNOWN);
+
+	for (auto& v : m_elementsToCompress) {
+		for (size_t i = 0; i < elements.size(); ++i) {
+			if (v.sourceElement.semantic == elements[i].semantic
+				&& v.sourceElement.index == elements[i].index)
+			{
+				formats[i] = v.assignedCompressor->Format();
+			}
+		}
+	}
+	return formats;
+}
+
+bool VertexCompressor::IsPassthrough() const {
+	if (m_omitsElements) {
+		return false;
+	}
+	return std::all_of(m_elementsToCompress.begin(), m_elementsToCompress.end(), [](const CompressionElement& e) {
+		return dynamic_cast<const PassthroughCompressor*>(e.assignedCompressor) != nullptr;
+	});
+}
 
 
 
-SemanticCompressor* VertexCompressor::AssignCompressor(const IVertexReader::Element& element) {
+
+SemanticCompressor* VertexCompressor::AssignCompressor(const IVertexReader::Element& element, const std::vector<IVertexReader::Element>& chosenElements) {
+	// Compressors that use other elements of the vertex are only eligible if those are stored as well.
+	auto HasDependencies = [&](const SemanticCompressor& compressor) {
+		for (eVertexElementSemantic dependency : compressor.GetDependencies()) {
+			auto it = std::find_if(chosenElements.begin(), chosenElements.end(), [&](const IVertexReader::Element& e) {
+				return e.semantic == dependency && e.index == element.index;
+			});
+			if (it == chosenElements.end()) {
+				return false;
+			}
+		}
+		return true;
+	};
+
 	auto it = m_availableCompressors.begin();
 	while (it != m_availableCompressors.end()) {
-		if ((*it)->IsSupported(element.semantic)) {
+		if ((*it)->IsSupported(element.semantic) && HasDependencies(**it)) {
 			return it->get();
 		}
 		++it;
@@ -212,12 +737,25 @@ SemanticCompressor* VertexCompressor::AssignCompressor(const IVertexReader::Elem
 }
 
 
-void VertexCompressor::CreateDefaultCompressorList() {
+void VertexCompressor::CreateDefaultCompressorList(const VertexCompression& compression) {
 	// Compressors are checked in order.
-	// They shouldn't have overlapping capabilities.
-	
-	m_availableCompressors.push_back(std::make_unique<NormalCompressor>());
-	m_availableCompressors.push_back(std::make_unique<ColorCompressor>());	
+	// They shouldn't have overlapping capabilities, except for the more specific going first.
+
+	if (compression.normals != eNormalCompression::NONE) {
+		m_availableCompressors.push_back(std::make_unique<TangentFrameCompressor>(compression.normals));
+		m_availableCompressors.push_back(std::make_unique<NormalCompressor>(compression.normals));
+	}
+	if (compression.texCoords != eTexCoordCompression::NONE) {
+		m_availableCompressors.push_back(std::make_unique<TexCoordCompressor>(compression.texCoords));
+	}
+	if (compression.colors) {
+		m_availableCompressors.push_back(std::make_unique<ColorCompressor>());
+	}
+	if (compression.positions) {
+		auto positionCompressor = std::make_unique<PositionCompressor>();
+		m_positionCompressor = positionCompressor.get();
+		m_availableCompressors.push_back(std::move(positionCompressor));
+	}
 }
 
 
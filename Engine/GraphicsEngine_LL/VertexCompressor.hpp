@@ -1,44 +1,168 @@
 #pragma once
 
 #include "Vertex.hpp"
+#include "../GraphicsApi_LL/Common.hpp"
 #include <memory>
+#include <array>
 
 
 namespace inl::gxeng {
 
 
+enum class eNormalCompression {
+	NONE,
+	OCTAHEDRAL_16, /// <summary> Two 16 bit components, the precision is plenty for lighting. </summary>
+	OCTAHEDRAL_8, /// <summary> Two 8 bit components, visible banding on smooth, shiny surfaces. </summary>
+};
+
+enum class eTexCoordCompression {
+	NONE,
+	HALF, /// <summary> Half floats, for texture coordinates that wrap around. </summary>
+	UNORM_16, /// <summary> Clamped to [0, 1], for atlases and other coordinates that don't wrap. </summary>
+};
+
+
+/// <summary> Selects how the vertex elements are stored on the GPU. Elements not listed are stored as they are. </summary>
+/// <remarks> Shaders must decode the compressed elements, the input layout only converts the formats. </remarks>
+struct VertexCompression {
+	/// <summary> Normals, tangents and bitangents.
+	///		If the normal, tangent and bitangent of the same index are all present, the bitangent
+	///		is not stored, the tangent gets its sign: bitangent = sign * cross(normal, tangent). </summary>
+	eNormalCompression normals = eNormalCompression::NONE;
+	eTexCoordCompression texCoords = eTexCoordCompression::NONE;
+	bool colors = false; /// <summary> Stored as RGBA8, clamped to [0, 1]. </summary>
+	bool positions = false; /// <summary> Stored as 16 bit unorms relative to the bounding box, see <see cref="PositionCompressor"/>. </summary>
+};
+
+
+
+/// <summary> The same element of consecutive vertices, compressed in one call. </summary>
+struct CompressionBatch {
+	const uint8_t* input; /// <summary> The element of the first vertex. </summary>
+	std::array<const uint8_t*, 4> dependencies; /// <summary> The first vertex's elements listed by <see cref="SemanticCompressor::GetDependencies"/>. </summary>
+	size_t inputStride; /// <summary> Bytes between the vertices, same for the element and its dependencies. </summary>
+	uint8_t* output; /// <summary> The compressed element of the first vertex. </summary>
+	size_t outputStride;
+	size_t count;
+
+	/// <summary> The vertices from <paramref name="first"/> to the end of the batch. </summary>
+	CompressionBatch Subrange(size_t first) const {
+		CompressionBatch subrange = *this;
+		subrange.input += first * inputStride;
+		for (auto& dependency : subrange.dependencies) {
+			dependency = dependency ? dependency + first * inputStride : nullptr;
+		}
+		subrange.output += first * outputStride;
+		subrange.count -= first;
+		return subrange;
+	}
+};
+
+
 class SemanticCompressor {
 public:
 	virtual ~SemanticCompressor() {}
 
 	virtual void Compress(const void* input, void* output) const = 0;
 	virtual int Size() const = 0;
+	virtual gxapi::eFormat Format() const = 0;
 	virtual bool IsSupported(eVertexElementSemantic semantic) const = 0;
+
+	/// <summary> Semantics the compressor needs besides the compressed element, of the same index. </summary>
+	virtual const std::vector<eVertexElementSemantic>& GetDependencies() const { static const std::vector<eVertexElementSemantic> none; return none; }
+	/// <summary> Compresses the element using the elements listed by <see cref="GetDependencies"/>, in the same order. </summary>
+	virtual void Compress(const void* input, const void* const* dependencies, void* output) const { Compress(input, output); }
+	/// <summary> Compresses a whole batch, the default compresses the vertices one by one. </summary>
+	virtual void CompressBatch(const CompressionBatch& batch) const;
 };
 
 
+/// <summary> Octahedral encoding of unit vectors. </summary>
 class NormalCompressor : public SemanticCompressor {
 public:
+	NormalCompressor(eNormalCompression compression);
+
 	void Compress(const void* input, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
 	int Size() const override;
+	gxapi::eFormat Format() const override;
 	bool IsSupported(eVertexElementSemantic semantic) const override;
+
+	static Vec2 EncodeOctahedral(const Vec3& normal);
+private:
+	eNormalCompression m_compression;
+};
+
+
+/// <summary> Octahedral tangent, and the handedness of the tangent frame in place of the bitangent. </summary>
+class TangentFrameCompressor : public SemanticCompressor {
+public:
+	TangentFrameCompressor(eNormalCompression compression);
+
+	void Compress(const void* input, void* output) const override;
+	void Compress(const void* input, const void* const* dependencies, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
+	int Size() const override;
+	gxapi::eFormat Format() const override;
+	bool IsSupported(eVertexElementSemantic semantic) const override;
+	const std::vector<eVertexElementSemantic>& GetDependencies() const override;
+private:
+	void Compress(const Vec3& tangent, float handedness, void* output) const;
+	eNormalCompression m_compression;
+};
+
+
+class TexCoordCompressor : public SemanticCompressor {
+public:
+	TexCoordCompressor(eTexCoordCompression compression);
+
+	void Compress(const void* input, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
+	int Size() const override;
+	gxapi::eFormat Format() const override;
+	bool IsSupported(eVertexElementSemantic semantic) const override;
+
+	static uint16_t FloatToHalf(float value);
+private:
+	eTexCoordCompression m_compression;
 };
 
 
 class ColorCompressor : public SemanticCompressor {
 public:
 	void Compress(const void* input, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
 	int Size() const override;
+	gxapi::eFormat Format() const override;
 	bool IsSupported(eVertexElementSemantic semantic) const override;
 };
 
 
+/// <summary> Stores positions as 16 bit unorms within a box. </summary>
+/// <remarks> Decode as position = offset + scale * stored. Positions outside the box are clamped. </remarks>
+class PositionCompressor : public SemanticCompressor {
+public:
+	void SetRange(const Vec3& offset, const Vec3& scale);
+
+	void Compress(const void* input, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
+	int Size() const override;
+	gxapi::eFormat Format() const override;
+	bool IsSupported(eVertexElementSemantic semantic) const override;
+private:
+	Vec3 m_offset = { 0, 0, 0 };
+	Vec3 m_invScale = { 0, 0, 0 }; // zero for flat axes
+};
+
+
 class PassthroughCompressor : public SemanticCompressor {
 public:
 	void Setup(eVertexElementSemantic semantic, const IVertexReader* reader);
 
 	void Compress(const void* input, void* output) const override;
+	void CompressBatch(const CompressionBatch& batch) const override;
 	int Size() const override;
+	gxapi::eFormat Format() const override;
 	bool IsSupported(eVertexElementSemantic semantic) const override;
 private:
 	int m_stride = 0;
@@ -50,16 +174,25 @@ private:
 
 class VertexCompressor {
 public:
-	VertexCompressor(const IVertexReader* reader, const std::vector<bool>& elementMap);
+	VertexCompressor(const IVertexReader* reader, const std::vector<bool>& elementMap, const VertexCompression& compression = {});
+
+	/// <summary> Sets the box quantized positions are relative to. Required if positions are compressed. </summary>
+	void SetPositionRange(const Vec3& offset, const Vec3& scale);
 
 	std::vector<uint8_t> GetCompressedStream(const VertexBase* vertices, size_t vertexCount) const;
 	int GetCompressedStride() const;
+	/// <summary> Offsets of the reader's elements in the compressed vertex, -1 for elements not stored. </summary>
 	std::vector<int> GetCompressedOffsets() const;
+	/// <summary> Formats of the reader's elements in the compressed vertex, UNKNOWN for elements not stored. </summary>
+	std::vector<gxapi::eFormat> GetCompressedFormats() const;
+	/// <summary> True if all chosen elements are stored as they are. </summary>
+	bool IsPassthrough() const;
 
 private:
-	SemanticCompressor* AssignCompressor(const IVertexReader::Element& element);
-	void CreateDefaultCompressorList();
+	SemanticCompressor* AssignCompressor(const IVertexReader::Element& element, const std::vector<IVertexReader::Element>& chosenElements);
+	void CreateDefaultCompressorList(const VertexCompression& compression);
 
+	static constexpr size_t BATCH_SIZE = 1024; // vertices, the input of a batch stays in the cache for all elements
 private:
 	struct CompressionElement {
 		IVertexReader::Element sourceElement;
@@ -70,8 +203,10 @@ private:
 	std::vector<CompressionElement> m_elementsToCompress;
 	std::vector<std::unique_ptr<SemanticCompressor>> m_availableCompressors;
 	std::vector<std::unique_ptr<PassthroughCompressor>> m_passThroughCompressors;
+	PositionCompressor* m_positionCompressor = nullptr;
+	bool m_omitsElements = false;
 };
 
 
 
-} // namespace inl::gxeng
\ No newline at end of file
+} // namespace inl::gxeng
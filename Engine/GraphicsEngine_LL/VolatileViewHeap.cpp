@@ -5,24 +5,29 @@ namespace inl {
 namespace gxeng {
 
 
-VolatileViewHeap::VolatileViewHeap(gxapi::IGraphicsApi* graphicsApi) :
-	m_graphicsApi(graphicsApi),
+VolatileViewHeap::VolatileViewHeap(VolatileViewHeapPool* pool) :
+	m_pool(pool),
 	m_nextPos(0)
 {}
 
 
+VolatileViewHeap::~VolatileViewHeap() {
+	for (auto& chunk : m_chunks) {
+		m_pool->RecycleChunk(chunk);
+	}
+}
+
+
 gxapi::DescriptorHandle VolatileViewHeap::Allocate() {
-	size_t heapId = m_nextPos / HEAP_SIZE;
-	size_t descriptorIndex = m_nextPos % HEAP_SIZE;
-	if (heapId >= m_heaps.size()) {
-		m_heaps.push_back(
-			std::unique_ptr<gxapi::IDescriptorHeap>(
-				m_graphicsApi->CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, HEAP_SIZE, false })
-			)
-		);
+	size_t chunkId = m_nextPos / VolatileViewHeapPool::CHUNK_SIZE;
+	size_t descriptorIndex = m_nextPos % VolatileViewHeapPool::CHUNK_SIZE;
+	if (chunkId >= m_chunks.size()) {
+		m_chunks.push_back(m_pool->RequestChunk());
 	}
 	m_nextPos += 1;
-	return m_heaps[heapId]->At(descriptorIndex);
+
+	const auto& chunk = m_chunks[chunkId];
+	return chunk.heap->At(chunk.firstDescriptor + descriptorIndex);
 }
 
 
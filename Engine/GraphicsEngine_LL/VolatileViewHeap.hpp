@@ -1,9 +1,8 @@
 #pragma once
 
-//#include "HostDescHeap.hpp"
-#include "../BaseLibrary/Memory/SlabAllocatorEngine.hpp"
-#include "../GraphicsApi_LL/IGraphicsApi.hpp"
-#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+#include "VolatileViewHeapPool.hpp"
+
+#include <vector>
 
 namespace inl {
 namespace gxeng {
@@ -14,20 +13,24 @@ namespace gxeng {
 /// allow a pipeline node to easily create views for volatile resources
 /// like a volatile constant buffer.
 /// <para/>
+/// Descriptors are allocated linearly from ranges of the <see cref="VolatileViewHeapPool"/>,
+/// the ranges are given back when the object is destroyed.
+/// <para/>
 /// This class is NOT thread safe.
 /// </summary>
 class VolatileViewHeap {
 public:
-	VolatileViewHeap(gxapi::IGraphicsApi* graphicsApi);
+	VolatileViewHeap(VolatileViewHeapPool* pool);
+	VolatileViewHeap(const VolatileViewHeap&) = delete;
+	VolatileViewHeap& operator=(const VolatileViewHeap&) = delete;
+	~VolatileViewHeap();
 
 	gxapi::DescriptorHandle Allocate();
 
 private:
-	static constexpr size_t HEAP_SIZE = 128;
-
-	gxapi::IGraphicsApi* m_graphicsApi;
+	VolatileViewHeapPool* m_pool;
 	size_t m_nextPos;
-	std::vector<std::unique_ptr<gxapi::IDescriptorHeap>> m_heaps;
+	std::vector<VolatileViewHeapPool::Chunk> m_chunks;
 };
 
 
@@ -0,0 +1,49 @@
+#include "VolatileViewHeapPool.hpp"
+
+
+namespace inl {
+namespace gxeng {
+
+
+VolatileViewHeapPool::VolatileViewHeapPool(gxapi::IGraphicsApi* graphicsApi) :
+	m_graphicsApi(graphicsApi)
+{}
+
+
+auto VolatileViewHeapPool::RequestChunk() -> Chunk {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+
+	if (m_freeChunks.empty()) {
+		size_t heapId = m_heaps.size();
+		m_heaps.push_back(
+			std::unique_ptr<gxapi::IDescriptorHeap>(
+				m_graphicsApi->CreateDescriptorHeap({ gxapi::eDescriptorHeapType::CBV_SRV_UAV, CHUNK_SIZE*CHUNKS_PER_HEAP, false })
+			)
+		);
+		// Push in reverse so that chunks are handed out in address order.
+		for (size_t i = CHUNKS_PER_HEAP; i > 0; --i) {
+			m_freeChunks.push_back(heapId*CHUNKS_PER_HEAP + i - 1);
+		}
+	}
+
+	size_t index = m_freeChunks.back();
+	m_freeChunks.pop_back();
+
+	return { m_heaps[index / CHUNKS_PER_HEAP].get(), (index % CHUNKS_PER_HEAP) * CHUNK_SIZE, index };
+}
+
+
+void VolatileViewHeapPool::RecycleChunk(const Chunk& chunk) {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	m_freeChunks.push_back(chunk.index);
+}
+
+
+size_t VolatileViewHeapPool::GetNumHeaps() const {
+	std::lock_guard<std::mutex> lkg(m_mutex);
+	return m_heaps.size();
+}
+
+
+} // namespace gxeng
+} // namespace inl
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../GraphicsApi_LL/IGraphicsApi.hpp"
+#include "../GraphicsApi_LL/IDescriptorHeap.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+
+namespace inl {
+namespace gxeng {
+
+
+/// <summary>
+/// Hands out fixed size ranges of descriptors from a few large, recycled
+/// descriptor heaps, so that <see cref="VolatileViewHeap"/>s don't have to create their own.
+/// <para/>
+/// Ranges are returned by the <see cref="VolatileViewHeap"/> that owns them when it's
+/// destroyed, which happens on the residency queue after the GPU is done with the frame.
+/// <para/>
+/// This class is thread safe.
+/// </summary>
+class VolatileViewHeapPool {
+public:
+	/// <summary> Number of descriptors in one range. </summary>
+	static constexpr size_t CHUNK_SIZE = 128;
+	/// <summary> Number of ranges in one descriptor heap. </summary>
+	static constexpr size_t CHUNKS_PER_HEAP = 32;
+
+	struct Chunk {
+		gxapi::IDescriptorHeap* heap;
+		size_t firstDescriptor;
+		size_t index;
+	};
+public:
+	VolatileViewHeapPool(gxapi::IGraphicsApi* graphicsApi);
+	VolatileViewHeapPool(const VolatileViewHeapPool&) = delete;
+	VolatileViewHeapPool& operator=(const VolatileViewHeapPool&) = delete;
+
+	Chunk RequestChunk();
+	void RecycleChunk(const Chunk& chunk);
+
+	size_t GetNumHeaps() const;
+private:
+	gxapi::IGraphicsApi* m_graphicsApi;
+	std::vector<std::unique_ptr<gxapi::IDescriptorHeap>> m_heaps;
+	std::vector<size_t> m_freeChunks;
+
+	mutable std::mutex m_mutex;
+};
+
+
+} // namespace gxeng
+} // namespace inl
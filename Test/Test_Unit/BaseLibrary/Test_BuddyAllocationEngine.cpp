@@ -0,0 +1,82 @@
+#include <BaseLibrary/Memory/BuddyAllocationEngine.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <map>
+#include <random>
+
+using namespace inl;
+
+
+TEST_CASE("Allocations are rounded and aligned", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(64);
+
+	size_t a = engine.Allocate(3);
+	size_t b = engine.Allocate(16);
+	REQUIRE(engine.GetAllocationSize(a) == 4);
+	REQUIRE(a % 4 == 0);
+	REQUIRE(engine.GetAllocationSize(b) == 16);
+	REQUIRE(b % 16 == 0);
+	REQUIRE(engine.GetAllocatedSize() == 20);
+}
+
+
+TEST_CASE("Full pool throws", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(64);
+
+	engine.Allocate(1);
+	engine.Allocate(32);
+	REQUIRE(engine.GetLargestFreeSize() == 16);
+	REQUIRE_THROWS_AS(engine.Allocate(17), std::bad_alloc);
+	REQUIRE_THROWS_AS(engine.Allocate(65), std::bad_alloc);
+}
+
+
+TEST_CASE("Buddies merge on deallocation", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(64);
+
+	size_t a = engine.Allocate(1);
+	size_t b = engine.Allocate(8);
+	size_t c = engine.Allocate(32);
+	engine.Deallocate(b);
+	engine.Deallocate(a);
+	engine.Deallocate(c);
+
+	REQUIRE(engine.GetAllocatedSize() == 0);
+	REQUIRE(engine.GetLargestFreeSize() == 64);
+	REQUIRE(engine.Allocate(64) == 0);
+}
+
+
+TEST_CASE("Random allocations don't overlap", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(256);
+	std::map<size_t, size_t> live;
+	std::mt19937 rng(42);
+
+	for (int i = 0; i < 10000; ++i) {
+		if (rng() % 2 == 0 && !live.empty()) {
+			auto it = live.begin();
+			std::advance(it, rng() % live.size());
+			engine.Deallocate(it->first);
+			live.erase(it);
+		}
+		else {
+			try {
+				size_t index = engine.Allocate(1 + rng() % 20);
+				size_t size = engine.GetAllocationSize(index);
+				auto next = live.lower_bound(index);
+				REQUIRE((next == live.end() || index + size <= next->first));
+				REQUIRE((next == live.begin() || std::prev(next)->first + std::prev(next)->second <= index));
+				live[index] = size;
+			}
+			catch (std::bad_alloc&) {
+				// pool is full, that's fine
+			}
+		}
+	}
+
+	for (auto& allocation : live) {
+		engine.Deallocate(allocation.first);
+	}
+	REQUIRE(engine.GetLargestFreeSize() == 256);
+}
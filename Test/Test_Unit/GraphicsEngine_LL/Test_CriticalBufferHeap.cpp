@@ -0,0 +1,284 @@
+#include <GraphicsEngine_LL/CriticalBufferHeap.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <map>
+#include <set>
+
+using namespace inl;
+using namespace inl::gxeng;
+using inl::gxeng::impl::CriticalBufferHeap;
+
+
+// Records heaps and resources, the GPU is not involved.
+class FakeHeap : public gxapi::IHeap {
+public:
+	FakeHeap(gxapi::HeapDesc desc, uint64_t gpuAddress) : desc(desc), gpuAddress(gpuAddress) {}
+	gxapi::HeapDesc GetDesc() const override { return desc; }
+
+	gxapi::HeapDesc desc;
+	uint64_t gpuAddress;
+};
+
+
+class FakeResource : public gxapi::IResource {
+public:
+	FakeResource(gxapi::ResourceDesc desc, uint64_t gpuAddress, FakeHeap* heap = nullptr, uint64_t heapOffset = 0)
+		: desc(desc), gpuAddress(gpuAddress), heap(heap), heapOffset(heapOffset) {}
+
+	gxapi::ResourceDesc GetDesc() const override { return desc; }
+	void* Map(unsigned, const gxapi::MemoryRange*) override { return nullptr; }
+	void Unmap(unsigned, const gxapi::MemoryRange*) override {}
+	void* GetGPUAddress() const override { return reinterpret_cast<void*>(gpuAddress); }
+
+	unsigned GetNumMipLevels() const override { return 1; }
+	unsigned GetNumTexturePlanes() const override { return 1; }
+	unsigned GetNumArrayLevels() const override { return 1; }
+	unsigned GetNumSubresources() const override { return 1; }
+	unsigned GetSubresourceIndex(unsigned, unsigned, unsigned) const override { return 0; }
+	Vec3u64 GetSize(unsigned) const override { return { desc.textureDesc.width, desc.textureDesc.height, 1 }; }
+
+	void SetName(const char*) override {}
+
+	gxapi::ResourceDesc desc;
+	uint64_t gpuAddress;
+	FakeHeap* heap; // null if committed
+	uint64_t heapOffset;
+};
+
+
+class FakeGraphicsApi : public gxapi::IGraphicsApi {
+public:
+	// Pretends that textures are 4 bytes per pixel, without mips.
+	gxapi::ResourceAllocationInfo GetResourceAllocationInfo(gxapi::ResourceDesc desc) const override {
+		constexpr uint64_t small = 4 * 1024, normal = 64 * 1024, multisampled = 4 * 1024 * 1024;
+		if (desc.type == gxapi::eResourceType::BUFFER) {
+			return { RoundUp(desc.bufferDesc.sizeInBytes, normal), normal };
+		}
+		uint64_t size = desc.textureDesc.width * desc.textureDesc.height * 4;
+		if (desc.textureDesc.multisampleCount > 1) {
+			return { RoundUp(size, multisampled), multisampled };
+		}
+		if (desc.textureDesc.alignment == small && size <= normal) {
+			return { RoundUp(size, small), small };
+		}
+		return { RoundUp(size, normal), normal };
+	}
+
+	gxapi::IHeap* CreateHeap(gxapi::HeapDesc desc) override {
+		++numHeapsCreated;
+		return new FakeHeap(desc, numHeapsCreated * 0x1'0000'0000ull);
+	}
+
+	gxapi::IResource* CreatePlacedResource(gxapi::IHeap* heap, uint64_t heapOffset, gxapi::ResourceDesc desc, gxapi::eResourceState, gxapi::ClearValue*) override {
+		FakeHeap* fakeHeap = static_cast<FakeHeap*>(heap);
+		REQUIRE(heapOffset % GetResourceAllocationInfo(desc).alignment == 0);
+		REQUIRE(heapOffset + GetResourceAllocationInfo(desc).sizeInBytes <= fakeHeap->desc.sizeInBytes);
+		return new FakeResource(desc, fakeHeap->gpuAddress + heapOffset, fakeHeap, heapOffset);
+	}
+
+	gxapi::IResource* CreateCommittedResource(gxapi::HeapProperties, gxapi::eHeapFlags, gxapi::ResourceDesc desc, gxapi::eResourceState, gxapi::ClearValue*) override {
+		++numCommittedCreated;
+		return new FakeResource(desc, 0xFFFF'0000'0000ull);
+	}
+
+	gxapi::VideoMemoryInfo GetVideoMemoryInfo() const override { return {}; }
+	bool PollVideoMemoryBudgetChange() override { return false; }
+	void MakeResident(const std::vector<gxapi::IResource*>&) override {}
+	void Evict(const std::vector<gxapi::IResource*>&) override {}
+
+	// Not used by the heap.
+	gxapi::ICommandQueue* CreateCommandQueue(gxapi::CommandQueueDesc) override { return nullptr; }
+	gxapi::ICommandAllocator* CreateCommandAllocator(gxapi::eCommandListType) override { return nullptr; }
+	gxapi::IGraphicsCommandList* CreateGraphicsCommandList(gxapi::CommandListDesc) override { return nullptr; }
+	gxapi::IComputeCommandList* CreateComputeCommandList(gxapi::CommandListDesc) override { return nullptr; }
+	gxapi::ICopyCommandList* CreateCopyCommandList(gxapi::CommandListDesc) override { return nullptr; }
+	gxapi::ICommandList* CreateCommandList(gxapi::eCommandListType, gxapi::CommandListDesc) override { return nullptr; }
+	gxapi::IRootSignature* CreateRootSignature(gxapi::RootSignatureDesc) override { return nullptr; }
+	gxapi::IPipelineState* CreateGraphicsPipelineState(const gxapi::GraphicsPipelineStateDesc&) override { return nullptr; }
+	gxapi::IPipelineState* CreateComputePipelineState(const gxapi::ComputePipelineStateDesc&) override { return nullptr; }
+	gxapi::IDescriptorHeap* CreateDescriptorHeap(gxapi::DescriptorHeapDesc) override { return nullptr; }
+	void CreateConstantBufferView(gxapi::ConstantBufferViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateDepthStencilView(gxapi::DepthStencilViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateDepthStencilView(const gxapi::IResource*, gxapi::DescriptorHandle) override {}
+	void CreateDepthStencilView(const gxapi::IResource*, gxapi::DepthStencilViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateRenderTargetView(const gxapi::IResource*, gxapi::DescriptorHandle) override {}
+	void CreateRenderTargetView(const gxapi::IResource*, gxapi::RenderTargetViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateShaderResourceView(gxapi::ShaderResourceViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateShaderResourceView(const gxapi::IResource*, gxapi::DescriptorHandle) override {}
+	void CreateShaderResourceView(const gxapi::IResource*, gxapi::ShaderResourceViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateUnorderedAccessView(gxapi::UnorderedAccessViewDesc, gxapi::DescriptorHandle) override {}
+	void CreateUnorderedAccessView(const gxapi::IResource*, gxapi::DescriptorHandle) override {}
+	void CreateUnorderedAccessView(const gxapi::IResource*, gxapi::UnorderedAccessViewDesc, gxapi::DescriptorHandle) override {}
+	void CopyDescriptors(size_t, gxapi::DescriptorHandle*, size_t, gxapi::DescriptorHandle*, uint32_t*, gxapi::eDescriptorHeapType) override {}
+	void CopyDescriptors(size_t, gxapi::DescriptorHandle*, uint32_t*, size_t, gxapi::DescriptorHandle*, uint32_t*, gxapi::eDescriptorHeapType) override {}
+	void CopyDescriptors(gxapi::DescriptorHandle, gxapi::DescriptorHandle, size_t, gxapi::eDescriptorHeapType) override {}
+	gxapi::IFence* CreateFence(uint64_t) override { return nullptr; }
+	void ReportLiveObjects() const override {}
+
+	int numHeapsCreated = 0;
+	int numCommittedCreated = 0;
+
+private:
+	static uint64_t RoundUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+};
+
+
+static const FakeResource& Fake(const MemoryObjDesc& desc) {
+	return *static_cast<const FakeResource*>(desc.resource.get());
+}
+
+static gxapi::ResourceDesc SmallTexture() {
+	return gxapi::ResourceDesc::Texture2D(64, 64, gxapi::eFormat::R8G8B8A8_UNORM); // 16 KiB
+}
+
+
+TEST_CASE("Small resources are placed side by side", "[CriticalBufferHeap]") {
+	FakeGraphicsApi api;
+	CriticalBufferHeap heap(&api);
+
+	MemoryObjDesc a = heap.Allocate(SmallTexture());
+	MemoryObjDesc b = heap.Allocate(SmallTexture());
+	MemoryObjDesc c = heap.Allocate(gxapi::ResourceDesc::Buffer(1000));
+
+	REQUIRE(api.numHeapsCreated == 2); // textures and buffers don't share heaps
+	REQUIRE(api.numCommittedCreated == 0);
+	REQUIRE(Fake(a).heap == Fake(b).heap);
+	REQUIRE(Fake(a).heap != Fake(c).heap);
+
+	// Small textures take 4 KiB aligned 16 KiB, not 64 KiB each.
+	REQUIRE(Fake(a).desc.textureDesc.alignment == CriticalBufferHeap::BLOCK_SIZE);
+	REQUIRE(Fake(b).heapOffset - Fake(a).heapOffset == 16 * 1024);
+
+	auto statistics = heap.GetStatistics();
+	REQUIRE(statistics.size() == 2);
+	for (auto& stats : statistics) {
+		REQUIRE(stats.size == CriticalBufferHeap::HEAP_SIZE);
+		if (stats.heapClass == CriticalBufferHeap::eHeapClass::TEXTURES) {
+			REQUIRE(stats.usedSize == 32 * 1024);
+			REQUIRE(stats.numAllocations == 2);
+		}
+		else {
+			REQUIRE(stats.heapClass == CriticalBufferHeap::eHeapClass::BUFFERS);
+			REQUIRE(stats.usedSize == 64 * 1024);
+			REQUIRE(stats.numAllocations == 1);
+		}
+	}
+}
+
+
+TEST_CASE("Large and multisampled resources are committed", "[CriticalBufferHeap]") {
+	FakeGraphicsApi api;
+	CriticalBufferHeap heap(&api);
+
+	MemoryObjDesc large = heap.Allocate(gxapi::ResourceDesc::Buffer(CriticalBufferHeap::MAX_PLACED_SIZE + 1));
+	MemoryObjDesc multisampled = heap.Allocate(gxapi::ResourceDesc::Texture2D(64, 64, gxapi::eFormat::R8G8B8A8_UNORM, gxapi::eResourceFlags::ALLOW_RENDER_TARGET, 1, 4));
+
+	REQUIRE(api.numCommittedCreated == 2);
+	REQUIRE(api.numHeapsCreated == 0);
+	REQUIRE(Fake(large).heap == nullptr);
+	REQUIRE(Fake(multisampled).heap == nullptr);
+	REQUIRE(heap.GetStatistics().empty());
+}
+
+
+TEST_CASE("Freed blocks coalesce", "[CriticalBufferHeap]") {
+	FakeGraphicsApi api;
+	CriticalBufferHeap heap(&api);
+
+	std::vector<MemoryObjDesc> textures;
+	for (int i = 0; i < 4; ++i) {
+		textures.push_back(heap.Allocate(SmallTexture()));
+	}
+	REQUIRE(heap.GetStatistics()[0].usedSize == 64 * 1024);
+
+	// Free out of order, the four 16 KiB blocks have to merge back into one.
+	textures[1].resource.reset();
+	textures[3].resource.reset();
+	textures[0].resource.reset();
+	textures[2].resource.reset();
+
+	auto stats = heap.GetStatistics()[0];
+	REQUIRE(stats.usedSize == 0);
+	REQUIRE(stats.numAllocations == 0);
+	REQUIRE(stats.largestFreeBlock == CriticalBufferHeap::HEAP_SIZE);
+
+	// A 64 KiB aligned texture fits into the merged space at the start.
+	MemoryObjDesc large = heap.Allocate(gxapi::ResourceDesc::Texture2D(256, 256, gxapi::eFormat::R8G8B8A8_UNORM));
+	REQUIRE(Fake(large).desc.textureDesc.alignment == 0);
+	REQUIRE(Fake(large).heapOffset == 0);
+	REQUIRE(api.numHeapsCreated == 1);
+}
+
+
+TEST_CASE("Full heaps make the pool grow", "[CriticalBufferHeap]") {
+	FakeGraphicsApi api;
+	CriticalBufferHeap heap(&api);
+
+	const size_t perHeap = CriticalBufferHeap::HEAP_SIZE / CriticalBufferHeap::MAX_PLACED_SIZE;
+	std::vector<MemoryObjDesc> buffers;
+	for (size_t i = 0; i < perHeap + 1; ++i) {
+		buffers.push_back(heap.Allocate(gxapi::ResourceDesc::Buffer(CriticalBufferHeap::MAX_PLACED_SIZE)));
+	}
+
+	REQUIRE(api.numHeapsCreated == 2);
+	REQUIRE(Fake(buffers[0]).heap == Fake(buffers[perHeap - 1]).heap);
+	REQUIRE(Fake(buffers[0]).heap != Fake(buffers[perHeap]).heap);
+
+	// Space freed in the first heap is reused before growing again.
+	buffers[1].resource.reset();
+	buffers.push_back(heap.Allocate(gxapi::ResourceDesc::Buffer(CriticalBufferHeap::MAX_PLACED_SIZE)));
+	REQUIRE(api.numHeapsCreated == 2);
+	REQUIRE(Fake(buffers.back()).heap == Fake(buffers[0]).heap);
+
+	// Only empty heaps are released.
+	buffers[perHeap].resource.reset();
+	heap.TrimEmptyHeaps();
+	REQUIRE(heap.GetStatistics().size() == 1);
+
+	buffers.clear();
+	heap.TrimEmptyHeaps();
+	REQUIRE(heap.GetStatistics().empty());
+}
+
+
+TEST_CASE("Small buffers are ranges of a shared buffer", "[CriticalBufferHeap]") {
+	FakeGraphicsApi api;
+	CriticalBufferHeap heap(&api);
+
+	LinearBuffer a = heap.AllocateBuffer(100);
+	LinearBuffer b = heap.AllocateBuffer(1000);
+	LinearBuffer large = heap.AllocateBuffer(CriticalBufferHeap::MAX_SUBALLOCATED_BUFFER_SIZE + 1);
+
+	REQUIRE(a._GetResourcePtr() == b._GetResourcePtr());
+	REQUIRE(a._GetResourcePtr() != large._GetResourcePtr());
+	REQUIRE(a.GetSize() == 100);
+	REQUIRE(b.GetSize() == 1000);
+	REQUIRE(a.GetOffset() % CriticalBufferHeap::BUFFER_SLOT_SIZE == 0);
+	REQUIRE(b.GetOffset() % CriticalBufferHeap::BUFFER_SLOT_SIZE == 0);
+	REQUIRE(a.GetOffset() != b.GetOffset());
+	REQUIRE((uint8_t*)b.GetVirtualAddress() - (uint8_t*)b.MemoryObject::GetVirtualAddress() == (ptrdiff_t)b.GetOffset());
+	REQUIRE(large.GetOffset() == 0);
+
+	// The range is freed with the last copy of the buffer.
+	uint64_t offsetOfA = a.GetOffset();
+	LinearBuffer copyOfA = a;
+	a = LinearBuffer();
+	REQUIRE(heap.GetBufferChunkStatistics()[0].numAllocations == 2);
+	copyOfA = LinearBuffer();
+	REQUIRE(heap.GetBufferChunkStatistics()[0].numAllocations == 1);
+
+	LinearBuffer c = heap.AllocateBuffer(100);
+	REQUIRE(c.GetOffset() == offsetOfA);
+
+	// The chunk itself is one placed buffer.
+	REQUIRE(heap.GetBufferChunkStatistics().size() == 1);
+	REQUIRE(api.numCommittedCreated == 0);
+
+	b = LinearBuffer();
+	c = LinearBuffer();
+	heap.TrimEmptyHeaps();
+	REQUIRE(heap.GetBufferChunkStatistics().empty());
+}